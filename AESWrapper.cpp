@@ -12,25 +12,23 @@
 */
 
 #include "AESWrapper.h"
+#include "Tracer.h"
 
-#include <modes.h>
-#include <aes.h>
-#include <filters.h>
-
+#include <cstring>
 #include <stdexcept>
-#include <immintrin.h>	// _rdrand32_step
+#include <utility>
 
 
 unsigned char* AESWrapper::GenerateKey(unsigned char* buffer, unsigned int length)
 {
-	for (size_t i = 0; i < length; i += sizeof(unsigned int))
-		_rdrand32_step(reinterpret_cast<unsigned int*>(&buffer[i]));
+	CryptoProvider::current().random_bytes(buffer, length);
 	return buffer;
 }
 
 AESWrapper::AESWrapper()
 {
 	GenerateKey(_key, DEFAULT_KEYLENGTH);
+	_cipher = CryptoProvider::current().aes(_key, DEFAULT_KEYLENGTH);
 }
 
 AESWrapper::AESWrapper(const unsigned char* key, unsigned int length)
@@ -38,6 +36,7 @@ AESWrapper::AESWrapper(const unsigned char* key, unsigned int length)
 	if (length != DEFAULT_KEYLENGTH)
 		throw std::length_error("key length must be 16 bytes");
 	memcpy_s(_key, DEFAULT_KEYLENGTH, key, length);
+	_cipher = CryptoProvider::current().aes(_key, DEFAULT_KEYLENGTH);
 }
 
 AESWrapper::~AESWrapper()
@@ -49,17 +48,20 @@ const unsigned char* AESWrapper::getKey() const
 	return _key;
 }
 
-std::string AESWrapper::encrypt(const char* plain, unsigned int length) const
+const AESCipher& AESWrapper::cipher() const
 {
-	CryptoPP::byte iv[CryptoPP::AES::BLOCKSIZE] = { 0 };	// for practical use iv should never be a fixed value!
+	return *_cipher;
+}
 
-	CryptoPP::AES::Encryption aesEncryption(_key, DEFAULT_KEYLENGTH);
-	CryptoPP::CBC_Mode_ExternalCipher::Encryption cbcEncryption(aesEncryption, iv);
+std::string AESWrapper::encrypt(const char* plain, unsigned int length) const
+{
+	TRACE_SCOPE("AESWrapper::encrypt", "aes");
+	std::unique_ptr<CBCStream> encryptor = _cipher->cbc_encryptor();
 
-	std::string cipher;
-	CryptoPP::StreamTransformationFilter stfEncryptor(cbcEncryption, new CryptoPP::StringSink(cipher));
-	stfEncryptor.Put(reinterpret_cast<const CryptoPP::byte*>(plain), length);
-	stfEncryptor.MessageEnd();
+	std::string cipher, last;
+	encryptor->update(plain, length, cipher);
+	encryptor->finish(last);
+	cipher += last;
 
 	return cipher;
 }
@@ -67,15 +69,55 @@ std::string AESWrapper::encrypt(const char* plain, unsigned int length) const
 
 std::string AESWrapper::decrypt(const char* cipher, unsigned int length) const
 {
-	CryptoPP::byte iv[CryptoPP::AES::BLOCKSIZE] = { 0 };	// for practical use iv should never be a fixed value!
-
-	CryptoPP::AES::Decryption aesDecryption(_key, DEFAULT_KEYLENGTH);
-	CryptoPP::CBC_Mode_ExternalCipher::Decryption cbcDecryption(aesDecryption, iv);
+	TRACE_SCOPE("AESWrapper::decrypt", "aes");
+	std::unique_ptr<CBCStream> decryptor = _cipher->cbc_decryptor();
 
-	std::string decrypted;
-	CryptoPP::StreamTransformationFilter stfDecryptor(cbcDecryption, new CryptoPP::StringSink(decrypted));
-	stfDecryptor.Put(reinterpret_cast<const CryptoPP::byte*>(cipher), length);
-	stfDecryptor.MessageEnd();
+	std::string decrypted, last;
+	decryptor->update(cipher, length, decrypted);
+	decryptor->finish(last);
+	decrypted += last;
 
 	return decrypted;
 }
+
+
+static const uint64_t BLOCK_SIZE = 16;
+
+AESStreamEncryptor::AESStreamEncryptor(std::shared_ptr<const AESWrapper> session)
+	: _session(std::move(session)), _stream(_session->cipher().cbc_encryptor())
+{
+}
+
+uint64_t AESStreamEncryptor::cipher_length(uint64_t plain_length)
+{
+	return (plain_length / BLOCK_SIZE + 1) * BLOCK_SIZE;
+}
+
+void AESStreamEncryptor::update(const char* plain, size_t length, std::string& cipher)
+{
+	TRACE_SCOPE("AESStreamEncryptor::update", "aes");
+	_stream->update(plain, length, cipher);
+}
+
+void AESStreamEncryptor::finish(std::string& cipher)
+{
+	TRACE_SCOPE("AESStreamEncryptor::finish", "aes");
+	_stream->finish(cipher);
+}
+
+AESStreamDecryptor::AESStreamDecryptor(std::shared_ptr<const AESWrapper> session)
+	: _session(std::move(session)), _stream(_session->cipher().cbc_decryptor())
+{
+}
+
+void AESStreamDecryptor::update(const char* cipher, size_t length, std::string& plain)
+{
+	TRACE_SCOPE("AESStreamDecryptor::update", "aes");
+	_stream->update(cipher, length, plain);
+}
+
+void AESStreamDecryptor::finish(std::string& plain)
+{
+	TRACE_SCOPE("AESStreamDecryptor::finish", "aes");
+	_stream->finish(plain);
+}
@@ -13,10 +13,17 @@
 
 #pragma once
 
+#include "CryptoProvider.h"
+
+#include <cstdint>
+#include <memory>
 #include <string>
 
  /**
   * @brief The AESWrapper class provides encryption and decryption using the AES algorithm.
+  *
+  * An AESWrapper is the session object for one symmetric key. The key is handed to the current
+  * CryptoProvider once, in the constructor, and its cipher is reused by every encrypt and decrypt call.
   */
 class AESWrapper
 {
@@ -24,6 +31,7 @@ public:
 	static const unsigned int DEFAULT_KEYLENGTH = 16;
 private:
 	unsigned char _key[DEFAULT_KEYLENGTH];
+	std::unique_ptr<AESCipher> _cipher;
 
 	AESWrapper(const AESWrapper& aes);
 public:
@@ -37,4 +45,77 @@ public:
 
 	std::string encrypt(const char* plain, unsigned int length) const;
 	std::string decrypt(const char* cipher, unsigned int length) const;
+
+	/**
+	 * @brief Returns the provider's cipher for the key, shared by the stream ciphers and GCMChunkCipher.
+	 */
+	const AESCipher& cipher() const;
+};
+
+/**
+ * @brief Incremental AES-CBC encryptor that produces the same ciphertext as AESWrapper::encrypt.
+ *
+ * Plaintext can be fed in chunks of any size, so a large input never has to be held in memory.
+ */
+class AESStreamEncryptor
+{
+public:
+	/**
+	 * @brief Constructs an encryptor over a session; it keeps the session alive while in use.
+	 */
+	explicit AESStreamEncryptor(std::shared_ptr<const AESWrapper> session);
+
+	/**
+	 * @brief Returns the ciphertext length for a plaintext of the given length (PKCS#7 padding).
+	 */
+	static uint64_t cipher_length(uint64_t plain_length);
+
+	/**
+	 * @brief Encrypts the next chunk of plaintext.
+	 * @param cipher Replaced with the ciphertext that became available (whole blocks only).
+	 */
+	void update(const char* plain, size_t length, std::string& cipher);
+
+	/**
+	 * @brief Pads and encrypts the remaining plaintext.
+	 * @param cipher Replaced with the last ciphertext blocks.
+	 */
+	void finish(std::string& cipher);
+
+private:
+	std::shared_ptr<const AESWrapper> _session;
+	std::unique_ptr<CBCStream> _stream;
+
+	AESStreamEncryptor(const AESStreamEncryptor& encryptor);
+};
+
+/**
+ * @brief Incremental AES-CBC decryptor, the counterpart of AESStreamEncryptor.
+ */
+class AESStreamDecryptor
+{
+public:
+	/**
+	 * @brief Constructs a decryptor over a session; it keeps the session alive while in use.
+	 */
+	explicit AESStreamDecryptor(std::shared_ptr<const AESWrapper> session);
+
+	/**
+	 * @brief Decrypts the next chunk of ciphertext.
+	 * @param plain Replaced with the plaintext that became available. The last block is held
+	 *              back until finish() because it carries the padding.
+	 */
+	void update(const char* cipher, size_t length, std::string& plain);
+
+	/**
+	 * @brief Removes the padding and returns the remaining plaintext.
+	 * @throws std::exception if the ciphertext is truncated or the padding is invalid.
+	 */
+	void finish(std::string& plain);
+
+private:
+	std::shared_ptr<const AESWrapper> _session;
+	std::unique_ptr<CBCStream> _stream;
+
+	AESStreamDecryptor(const AESStreamDecryptor& decryptor);
 };
@@ -0,0 +1,431 @@
+/**
+ * @file Base64Codec.cpp
+ * @brief Implementation of the Base64 codec kernels for the MessageU project.
+ *
+ * The SIMD kernels encode 12 (SSSE3) or 24 (AVX2) bytes per step and decode 16 or 32 characters
+ * per step with nibble lookups (W. Mula and D. Lemire, "Faster Base64 Encoding and Decoding
+ * Using AVX2 Instructions"). A decoding step only runs on a block of alphabet characters; line
+ * breaks and anything else are consumed by the table kernel, which carries the partial quad over.
+ * The kernels need the same instruction sets as the HexCodec ones and are selected the same way.
+ *
+ * @version 2.0
+ * @author Dmitriy Gorodov
+ * @id 342725405
+ * @date 16/10/2026
+ */
+
+#include "Base64Codec.h"
+#include "HexCodec.h"
+#include <algorithm>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define BASE64_CODEC_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define BASE64_TARGET(isa)
+#else
+#define BASE64_TARGET(isa) __attribute__((target(isa)))
+#endif
+#endif
+
+static const char BASE64_DIGITS[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+static const int8_t BASE64_VALUES[256] = {
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 62, -1, -1, -1, 63,
+	52, 53, 54, 55, 56, 57, 58, 59, 60, 61, -1, -1, -1, -1, -1, -1,
+	-1,  0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14,
+	15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, -1, -1, -1, -1, -1,
+	-1, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40,
+	41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1
+};
+
+/**
+ * @brief Returns the number of characters of length bytes, without line breaks.
+ */
+static size_t run_size(size_t length)
+{
+	return (length + 2) / 3 * 4;
+}
+
+/**
+ * @brief Encodes bytes as one run of characters, padded with '='.
+ */
+static void encode_table(const uint8_t* bytes, size_t length, char* text)
+{
+	size_t i = 0;
+	for (; i + 3 <= length; i += 3, text += 4)
+	{
+		uint32_t group = (static_cast<uint32_t>(bytes[i]) << 16) | (bytes[i + 1] << 8) | bytes[i + 2];
+		text[0] = BASE64_DIGITS[group >> 18];
+		text[1] = BASE64_DIGITS[(group >> 12) & 0x3f];
+		text[2] = BASE64_DIGITS[(group >> 6) & 0x3f];
+		text[3] = BASE64_DIGITS[group & 0x3f];
+	}
+	if (i < length)
+	{
+		uint32_t group = (static_cast<uint32_t>(bytes[i]) << 16) | (i + 1 < length ? bytes[i + 1] << 8 : 0);
+		text[0] = BASE64_DIGITS[group >> 18];
+		text[1] = BASE64_DIGITS[(group >> 12) & 0x3f];
+		text[2] = i + 1 < length ? BASE64_DIGITS[(group >> 6) & 0x3f] : '=';
+		text[3] = '=';
+	}
+}
+
+/**
+ * @brief The decoding position carried between table and SIMD steps.
+ */
+struct DecodeState
+{
+	uint8_t* out;
+	uint32_t bits;
+	int sextets;	// in bits, 0 to 3; a SIMD step needs 0
+};
+
+/**
+ * @brief Decodes the alphabet characters of [text, end) and skips the others.
+ */
+static void decode_table_run(const char* text, const char* end, DecodeState* state)
+{
+	for (; text < end; text++)
+	{
+		int value = BASE64_VALUES[static_cast<uint8_t>(*text)];
+		if (value < 0)
+			continue;
+
+		state->bits = (state->bits << 6) | static_cast<uint32_t>(value);
+		if (++state->sextets == 4)
+		{
+			state->out[0] = static_cast<uint8_t>(state->bits >> 16);
+			state->out[1] = static_cast<uint8_t>(state->bits >> 8);
+			state->out[2] = static_cast<uint8_t>(state->bits);
+			state->out += 3;
+			state->bits = 0;
+			state->sextets = 0;
+		}
+	}
+}
+
+/**
+ * @brief Writes the whole bytes of a final partial quad; leftover bits are dropped.
+ */
+static size_t decode_finish(uint8_t* bytes, DecodeState* state)
+{
+	if (state->sextets == 2)
+		*state->out++ = static_cast<uint8_t>(state->bits >> 4);
+	else if (state->sextets == 3)
+	{
+		*state->out++ = static_cast<uint8_t>(state->bits >> 10);
+		*state->out++ = static_cast<uint8_t>(state->bits >> 2);
+	}
+	return static_cast<size_t>(state->out - bytes);
+}
+
+static size_t decode_table(const char* text, size_t text_length, uint8_t* bytes)
+{
+	DecodeState state = { bytes, 0, 0 };
+	decode_table_run(text, text + text_length, &state);
+	return decode_finish(bytes, &state);
+}
+
+#ifdef BASE64_CODEC_X86
+
+static inline unsigned first_set_bit(uint32_t mask)
+{
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanForward(&index, mask);
+	return index;
+#else
+	return static_cast<unsigned>(__builtin_ctz(mask));
+#endif
+}
+
+/**
+ * @brief Converts the bytes of each 3-byte group, spread over a 32-bit lane, to alphabet characters.
+ */
+BASE64_TARGET("ssse3") static inline __m128i encode_block_ssse3(__m128i input)
+{
+	input = _mm_shuffle_epi8(input, _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1));
+
+	// Move the four 6-bit fields of each lane to the low bits of its four bytes.
+	__m128i first_and_third = _mm_mulhi_epu16(_mm_and_si128(input, _mm_set1_epi32(0x0fc0fc00)), _mm_set1_epi32(0x04000040));
+	__m128i second_and_fourth = _mm_mullo_epi16(_mm_and_si128(input, _mm_set1_epi32(0x003f03f0)), _mm_set1_epi32(0x01000010));
+	__m128i indices = _mm_or_si128(first_and_third, second_and_fourth);
+
+	// Map each index to its range (A-Z, a-z, 0-9, '+', '/') and add that range's offset.
+	__m128i range = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+	range = _mm_or_si128(range, _mm_and_si128(_mm_cmpgt_epi8(_mm_set1_epi8(26), indices), _mm_set1_epi8(13)));
+	const __m128i offsets = _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+		'0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+	return _mm_add_epi8(_mm_shuffle_epi8(offsets, range), indices);
+}
+
+BASE64_TARGET("ssse3") static void encode_ssse3(const uint8_t* bytes, size_t length, char* text)
+{
+	// Each step reads 16 bytes and encodes the first 12.
+	size_t i = 0;
+	for (; i + 16 <= length; i += 12, text += 16)
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(text), encode_block_ssse3(_mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + i))));
+	encode_table(bytes + i, length - i, text);
+}
+
+/**
+ * @brief Converts 16 characters to their 6-bit values.
+ * @return A bit per character that is in the alphabet.
+ */
+BASE64_TARGET("ssse3") static inline uint32_t decode_values_ssse3(__m128i input, __m128i* values)
+{
+	const __m128i low_classes = _mm_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1a, 0x1b, 0x1b, 0x1b, 0x1a);
+	const __m128i high_classes = _mm_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+	const __m128i offsets = _mm_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+	const __m128i slash = _mm_set1_epi8(0x2f);
+
+	// A character is in the alphabet if the classes of its two nibbles share no bit. The 0x2f
+	// mask also keeps bit 5, which the shuffles ignore.
+	__m128i high_nibbles = _mm_and_si128(_mm_srli_epi32(input, 4), slash);
+	__m128i classes = _mm_and_si128(_mm_shuffle_epi8(low_classes, _mm_and_si128(input, slash)), _mm_shuffle_epi8(high_classes, high_nibbles));
+	uint32_t valid = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(classes, _mm_setzero_si128())));
+
+	__m128i offset = _mm_shuffle_epi8(offsets, _mm_add_epi8(_mm_cmpeq_epi8(input, slash), high_nibbles));
+	*values = _mm_add_epi8(input, offset);
+	return valid;
+}
+
+/**
+ * @brief Packs the 6-bit values of each 32-bit lane into 3 bytes, in the low 12 bytes.
+ */
+BASE64_TARGET("ssse3") static inline __m128i pack_values_ssse3(__m128i values)
+{
+	__m128i pairs = _mm_maddubs_epi16(values, _mm_set1_epi32(0x01400140));
+	__m128i groups = _mm_madd_epi16(pairs, _mm_set1_epi32(0x00011000));
+	return _mm_shuffle_epi8(groups, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+}
+
+BASE64_TARGET("ssse3") static size_t decode_ssse3(const char* text, size_t text_length, uint8_t* bytes)
+{
+	// A step stores 16 bytes for 12; 24 characters left always leave room for them.
+	const char* end = text + text_length;
+	DecodeState state = { bytes, 0, 0 };
+	while (end - text >= 24)
+	{
+		if (state.sextets != 0)
+		{
+			decode_table_run(text, text + 1, &state);
+			text++;
+			continue;
+		}
+
+		__m128i values;
+		uint32_t valid = decode_values_ssse3(_mm_loadu_si128(reinterpret_cast<const __m128i*>(text)), &values);
+		if (valid == 0xffff)
+		{
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(state.out), pack_values_ssse3(values));
+			state.out += 12;
+			text += 16;
+			continue;
+		}
+
+		// Up to and including the first character outside the alphabet, e.g. a line break.
+		const char* stop = text + first_set_bit(~valid) + 1;
+		decode_table_run(text, stop, &state);
+		text = stop;
+	}
+	decode_table_run(text, end, &state);
+	return decode_finish(bytes, &state);
+}
+
+BASE64_TARGET("avx2") static void encode_avx2(const uint8_t* bytes, size_t length, char* text)
+{
+	const __m256i spread = _mm256_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10,
+		1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10);
+	const __m256i offsets = _mm256_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+		'0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0,
+		'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+		'0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+
+	// Each step reads 16 bytes at i and at i + 12, and encodes the first 12 of each.
+	size_t i = 0;
+	for (; i + 28 <= length; i += 24, text += 32)
+	{
+		__m256i input = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + i))),
+			_mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + i + 12)), 1);
+		input = _mm256_shuffle_epi8(input, spread);
+
+		__m256i first_and_third = _mm256_mulhi_epu16(_mm256_and_si256(input, _mm256_set1_epi32(0x0fc0fc00)), _mm256_set1_epi32(0x04000040));
+		__m256i second_and_fourth = _mm256_mullo_epi16(_mm256_and_si256(input, _mm256_set1_epi32(0x003f03f0)), _mm256_set1_epi32(0x01000010));
+		__m256i indices = _mm256_or_si256(first_and_third, second_and_fourth);
+
+		__m256i range = _mm256_subs_epu8(indices, _mm256_set1_epi8(51));
+		range = _mm256_or_si256(range, _mm256_and_si256(_mm256_cmpgt_epi8(_mm256_set1_epi8(26), indices), _mm256_set1_epi8(13)));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(text), _mm256_add_epi8(_mm256_shuffle_epi8(offsets, range), indices));
+	}
+	encode_table(bytes + i, length - i, text);
+}
+
+BASE64_TARGET("avx2") static size_t decode_avx2(const char* text, size_t text_length, uint8_t* bytes)
+{
+	const __m256i low_classes = _mm256_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1a, 0x1b, 0x1b, 0x1b, 0x1a,
+		0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1a, 0x1b, 0x1b, 0x1b, 0x1a);
+	const __m256i high_classes = _mm256_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+		0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+	const __m256i offsets = _mm256_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0,
+		0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+	const __m256i slash = _mm256_set1_epi8(0x2f);
+	const __m256i gather = _mm256_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+		2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+
+	// A step stores 32 bytes for 24; 44 characters left always leave room for them.
+	const char* end = text + text_length;
+	DecodeState state = { bytes, 0, 0 };
+	while (end - text >= 44)
+	{
+		if (state.sextets != 0)
+		{
+			decode_table_run(text, text + 1, &state);
+			text++;
+			continue;
+		}
+
+		__m256i input = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(text));
+		__m256i high_nibbles = _mm256_and_si256(_mm256_srli_epi32(input, 4), slash);
+		__m256i classes = _mm256_and_si256(_mm256_shuffle_epi8(low_classes, _mm256_and_si256(input, slash)), _mm256_shuffle_epi8(high_classes, high_nibbles));
+		uint32_t valid = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(classes, _mm256_setzero_si256())));
+		if (valid == 0xffffffffu)
+		{
+			__m256i offset = _mm256_shuffle_epi8(offsets, _mm256_add_epi8(_mm256_cmpeq_epi8(input, slash), high_nibbles));
+			__m256i values = _mm256_add_epi8(input, offset);
+			__m256i pairs = _mm256_maddubs_epi16(values, _mm256_set1_epi32(0x01400140));
+			__m256i groups = _mm256_shuffle_epi8(_mm256_madd_epi16(pairs, _mm256_set1_epi32(0x00011000)), gather);
+
+			// Each 128-bit lane holds 12 bytes; the permute joins them.
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(state.out), _mm256_permutevar8x32_epi32(groups, _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 7, 7)));
+			state.out += 24;
+			text += 32;
+			continue;
+		}
+
+		const char* stop = text + first_set_bit(~valid) + 1;
+		decode_table_run(text, stop, &state);
+		text = stop;
+	}
+	decode_table_run(text, end, &state);
+	return decode_finish(bytes, &state);
+}
+
+#endif
+
+bool Base64Codec::is_supported(Kernel kernel)
+{
+	switch (kernel)
+	{
+	case Kernel::SSSE3:
+		return HexCodec::is_supported(HexCodec::Kernel::SSSE3);
+	case Kernel::AVX2:
+		return HexCodec::is_supported(HexCodec::Kernel::AVX2);
+	default:
+		return true;
+	}
+}
+
+Base64Codec::Kernel Base64Codec::best_kernel()
+{
+	static const Kernel best = is_supported(Kernel::AVX2) ? Kernel::AVX2 : is_supported(Kernel::SSSE3) ? Kernel::SSSE3 : Kernel::TABLE;
+	return best;
+}
+
+const char* Base64Codec::kernel_name(Kernel kernel)
+{
+	switch (kernel)
+	{
+	case Kernel::SSSE3:
+		return "ssse3";
+	case Kernel::AVX2:
+		return "avx2";
+	default:
+		return "table";
+	}
+}
+
+size_t Base64Codec::encoded_size(size_t length, size_t line_length)
+{
+	size_t characters = run_size(length);
+	return line_length ? characters + (characters + line_length - 1) / line_length : characters;
+}
+
+/**
+ * @brief Encodes bytes as one run of characters with a kernel.
+ */
+static void encode_run(const uint8_t* bytes, size_t length, char* text, Base64Codec::Kernel kernel)
+{
+	switch (kernel)
+	{
+#ifdef BASE64_CODEC_X86
+	case Base64Codec::Kernel::AVX2:
+		encode_avx2(bytes, length, text);
+		break;
+	case Base64Codec::Kernel::SSSE3:
+		encode_ssse3(bytes, length, text);
+		break;
+#endif
+	default:
+		encode_table(bytes, length, text);
+		break;
+	}
+}
+
+void Base64Codec::encode(const uint8_t* bytes, size_t length, char* text, size_t line_length)
+{
+	encode(bytes, length, text, line_length, best_kernel());
+}
+
+void Base64Codec::encode(const uint8_t* bytes, size_t length, char* text, size_t line_length, Kernel kernel)
+{
+	if (line_length == 0)
+	{
+		encode_run(bytes, length, text, kernel);
+		return;
+	}
+
+	// Line by line, so the kernels never straddle a line break.
+	size_t line_bytes = line_length / 4 * 3;
+	while (length > 0)
+	{
+		size_t chunk = std::min(length, line_bytes);
+		encode_run(bytes, chunk, text, kernel);
+		text += run_size(chunk);
+		*text++ = '\n';
+		bytes += chunk;
+		length -= chunk;
+	}
+}
+
+size_t Base64Codec::decode(const char* text, size_t text_length, uint8_t* bytes)
+{
+	return decode(text, text_length, bytes, best_kernel());
+}
+
+size_t Base64Codec::decode(const char* text, size_t text_length, uint8_t* bytes, Kernel kernel)
+{
+	switch (kernel)
+	{
+#ifdef BASE64_CODEC_X86
+	case Kernel::AVX2:
+		return decode_avx2(text, text_length, bytes);
+	case Kernel::SSSE3:
+		return decode_ssse3(text, text_length, bytes);
+#endif
+	default:
+		return decode_table(text, text_length, bytes);
+	}
+}
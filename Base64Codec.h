@@ -0,0 +1,79 @@
+/**
+ * @file Base64Codec.h
+ * @brief Declaration of the Base64 codec kernels for the MessageU project.
+ *
+ * This header declares the table-driven and SIMD (SSSE3, AVX2) Base64 encoders and decoders
+ * behind Base64Wrapper. The text is the same as the Crypto++ Base64Encoder's default output:
+ * the standard alphabet with '=' padding, in lines of LINE_LENGTH characters, each ended by a
+ * '\n'. Like the Crypto++ Base64Decoder, decoding skips every character outside the alphabet.
+ * The fastest kernel the CPU supports is selected once, at first use.
+ *
+ * @version 2.0
+ * @author Dmitriy Gorodov
+ * @id 324725405
+ * @date 16/10/2026
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Base64Codec
+{
+	enum class Kernel
+	{
+		TABLE,
+		SSSE3,
+		AVX2
+	};
+
+	/**
+	 * @brief The line length of the Crypto++ Base64Encoder, used by my.info.
+	 */
+	const size_t LINE_LENGTH = 72;
+
+	/**
+	 * @brief Returns the fastest kernel supported by this CPU.
+	 */
+	Kernel best_kernel();
+
+	/**
+	 * @brief Returns true if the kernel can run on this CPU.
+	 */
+	bool is_supported(Kernel kernel);
+
+	/**
+	 * @brief Returns a short name of the kernel, e.g. "avx2".
+	 */
+	const char* kernel_name(Kernel kernel);
+
+	/**
+	 * @brief Returns the number of characters encode() writes for length bytes.
+	 * @param line_length A multiple of 4, or 0 for a single line without a final '\n'.
+	 */
+	size_t encoded_size(size_t length, size_t line_length = LINE_LENGTH);
+
+	/**
+	 * @brief Encodes bytes as Base64.
+	 * @param line_length A multiple of 4, or 0 for a single line without a final '\n'.
+	 * @param text Output of encoded_size(length, line_length) characters (not NUL-terminated).
+	 */
+	void encode(const uint8_t* bytes, size_t length, char* text, size_t line_length = LINE_LENGTH);
+	void encode(const uint8_t* bytes, size_t length, char* text, size_t line_length, Kernel kernel);
+
+	/**
+	 * @brief Returns the largest number of bytes decode() writes for text_length characters.
+	 */
+	inline size_t max_decoded_size(size_t text_length) { return text_length / 4 * 3 + text_length % 4; }
+
+	/**
+	 * @brief Decodes Base64, skipping line breaks, padding and any other non-alphabet character.
+	 *
+	 * Bits left over after the last whole byte are dropped.
+	 * @param bytes Output of max_decoded_size(text_length) bytes.
+	 * @return The number of bytes written.
+	 */
+	size_t decode(const char* text, size_t text_length, uint8_t* bytes);
+	size_t decode(const char* text, size_t text_length, uint8_t* bytes, Kernel kernel);
+}
@@ -14,9 +14,10 @@
 #pragma once
 
 #include <string>
-#include <base64.h>
-
 
+/**
+ * @brief Base64 in the Crypto++ Base64Encoder format (72-character lines), through Base64Codec.
+ */
 class Base64Wrapper
 {
 public:
@@ -0,0 +1,1242 @@
+/**
+ * @file Benchmark.cpp
+ * @brief Implementation of the benchmark runner for the MessageU project.
+ *
+ * Contains the timing loop and the registered benchmark cases. Network cases run against a
+ * MockServer in the same process, so they need no server.
+ *
+ * @version 2.0
+ * @author Dmitriy Gorodov
+ * @id 342725405
+ * @date 16/10/2026
+ */
+
+#include "Benchmark.h"
+#include "ClientId.h"
+#include "AESWrapper.h"
+#include "Base64Codec.h"
+#include "Base64Wrapper.h"
+#include "CryptoProvider.h"
+#include "FileSource.h"
+#include "GCMChunkCipher.h"
+#include "HexCodec.h"
+#include "MockServer.h"
+#include "RSAWrapper.h"
+#include "RequestBuilder.h"
+#include "RequestPipeline.h"
+#include "ResponseHandler.h"
+#include "utils.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
+#include <boost/asio.hpp>
+#include <base64.h>
+
+using boost::asio::ip::tcp;
+
+#ifdef MESSAGEU_COUNT_ALLOCATIONS
+/**
+ * @brief Count of heap allocations, maintained by the replaced global operator new below.
+ *
+ * The replacement applies to the whole executable, so it is only compiled into benchmark
+ * builds (MESSAGEU_COUNT_ALLOCATIONS); its cost is one relaxed atomic increment.
+ */
+static std::atomic<uint64_t> heap_allocations(0);
+
+void* operator new(size_t size)
+{
+	heap_allocations.fetch_add(1, std::memory_order_relaxed);
+	void* memory = malloc(size ? size : 1);
+	if (!memory)
+		throw std::bad_alloc();
+	return memory;
+}
+
+void operator delete(void* memory) noexcept
+{
+	free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept
+{
+	free(memory);
+}
+#endif
+
+/**
+ * @brief Returns a client ID whose bytes all equal the given value.
+ */
+static ClientId make_client_id(uint8_t fill)
+{
+	uint8_t bytes[ClientId::SIZE];
+	memset(bytes, fill, sizeof(bytes));
+	return ClientId(bytes);
+}
+
+BenchmarkState::BenchmarkState(double min_time_seconds)
+	: min_time_seconds_(min_time_seconds), iterations_(0), items_processed_(0), bytes_processed_(0), started_(false)
+{
+}
+
+bool BenchmarkState::keep_running()
+{
+	auto now = std::chrono::steady_clock::now();
+	if (!started_)
+	{
+		started_ = true;
+		start_ = now;
+		end_ = now;
+		return true;
+	}
+
+	iterations_++;
+	end_ = now;
+	return std::chrono::duration<double>(end_ - start_).count() < min_time_seconds_;
+}
+
+void BenchmarkState::set_items_processed(uint64_t items)
+{
+	items_processed_ = items;
+}
+
+void BenchmarkState::set_bytes_processed(uint64_t bytes)
+{
+	bytes_processed_ = bytes;
+}
+
+void BenchmarkState::set_counter(const std::string& name, double value)
+{
+	counters_.emplace_back(name, value);
+}
+
+uint64_t BenchmarkState::iterations() const
+{
+	return iterations_;
+}
+
+double BenchmarkState::elapsed_seconds() const
+{
+	return std::chrono::duration<double>(end_ - start_).count();
+}
+
+uint64_t BenchmarkState::items_processed() const
+{
+	return items_processed_;
+}
+
+uint64_t BenchmarkState::bytes_processed() const
+{
+	return bytes_processed_;
+}
+
+const std::vector<std::pair<std::string, double>>& BenchmarkState::counters() const
+{
+	return counters_;
+}
+
+Benchmark::Benchmark()
+{
+	add_pipeline_cases();
+	add_serialization_cases();
+	add_private_key_cases();
+	add_public_key_cases();
+	add_symmetric_key_cases();
+	add_file_cipher_cases();
+	add_hex_cases();
+	add_base64_cases();
+	add_client_id_cases();
+	add_backlog_cases();
+	add_primitive_cases();
+	add_file_source_cases();
+	add_crypto_provider_cases();
+}
+
+void Benchmark::add(const std::string& name, Function function)
+{
+	cases_.emplace_back(name, std::move(function));
+}
+
+std::vector<BenchmarkResult> Benchmark::run(const std::string& filter)
+{
+	std::vector<BenchmarkResult> results;
+	for (auto& benchmark_case : cases_)
+	{
+		if (!filter.empty() && benchmark_case.first.find(filter) == std::string::npos)
+			continue;
+
+		BenchmarkState state(DEFAULT_MIN_TIME_SECONDS);
+		benchmark_case.second(state);
+		results.push_back(BenchmarkResult
+			{
+				benchmark_case.first,
+				state.iterations(),
+				state.elapsed_seconds(),
+				state.items_processed(),
+				state.bytes_processed(),
+				state.counters()
+			});
+	}
+	return results;
+}
+
+void Benchmark::print(const std::vector<BenchmarkResult>& results) const
+{
+	std::cout << std::left << std::setw(48) << "Benchmark" << std::right
+		<< std::setw(14) << "Time/iter" << std::setw(12) << "Iterations"
+		<< std::setw(16) << "Items/s" << std::setw(14) << "MB/s" << "\n";
+
+	for (const auto& result : results)
+	{
+		double seconds = result.seconds > 0 ? result.seconds : 1e-9;
+		double per_iteration_us = result.iterations ? seconds * 1e6 / result.iterations : 0;
+
+		std::cout << std::left << std::setw(48) << result.name << std::right << std::fixed << std::setprecision(2)
+			<< std::setw(11) << per_iteration_us << " us" << std::setw(12) << result.iterations
+			<< std::setw(16) << (result.items / seconds) << std::setw(14) << (result.bytes / seconds / 1e6);
+		for (const auto& counter : result.counters)
+			std::cout << "  " << counter.first << "=" << counter.second;
+		std::cout << "\n";
+	}
+
+#ifndef MESSAGEU_COUNT_ALLOCATIONS
+	bool serialized = std::any_of(results.begin(), results.end(),
+		[](const BenchmarkResult& result) { return result.name.compare(0, 10, "serialize/") == 0; });
+	if (serialized)
+		std::cout << "\nallocs/op is not reported: heap allocations are only counted by the Benchmark configuration,"
+			<< " which defines MESSAGEU_COUNT_ALLOCATIONS.\n";
+#endif
+}
+
+void Benchmark::write_json(const std::vector<BenchmarkResult>& results, std::ostream& out)
+{
+	std::ostringstream json;
+	json.precision(17);
+
+	json << "{\n  \"context\": {\n"
+		<< "    \"executable\": \"MessageUClient\",\n"
+		<< "    \"num_cpus\": " << std::thread::hardware_concurrency() << ",\n"
+		<< "    \"min_time_seconds\": " << DEFAULT_MIN_TIME_SECONDS << "\n"
+		<< "  },\n  \"benchmarks\": [";
+
+	for (size_t i = 0; i < results.size(); i++)
+	{
+		const BenchmarkResult& result = results[i];
+		double seconds = result.seconds > 0 ? result.seconds : 1e-9;
+		double per_iteration_ns = result.iterations ? seconds * 1e9 / result.iterations : 0;
+
+		// Only wall-clock time is measured, so it is reported as both real and CPU time.
+		json << (i ? "," : "") << "\n    {\n"
+			<< "      \"name\": \"" << result.name << "\",\n"
+			<< "      \"run_name\": \"" << result.name << "\",\n"
+			<< "      \"run_type\": \"iteration\",\n"
+			<< "      \"iterations\": " << result.iterations << ",\n"
+			<< "      \"real_time\": " << per_iteration_ns << ",\n"
+			<< "      \"cpu_time\": " << per_iteration_ns << ",\n"
+			<< "      \"time_unit\": \"ns\"";
+		if (result.bytes)
+			json << ",\n      \"bytes_per_second\": " << result.bytes / seconds;
+		if (result.items)
+			json << ",\n      \"items_per_second\": " << result.items / seconds;
+		for (const auto& counter : result.counters)
+			json << ",\n      \"" << counter.first << "\": " << counter.second;
+		json << "\n    }";
+	}
+	json << "\n  ]\n}\n";
+	out << json.str();
+}
+
+uint64_t Benchmark::allocation_count()
+{
+#ifdef MESSAGEU_COUNT_ALLOCATIONS
+	return heap_allocations.load(std::memory_order_relaxed);
+#else
+	return 0;
+#endif
+}
+
+/**
+ * @brief Reports the "allocs/op" counter of a case, if allocations are counted in this build.
+ */
+static void report_allocations(BenchmarkState& state, uint64_t allocations_before)
+{
+#ifdef MESSAGEU_COUNT_ALLOCATIONS
+	state.set_counter("allocs/op", static_cast<double>(Benchmark::allocation_count() - allocations_before) / state.iterations());
+#else
+	(void)state;
+	(void)allocations_before;
+#endif
+}
+
+void Benchmark::add_pipeline_cases()
+{
+	const int latencies_ms[] = { 0, 1, 5, 20, 50 };
+	const size_t depths[] = { 1, 8, 64 };
+
+	for (int latency_ms : latencies_ms)
+	{
+		for (size_t depth : depths)
+		{
+			std::string name = "pipeline/depth:" + std::to_string(depth) + "/latency:" + std::to_string(latency_ms) + "ms";
+			add(name, [latency_ms, depth](BenchmarkState& state)
+				{
+					MockServerOptions options;
+					options.latency = std::chrono::milliseconds(latency_ms);
+					options.store_messages = false;
+					MockServer server(options);
+					ClientId client_id = server.add_client("sender", std::vector<uint8_t>(MAX_PUBLIC_KEY_SIZE));
+					ClientId target_id = server.add_client("target", std::vector<uint8_t>(MAX_PUBLIC_KEY_SIZE));
+					server.start();
+
+					boost::asio::io_context io_context;
+					tcp::socket socket(io_context);
+					socket.connect(tcp::endpoint(boost::asio::ip::make_address("127.0.0.1"), server.port()));
+					socket.set_option(tcp::no_delay(true));
+					RequestPipeline pipeline(socket, depth);
+
+					RequestBuilder request_builder;
+					std::string content(64, 'x');
+					std::vector<uint8_t> request = request_builder.build_send_message_request(client_id, target_id, MessageType::TEXT_MESSAGE_SEND, content);
+
+					uint64_t messages = 0;
+					while (state.keep_running())
+					{
+						for (size_t i = 0; i < depth; i++)
+							pipeline.submit(request, [&messages](bool success, const ResponseHeader&, std::vector<uint8_t>&)
+								{
+									if (success) messages++;
+								});
+						pipeline.wait();
+					}
+					state.set_items_processed(messages);
+					state.set_bytes_processed(messages * request.size());
+				});
+		}
+	}
+}
+
+void Benchmark::add_serialization_cases()
+{
+	const size_t content_sizes[] = { 64, 4096, 1 << 20 };
+
+	for (size_t content_size : content_sizes)
+	{
+		std::string size_name = "/size:" + std::to_string(content_size);
+
+		add("serialize/send_message/vector" + size_name, [content_size](BenchmarkState& state)
+			{
+				RequestBuilder request_builder;
+				ClientId client_id = make_client_id(0x11);
+				ClientId target_id = make_client_id(0x22);
+				std::string content(content_size, 'x');
+
+				uint64_t allocations_before = allocation_count();
+				uint64_t bytes = 0;
+				while (state.keep_running())
+				{
+					std::vector<uint8_t> request = request_builder.build_send_message_request(client_id, target_id, MessageType::FILE_SEND, content);
+					bytes += request.size();
+				}
+				state.set_bytes_processed(bytes);
+				report_allocations(state, allocations_before);
+			});
+
+		add("serialize/send_message/gather" + size_name, [content_size](BenchmarkState& state)
+			{
+				RequestBuilder request_builder;
+				ClientId client_id = make_client_id(0x11);
+				ClientId target_id = make_client_id(0x22);
+				std::string content(content_size, 'x');
+
+				uint64_t allocations_before = allocation_count();
+				uint64_t bytes = 0;
+				while (state.keep_running())
+				{
+					GatherRequest request = request_builder.build_send_message_gather(client_id, target_id, MessageType::FILE_SEND, boost::asio::buffer(content));
+					bytes += boost::asio::buffer_size(request.buffers());
+				}
+				state.set_bytes_processed(bytes);
+				report_allocations(state, allocations_before);
+			});
+	}
+}
+
+void Benchmark::add_private_key_cases()
+{
+	struct KeyMessage
+	{
+		std::string private_key_base64;
+		std::string cipher;
+	};
+
+	// One symmetric key, wrapped with our public key as a peer would send it.
+	auto make_key_message = []()
+	{
+		RSAPrivateWrapper rsa_private;
+		RSAPublicWrapper rsa_public(rsa_private.getPublicKey());
+		AESWrapper aes;
+		std::string symmetric_key(reinterpret_cast<const char*>(aes.getKey()), AESWrapper::DEFAULT_KEYLENGTH);
+		return KeyMessage{ Base64Wrapper::encode(rsa_private.getPrivateKey()), rsa_public.encrypt(symmetric_key) };
+	};
+
+	add("rsa/key_message/per_message_setup", [make_key_message](BenchmarkState& state)
+		{
+			KeyMessage message = make_key_message();
+			uint64_t messages = 0;
+			while (state.keep_running())
+			{
+				std::string decoded_private_key = Base64Wrapper::decode(message.private_key_base64);
+				RSAPrivateWrapper rsa_private(decoded_private_key);
+				messages += rsa_private.decrypt(message.cipher).size() == AESWrapper::DEFAULT_KEYLENGTH;
+			}
+			state.set_items_processed(messages);
+		});
+
+	add("rsa/key_message/cached_context", [make_key_message](BenchmarkState& state)
+		{
+			KeyMessage message = make_key_message();
+			RSAPrivateWrapper rsa_private(Base64Wrapper::decode(message.private_key_base64));
+			uint64_t messages = 0;
+			while (state.keep_running())
+			{
+				messages += rsa_private.decrypt(message.cipher).size() == AESWrapper::DEFAULT_KEYLENGTH;
+			}
+			state.set_items_processed(messages);
+		});
+}
+
+void Benchmark::add_public_key_cases()
+{
+	// The crypto part of request_send_symmetric_key: a fresh AES key wrapped for the peer.
+	add("rsa/send_symmetric_key/per_call_parse", [](BenchmarkState& state)
+		{
+			RSAPrivateWrapper peer_private;
+			std::string peer_public_key = peer_private.getPublicKey();
+			std::string peer_public_key_hex = bytes_to_hex_string(std::vector<uint8_t>(peer_public_key.begin(), peer_public_key.end()));
+
+			uint64_t keys = 0;
+			while (state.keep_running())
+			{
+				AESWrapper aes;
+				std::string symmetric_key(reinterpret_cast<const char*>(aes.getKey()), AESWrapper::DEFAULT_KEYLENGTH);
+				std::vector<uint8_t> peer_public_key_bytes = hex_string_to_bytes(peer_public_key_hex);
+				RSAPublicWrapper rsa_public(std::string(peer_public_key_bytes.begin(), peer_public_key_bytes.end()));
+				keys += !rsa_public.encrypt(symmetric_key).empty();
+			}
+			state.set_items_processed(keys);
+		});
+
+	add("rsa/send_symmetric_key/cached_encryptor", [](BenchmarkState& state)
+		{
+			RSAPrivateWrapper peer_private;
+			RSAPublicWrapper rsa_public(peer_private.getPublicKey());
+
+			uint64_t keys = 0;
+			while (state.keep_running())
+			{
+				AESWrapper aes;
+				std::string symmetric_key(reinterpret_cast<const char*>(aes.getKey()), AESWrapper::DEFAULT_KEYLENGTH);
+				keys += !rsa_public.encrypt(symmetric_key).empty();
+			}
+			state.set_items_processed(keys);
+		});
+}
+
+void Benchmark::add_symmetric_key_cases()
+{
+	// A short chat message to a peer whose symmetric key is already known.
+	const std::string text_message(64, 'm');
+
+	add("aes/text_message/per_message_rebuild", [text_message](BenchmarkState& state)
+		{
+			AESWrapper peer_key;
+			std::string symmetric_key_hex = bytes_to_hex_string(std::vector<uint8_t>(peer_key.getKey(), peer_key.getKey() + AESWrapper::DEFAULT_KEYLENGTH));
+
+			uint64_t bytes = 0;
+			while (state.keep_running())
+			{
+				std::vector<uint8_t> symmetric_key_bytes = hex_string_to_bytes(symmetric_key_hex);
+				AESWrapper aes(&symmetric_key_bytes[0], static_cast<unsigned int>(symmetric_key_bytes.size()));
+				bytes += aes.encrypt(text_message.c_str(), static_cast<unsigned int>(text_message.size())).size();
+			}
+			state.set_items_processed(state.iterations());
+			state.set_bytes_processed(bytes);
+		});
+
+	add("aes/text_message/session", [text_message](BenchmarkState& state)
+		{
+			std::shared_ptr<AESWrapper> session = std::make_shared<AESWrapper>();
+
+			uint64_t bytes = 0;
+			while (state.keep_running())
+			{
+				bytes += session->encrypt(text_message.c_str(), static_cast<unsigned int>(text_message.size())).size();
+			}
+			state.set_items_processed(state.iterations());
+			state.set_bytes_processed(bytes);
+		});
+}
+
+void Benchmark::add_file_cipher_cases()
+{
+	const size_t file_size = 16 * 1024 * 1024;
+
+	add("aes/file/cbc_stream/16MiB", [file_size](BenchmarkState& state)
+		{
+			std::shared_ptr<AESWrapper> session = std::make_shared<AESWrapper>();
+			std::vector<char> file_content(file_size, 'f');
+			std::string cipher;
+
+			uint64_t bytes = 0;
+			while (state.keep_running())
+			{
+				AESStreamEncryptor encryptor(session);
+				for (size_t offset = 0; offset < file_size; offset += FILE_CHUNK_SIZE)
+					encryptor.update(file_content.data() + offset, FILE_CHUNK_SIZE, cipher);
+				encryptor.finish(cipher);
+				bytes += file_size;
+			}
+			state.set_bytes_processed(bytes);
+		});
+
+	const unsigned int cores = std::max(1u, std::thread::hardware_concurrency());
+	std::vector<unsigned int> thread_counts{ 1, 4, cores };
+	std::sort(thread_counts.begin(), thread_counts.end());
+	thread_counts.erase(std::unique(thread_counts.begin(), thread_counts.end()), thread_counts.end());
+
+	for (unsigned int threads : thread_counts)
+	{
+		add("aes/file/gcm_parallel/threads:" + std::to_string(threads) + "/16MiB", [file_size, threads](BenchmarkState& state)
+			{
+				std::shared_ptr<AESWrapper> session = std::make_shared<AESWrapper>();
+				boost::asio::thread_pool pool(threads);
+				std::vector<char> file_content(file_size, 'f');
+				std::string cipher;
+
+				uint64_t bytes = 0;
+				while (state.keep_running())
+				{
+					GCMChunkEncryptor encryptor(session, &pool);
+					size_t window_size = encryptor.chunk_size() * threads;
+					for (size_t offset = 0; offset < file_size; offset += window_size)
+					{
+						size_t length = std::min(window_size, file_size - offset);
+						encryptor.encrypt(file_content.data() + offset, length, offset + length == file_size, cipher);
+					}
+					bytes += file_size;
+				}
+				state.set_bytes_processed(bytes);
+			});
+	}
+}
+
+void Benchmark::add_hex_cases()
+{
+	// The ostringstream and substr/stoul conversions that the HexCodec kernels replaced.
+	auto legacy_encode = [](const std::vector<uint8_t>& bytes)
+	{
+		std::ostringstream oss;
+		for (auto b : bytes)
+			oss << std::hex << std::setw(2) << std::setfill('0') << (int)b;
+		return oss.str();
+	};
+	auto legacy_decode = [](const std::string& hex)
+	{
+		std::vector<uint8_t> bytes;
+		for (size_t i = 0; i < hex.size(); i += 2)
+			bytes.push_back(static_cast<uint8_t>(std::stoul(hex.substr(i, 2), nullptr, 16)));
+		return bytes;
+	};
+
+	// A client ID, a public key and a large buffer.
+	for (size_t size : { size_t(16), size_t(160), size_t(4096) })
+	{
+		std::vector<uint8_t> bytes(size);
+		for (size_t i = 0; i < size; i++)
+			bytes[i] = static_cast<uint8_t>(i * 37);
+		std::string hex = legacy_encode(bytes);
+		std::string suffix = "/" + std::to_string(size);
+
+		add("hex/encode/legacy_stream" + suffix, [bytes, legacy_encode](BenchmarkState& state)
+			{
+				uint64_t length = 0;
+				while (state.keep_running())
+					length += legacy_encode(bytes).size();
+				state.set_bytes_processed(length / 2);
+			});
+		add("hex/decode/legacy_stoul" + suffix, [hex, legacy_decode](BenchmarkState& state)
+			{
+				uint64_t length = 0;
+				while (state.keep_running())
+					length += legacy_decode(hex).size();
+				state.set_bytes_processed(length);
+			});
+
+		for (HexCodec::Kernel kernel : { HexCodec::Kernel::TABLE, HexCodec::Kernel::SSSE3, HexCodec::Kernel::AVX2 })
+		{
+			if (!HexCodec::is_supported(kernel))
+				continue;
+
+			add(std::string("hex/encode/") + HexCodec::kernel_name(kernel) + suffix, [bytes, kernel](BenchmarkState& state)
+				{
+					std::string output(bytes.size() * 2, '\0');
+					while (state.keep_running())
+						HexCodec::encode(bytes.data(), bytes.size(), &output[0], kernel);
+					state.set_bytes_processed(state.iterations() * bytes.size());
+				});
+			add(std::string("hex/decode/") + HexCodec::kernel_name(kernel) + suffix, [hex, kernel](BenchmarkState& state)
+				{
+					std::vector<uint8_t> output(hex.size() / 2);
+					while (state.keep_running())
+						HexCodec::decode(hex.data(), hex.size(), output.data(), kernel);
+					state.set_bytes_processed(state.iterations() * output.size());
+				});
+		}
+	}
+}
+
+void Benchmark::add_base64_cases()
+{
+	// The StringSource -> Base64Encoder/Decoder -> StringSink chains that the Base64Codec kernels replaced.
+	auto cryptopp_encode = [](const std::string& bytes)
+	{
+		std::string encoded;
+		CryptoPP::StringSource ss(bytes, true, new CryptoPP::Base64Encoder(new CryptoPP::StringSink(encoded)));
+		return encoded;
+	};
+	auto cryptopp_decode = [](const std::string& text)
+	{
+		std::string decoded;
+		CryptoPP::StringSource ss(text, true, new CryptoPP::Base64Decoder(new CryptoPP::StringSink(decoded)));
+		return decoded;
+	};
+
+	// A private key as stored in my.info (RSA-1024 DER), a 4 KiB buffer and a large one.
+	for (size_t size : { size_t(634), size_t(4096), size_t(1024 * 1024) })
+	{
+		std::string bytes(size, '\0');
+		for (size_t i = 0; i < size; i++)
+			bytes[i] = static_cast<char>(i * 37);
+		std::string text = Base64Wrapper::encode(bytes);
+		std::string suffix = "/" + std::to_string(size);
+
+		add("base64/encode/cryptopp_filter" + suffix, [bytes, cryptopp_encode](BenchmarkState& state)
+			{
+				uint64_t length = 0;
+				while (state.keep_running())
+					length += cryptopp_encode(bytes).size() ? bytes.size() : 0;
+				state.set_bytes_processed(length);
+			});
+		add("base64/decode/cryptopp_filter" + suffix, [text, cryptopp_decode](BenchmarkState& state)
+			{
+				uint64_t length = 0;
+				while (state.keep_running())
+					length += cryptopp_decode(text).size();
+				state.set_bytes_processed(length);
+			});
+
+		for (Base64Codec::Kernel kernel : { Base64Codec::Kernel::TABLE, Base64Codec::Kernel::SSSE3, Base64Codec::Kernel::AVX2 })
+		{
+			if (!Base64Codec::is_supported(kernel))
+				continue;
+
+			add(std::string("base64/encode/") + Base64Codec::kernel_name(kernel) + suffix, [bytes, kernel](BenchmarkState& state)
+				{
+					std::string output(Base64Codec::encoded_size(bytes.size()), '\0');
+					while (state.keep_running())
+						Base64Codec::encode(reinterpret_cast<const uint8_t*>(bytes.data()), bytes.size(), &output[0], Base64Codec::LINE_LENGTH, kernel);
+					state.set_bytes_processed(state.iterations() * bytes.size());
+				});
+			add(std::string("base64/decode/") + Base64Codec::kernel_name(kernel) + suffix, [text, kernel](BenchmarkState& state)
+				{
+					std::vector<uint8_t> output(Base64Codec::max_decoded_size(text.size()));
+					uint64_t length = 0;
+					while (state.keep_running())
+						length += Base64Codec::decode(text.data(), text.size(), output.data(), kernel);
+					state.set_bytes_processed(length);
+				});
+		}
+	}
+}
+
+void Benchmark::add_client_id_cases()
+{
+	// Symmetric key lookups for a known peer among 1000, keyed as before (hex) and now (binary).
+	const size_t peer_count = 1000;
+	std::vector<ClientId> peers;
+	for (size_t i = 0; i < peer_count; i++)
+	{
+		uint8_t bytes[ClientId::SIZE];
+		for (size_t j = 0; j < ClientId::SIZE; j++)
+			bytes[j] = static_cast<uint8_t>((i * 131 + j * 17) ^ (i >> 8));
+		peers.push_back(ClientId(bytes));
+	}
+
+	add("client_id/lookup/hex_key", [peers](BenchmarkState& state)
+		{
+			std::unordered_map<std::string, std::string> symmetric_keys;
+			std::vector<std::vector<uint8_t>> peer_ids;
+			for (const ClientId& peer : peers)
+			{
+				peer_ids.emplace_back(peer.data(), peer.data() + ClientId::SIZE);
+				symmetric_keys[bytes_to_hex_string(peer_ids.back())] = peer.to_hex();
+			}
+
+			uint64_t found = 0;
+			size_t next = 0;
+			while (state.keep_running())
+			{
+				auto key = symmetric_keys.find(bytes_to_hex_string(peer_ids[next]));
+				found += hex_string_to_bytes(key->second).size() == ClientId::SIZE;
+				next = (next + 1) % peer_ids.size();
+			}
+			state.set_items_processed(found);
+		});
+
+	add("client_id/lookup/binary_key", [peers](BenchmarkState& state)
+		{
+			std::unordered_map<ClientId, std::shared_ptr<AESWrapper>, ClientIdHash> symmetric_keys;
+			for (const ClientId& peer : peers)
+				symmetric_keys[peer] = std::make_shared<AESWrapper>();
+
+			uint64_t found = 0;
+			size_t next = 0;
+			while (state.keep_running())
+			{
+				auto key = symmetric_keys.find(peers[next]);
+				found += key->second != nullptr;
+				next = (next + 1) % peers.size();
+			}
+			state.set_items_processed(found);
+		});
+}
+
+void Benchmark::add_backlog_cases()
+{
+	// A reconnect backlog of wrapped symmetric keys, the RSA-bound part of a pending messages drain.
+	const size_t backlog_size = 64;
+	const unsigned int cores = std::max(1u, std::thread::hardware_concurrency());
+
+	for (unsigned int threads : { 0u, cores })
+	{
+		std::string name = threads == 0 ? "rsa/backlog/serial" : "rsa/backlog/parallel/threads:" + std::to_string(threads);
+		add(name, [backlog_size, threads](BenchmarkState& state)
+			{
+				RSAPrivateWrapper rsa_private;
+				RSAPublicWrapper rsa_public(rsa_private.getPublicKey());
+				std::vector<std::string> backlog;
+				for (size_t i = 0; i < backlog_size; i++)
+				{
+					AESWrapper aes;
+					backlog.push_back(rsa_public.encrypt(std::string(reinterpret_cast<const char*>(aes.getKey()), AESWrapper::DEFAULT_KEYLENGTH)));
+				}
+
+				std::unique_ptr<boost::asio::thread_pool> pool(threads ? new boost::asio::thread_pool(threads) : nullptr);
+				uint64_t messages = 0;
+				while (state.keep_running())
+				{
+					if (!pool)
+					{
+						for (const std::string& cipher : backlog)
+							messages += rsa_private.decrypt(cipher).size() == AESWrapper::DEFAULT_KEYLENGTH;
+						continue;
+					}
+
+					std::vector<std::future<bool>> decrypted;
+					for (const std::string& cipher : backlog)
+					{
+						auto task = std::make_shared<std::packaged_task<bool()>>([&rsa_private, &cipher]()
+							{
+								return rsa_private.decrypt(cipher).size() == AESWrapper::DEFAULT_KEYLENGTH;
+							});
+						decrypted.push_back(task->get_future());
+						boost::asio::post(*pool, [task]() { (*task)(); });
+					}
+					for (auto& message : decrypted)
+						messages += message.get();
+				}
+				state.set_items_processed(messages);
+			});
+	}
+}
+
+/**
+ * @brief Returns a deterministic payload of the given size.
+ */
+static std::string make_payload(size_t size)
+{
+	std::string payload(size, '\0');
+	for (size_t i = 0; i < size; i++)
+		payload[i] = static_cast<char>(i * 131 + (i >> 8));
+	return payload;
+}
+
+void Benchmark::add_primitive_cases()
+{
+	// 16 B to 64 MiB in steps of 16x. Inputs are built inside each case, so only the running
+	// case holds its buffers.
+	const size_t sizes[] = { 16, 256, 4096, 64 * 1024, 1 << 20, 16 << 20, 64 << 20 };
+	const ClientId client_id = make_client_id(0x11);
+	const ClientId target_id = make_client_id(0x22);
+
+	add("primitive/pack_header/vector", [client_id](BenchmarkState& state)
+		{
+			RequestBuilder request_builder;
+			RequestHeader header{ client_id, CLIENT_VERSION, SEND_MESSAGE, 1024 };
+			uint64_t bytes = 0;
+			while (state.keep_running())
+				bytes += request_builder.pack_header(header).size();
+			state.set_items_processed(state.iterations());
+			state.set_bytes_processed(bytes);
+		});
+	add("primitive/pack_header/buffer", [client_id](BenchmarkState& state)
+		{
+			RequestBuilder request_builder;
+			RequestHeader header{ client_id, CLIENT_VERSION, SEND_MESSAGE, 1024 };
+			uint8_t header_buffer[REQUEST_HEADER_SIZE];
+			uint64_t bytes = 0;
+			while (state.keep_running())
+			{
+				request_builder.pack_header(header, header_buffer);
+				bytes += header_buffer[0] ? REQUEST_HEADER_SIZE : 0;
+			}
+			state.set_items_processed(state.iterations());
+			state.set_bytes_processed(bytes);
+		});
+
+	add("primitive/build_registration_request", [](BenchmarkState& state)
+		{
+			RequestBuilder request_builder;
+			std::vector<uint8_t> public_key(MAX_PUBLIC_KEY_SIZE, 0x5a);
+			uint64_t bytes = 0;
+			while (state.keep_running())
+				bytes += request_builder.build_registration_request("benchmark", public_key).size();
+			state.set_items_processed(state.iterations());
+			state.set_bytes_processed(bytes);
+		});
+	add("primitive/build_client_list_request", [client_id](BenchmarkState& state)
+		{
+			RequestBuilder request_builder;
+			uint64_t bytes = 0;
+			while (state.keep_running())
+				bytes += request_builder.build_client_list_request(client_id).size();
+			state.set_items_processed(state.iterations());
+			state.set_bytes_processed(bytes);
+		});
+	add("primitive/build_public_key_request", [client_id, target_id](BenchmarkState& state)
+		{
+			RequestBuilder request_builder;
+			uint64_t bytes = 0;
+			while (state.keep_running())
+				bytes += request_builder.build_public_key_request(client_id, target_id).size();
+			state.set_items_processed(state.iterations());
+			state.set_bytes_processed(bytes);
+		});
+	add("primitive/build_pending_messages_request", [client_id](BenchmarkState& state)
+		{
+			RequestBuilder request_builder;
+			uint64_t bytes = 0;
+			while (state.keep_running())
+				bytes += request_builder.build_pending_messages_request(client_id).size();
+			state.set_items_processed(state.iterations());
+			state.set_bytes_processed(bytes);
+		});
+
+	add("primitive/get_response_header", [](BenchmarkState& state)
+		{
+			ResponseHandler response_handler;
+			// Version 2, code 2103 (message sent), 16-byte payload.
+			boost::array<uint8_t, RESPONSE_HEADER_SIZE> response_header = { { 2, 0x37, 0x08, 0x10, 0x00, 0x00, 0x00 } };
+			uint64_t bytes = 0;
+			while (state.keep_running())
+				bytes += response_handler.get_response_header(response_header).code == MESSAGE_SENT ? RESPONSE_HEADER_SIZE : 0;
+			state.set_items_processed(state.iterations());
+			state.set_bytes_processed(bytes);
+		});
+
+	// Each sized case is registered at every size before the next one, so a filter such as
+	// "primitive/aes_encrypt" lists one primitive from the smallest size to the largest.
+	auto add_sized = [this, &sizes](const std::string& name, std::function<Function(size_t)> make_case)
+	{
+		for (size_t size : sizes)
+			add(name + "/size:" + std::to_string(size), make_case(size));
+	};
+
+	add_sized("primitive/build_send_message_request", [client_id, target_id](size_t size)
+		{
+			return [client_id, target_id, size](BenchmarkState& state)
+			{
+				RequestBuilder request_builder;
+				std::string content = make_payload(size);
+				uint64_t bytes = 0;
+				while (state.keep_running())
+					bytes += request_builder.build_send_message_request(client_id, target_id, MessageType::TEXT_MESSAGE_SEND, content).size();
+				state.set_items_processed(state.iterations());
+				state.set_bytes_processed(bytes);
+			};
+		});
+	add_sized("primitive/bytes_to_hex_string", [](size_t size)
+		{
+			return [size](BenchmarkState& state)
+			{
+				std::string payload = make_payload(size);
+				std::vector<uint8_t> bytes(payload.begin(), payload.end());
+				uint64_t length = 0;
+				while (state.keep_running())
+					length += bytes_to_hex_string(bytes).size();
+				state.set_bytes_processed(length / 2);
+			};
+		});
+	add_sized("primitive/hex_string_to_bytes", [](size_t size)
+		{
+			return [size](BenchmarkState& state)
+			{
+				std::string payload = make_payload(size);
+				std::string hex = bytes_to_hex_string(std::vector<uint8_t>(payload.begin(), payload.end()));
+				uint64_t length = 0;
+				while (state.keep_running())
+					length += hex_string_to_bytes(hex).size();
+				state.set_bytes_processed(length);
+			};
+		});
+	add_sized("primitive/base64_encode", [](size_t size)
+		{
+			return [size](BenchmarkState& state)
+			{
+				std::string payload = make_payload(size);
+				uint64_t length = 0;
+				while (state.keep_running())
+					length += Base64Wrapper::encode(payload).size() ? payload.size() : 0;
+				state.set_bytes_processed(length);
+			};
+		});
+	add_sized("primitive/base64_decode", [](size_t size)
+		{
+			return [size](BenchmarkState& state)
+			{
+				std::string encoded = Base64Wrapper::encode(make_payload(size));
+				uint64_t length = 0;
+				while (state.keep_running())
+					length += Base64Wrapper::decode(encoded).size();
+				state.set_bytes_processed(length);
+			};
+		});
+	add_sized("primitive/aes_encrypt", [](size_t size)
+		{
+			return [size](BenchmarkState& state)
+			{
+				AESWrapper aes;
+				std::string plain = make_payload(size);
+				uint64_t length = 0;
+				while (state.keep_running())
+					length += aes.encrypt(plain.data(), static_cast<unsigned int>(plain.size())).size() ? plain.size() : 0;
+				state.set_bytes_processed(length);
+			};
+		});
+	add_sized("primitive/aes_decrypt", [](size_t size)
+		{
+			return [size](BenchmarkState& state)
+			{
+				AESWrapper aes;
+				std::string plain = make_payload(size);
+				std::string cipher = aes.encrypt(plain.data(), static_cast<unsigned int>(plain.size()));
+				uint64_t length = 0;
+				while (state.keep_running())
+					length += aes.decrypt(cipher.data(), static_cast<unsigned int>(cipher.size())).size();
+				state.set_bytes_processed(length);
+			};
+		});
+
+	// RSA-1024 with OAEP-SHA1 takes at most 86 bytes of plaintext, so RSA stops at a symmetric
+	// key and a full block; anything larger goes through AES.
+	for (size_t size : { size_t(16), size_t(86) })
+	{
+		std::string suffix = "/size:" + std::to_string(size);
+
+		add("primitive/rsa_public_encrypt" + suffix, [size](BenchmarkState& state)
+			{
+				RSAPrivateWrapper rsa_private;
+				RSAPublicWrapper rsa_public(rsa_private.getPublicKey());
+				std::string plain = make_payload(size);
+				uint64_t length = 0;
+				while (state.keep_running())
+					length += rsa_public.encrypt(plain).size() ? plain.size() : 0;
+				state.set_items_processed(state.iterations());
+				state.set_bytes_processed(length);
+			});
+		add("primitive/rsa_private_decrypt" + suffix, [size](BenchmarkState& state)
+			{
+				RSAPrivateWrapper rsa_private;
+				RSAPublicWrapper rsa_public(rsa_private.getPublicKey());
+				std::string cipher = rsa_public.encrypt(make_payload(size));
+				uint64_t length = 0;
+				while (state.keep_running())
+					length += rsa_private.decrypt(cipher).size();
+				state.set_items_processed(state.iterations());
+				state.set_bytes_processed(length);
+			});
+	}
+}
+
+/**
+ * @brief A large file in the temporary directory, removed when the case ends.
+ */
+class TemporaryFile
+{
+public:
+	TemporaryFile(const std::string& name, uint64_t size)
+		: path_((std::filesystem::temp_directory_path() / name).string())
+	{
+		std::ofstream file(path_, std::ios::binary | std::ios::trunc);
+		std::string block = make_payload(FILE_CHUNK_SIZE * 16);
+		for (uint64_t written = 0; written < size; written += block.size())
+			file.write(block.data(), static_cast<std::streamsize>(std::min<uint64_t>(block.size(), size - written)));
+		if (!file)
+			throw std::runtime_error("Unable to write " + path_);
+	}
+
+	~TemporaryFile()
+	{
+		std::error_code ignored;
+		std::filesystem::remove(path_, ignored);
+	}
+
+	const std::string& path() const { return path_; }
+
+private:
+	std::string path_;
+};
+
+/**
+ * @brief Receives the checksums, so that the compiler cannot drop the reads.
+ */
+static volatile uint64_t fold_sink;
+
+/**
+ * @brief Folds a range into a checksum, so that every byte read is also touched.
+ */
+static uint64_t fold(const char* data, size_t length)
+{
+	uint64_t sum = 0;
+	size_t i = 0;
+	for (; i + sizeof(uint64_t) <= length; i += sizeof(uint64_t))
+	{
+		uint64_t word;
+		std::memcpy(&word, data + i, sizeof(word));
+		sum ^= word;
+	}
+	for (; i < length; i++)
+		sum += static_cast<unsigned char>(data[i]);
+	return sum;
+}
+
+void Benchmark::add_file_source_cases()
+{
+	// Every case reads the whole file and touches every byte. The file was just written, so it
+	// is read from the page cache; the cases compare the copies and calls, not the disk.
+	const uint64_t file_size = 256 * 1024 * 1024;
+	const size_t window_size = 1024 * 1024;
+	const std::string suffix = "/256MiB";
+
+	// The original request_send_file: the whole file copied into a vector one character at a time.
+	add("file_source/read/istreambuf_copy" + suffix, [file_size](BenchmarkState& state)
+		{
+			TemporaryFile source("messageu_file_source.bin", file_size);
+			uint64_t bytes = 0, checksum = 0;
+			while (state.keep_running())
+			{
+				std::ifstream file(source.path(), std::ios::binary);
+				std::vector<char> content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+				checksum += fold(content.data(), content.size());
+				bytes += content.size();
+			}
+			state.set_bytes_processed(bytes);
+			fold_sink = checksum;
+		});
+
+	// The windowed ifstream reads that FileSource replaced.
+	add("file_source/read/stream_window" + suffix, [file_size](BenchmarkState& state)
+		{
+			TemporaryFile source("messageu_file_source.bin", file_size);
+			std::vector<char> window(FILE_CHUNK_SIZE);
+			uint64_t bytes = 0, checksum = 0;
+			while (state.keep_running())
+			{
+				std::ifstream file(source.path(), std::ios::binary);
+				for (uint64_t offset = 0; offset < file_size; offset += window.size())
+				{
+					file.read(window.data(), window.size());
+					checksum += fold(window.data(), static_cast<size_t>(file.gcount()));
+				}
+				bytes += file_size;
+			}
+			state.set_bytes_processed(bytes);
+			fold_sink = checksum;
+		});
+
+	add("file_source/read/buffered" + suffix, [file_size, window_size](BenchmarkState& state)
+		{
+			TemporaryFile source("messageu_file_source.bin", file_size);
+			std::string buffer;
+			uint64_t bytes = 0, checksum = 0;
+			while (state.keep_running())
+			{
+				BufferedFileSource file(source.path());
+				for (uint64_t offset = 0; offset < file.size(); offset += window_size)
+				{
+					size_t length = static_cast<size_t>(std::min<uint64_t>(window_size, file.size() - offset));
+					checksum += fold(file.read(offset, length, buffer), length);
+				}
+				bytes += file.size();
+			}
+			state.set_bytes_processed(bytes);
+			fold_sink = checksum;
+		});
+
+	add("file_source/read/mapped" + suffix, [file_size, window_size](BenchmarkState& state)
+		{
+			TemporaryFile source("messageu_file_source.bin", file_size);
+			std::string buffer;
+			uint64_t bytes = 0, checksum = 0;
+			while (state.keep_running())
+			{
+				MappedFileSource file(source.path());
+				for (uint64_t offset = 0; offset < file.size(); offset += window_size)
+				{
+					size_t length = static_cast<size_t>(std::min<uint64_t>(window_size, file.size() - offset));
+					checksum += fold(file.read(offset, length, buffer), length);
+				}
+				bytes += file.size();
+			}
+			state.set_bytes_processed(bytes);
+			fold_sink = checksum;
+		});
+}
+
+void Benchmark::add_crypto_provider_cases()
+{
+	// The same operations on each provider, called directly so that "--crypto" does not matter.
+	for (const CryptoProvider* provider : CryptoProvider::all())
+	{
+		const std::string prefix = std::string("crypto/") + provider->name() + "/";
+
+		for (size_t size : { size_t(64), size_t(16 << 20) })
+		{
+			const std::string suffix = size < 1024 ? "/" + std::to_string(size) : "/" + std::to_string(size >> 20) + "MiB";
+
+			add(prefix + "aes_cbc_encrypt" + suffix, [provider, size](BenchmarkState& state)
+				{
+					unsigned char key[AESWrapper::DEFAULT_KEYLENGTH];
+					provider->random_bytes(key, sizeof(key));
+					std::unique_ptr<AESCipher> aes = provider->aes(key, sizeof(key));
+					std::string plain(size, 'p');
+					std::string cipher;
+
+					while (state.keep_running())
+					{
+						std::unique_ptr<CBCStream> encryptor = aes->cbc_encryptor();
+						encryptor->update(plain.data(), plain.size(), cipher);
+						encryptor->finish(cipher);
+					}
+					state.set_items_processed(state.iterations());
+					state.set_bytes_processed(state.iterations() * size);
+				});
+			add(prefix + "aes_cbc_decrypt" + suffix, [provider, size](BenchmarkState& state)
+				{
+					unsigned char key[AESWrapper::DEFAULT_KEYLENGTH];
+					provider->random_bytes(key, sizeof(key));
+					std::unique_ptr<AESCipher> aes = provider->aes(key, sizeof(key));
+					std::string plain(size, 'p');
+					std::string cipher, last, output;
+					std::unique_ptr<CBCStream> encryptor = aes->cbc_encryptor();
+					encryptor->update(plain.data(), plain.size(), cipher);
+					encryptor->finish(last);
+					cipher += last;
+
+					while (state.keep_running())
+					{
+						std::unique_ptr<CBCStream> decryptor = aes->cbc_decryptor();
+						decryptor->update(cipher.data(), cipher.size(), output);
+						decryptor->finish(output);
+					}
+					state.set_items_processed(state.iterations());
+					state.set_bytes_processed(state.iterations() * size);
+				});
+		}
+
+		const size_t gcm_size = 1 << 20;
+		add(prefix + "aes_gcm_seal/1MiB", [provider, gcm_size](BenchmarkState& state)
+			{
+				unsigned char key[AESWrapper::DEFAULT_KEYLENGTH], nonce[GCMChunk::HEADER_SIZE], tag[GCMChunk::TAG_SIZE];
+				provider->random_bytes(key, sizeof(key));
+				provider->random_bytes(nonce, sizeof(nonce));
+				std::unique_ptr<AESCipher> aes = provider->aes(key, sizeof(key));
+				std::vector<unsigned char> plain(gcm_size, 'p'), cipher(gcm_size);
+				const unsigned char aad[8] = {};
+
+				while (state.keep_running())
+					aes->gcm_seal(nonce, sizeof(nonce), aad, sizeof(aad), plain.data(), plain.size(), cipher.data(), tag, sizeof(tag));
+				state.set_bytes_processed(state.iterations() * gcm_size);
+			});
+		add(prefix + "aes_gcm_open/1MiB", [provider, gcm_size](BenchmarkState& state)
+			{
+				unsigned char key[AESWrapper::DEFAULT_KEYLENGTH], nonce[GCMChunk::HEADER_SIZE], tag[GCMChunk::TAG_SIZE];
+				provider->random_bytes(key, sizeof(key));
+				provider->random_bytes(nonce, sizeof(nonce));
+				std::unique_ptr<AESCipher> aes = provider->aes(key, sizeof(key));
+				std::vector<unsigned char> plain(gcm_size, 'p'), cipher(gcm_size);
+				const unsigned char aad[8] = {};
+				aes->gcm_seal(nonce, sizeof(nonce), aad, sizeof(aad), plain.data(), plain.size(), cipher.data(), tag, sizeof(tag));
+
+				uint64_t bytes = 0;
+				while (state.keep_running())
+					bytes += aes->gcm_open(nonce, sizeof(nonce), aad, sizeof(aad), cipher.data(), cipher.size(), tag, sizeof(tag), plain.data()) ? gcm_size : 0;
+				state.set_bytes_processed(bytes);
+			});
+
+		// A wrapped symmetric key, as sent with SYMMETRIC_KEY_SEND.
+		add(prefix + "rsa_encrypt", [provider](BenchmarkState& state)
+			{
+				std::unique_ptr<RSAPrivateKey> private_key = provider->generate_rsa_private_key(RSAPrivateWrapper::BITS);
+				std::string public_der = private_key->public_der();
+				std::unique_ptr<RSAPublicKey> public_key = provider->rsa_public_key(public_der.data(), public_der.size());
+				const std::string symmetric_key(AESWrapper::DEFAULT_KEYLENGTH, 'k');
+
+				uint64_t bytes = 0;
+				while (state.keep_running())
+					bytes += public_key->encrypt(symmetric_key.data(), symmetric_key.size()).size();
+				state.set_items_processed(state.iterations());
+				state.set_bytes_processed(bytes);
+			});
+		add(prefix + "rsa_decrypt", [provider](BenchmarkState& state)
+			{
+				std::unique_ptr<RSAPrivateKey> private_key = provider->generate_rsa_private_key(RSAPrivateWrapper::BITS);
+				std::string public_der = private_key->public_der();
+				std::unique_ptr<RSAPublicKey> public_key = provider->rsa_public_key(public_der.data(), public_der.size());
+				const std::string symmetric_key(AESWrapper::DEFAULT_KEYLENGTH, 'k');
+				std::string cipher = public_key->encrypt(symmetric_key.data(), symmetric_key.size());
+
+				uint64_t keys = 0;
+				while (state.keep_running())
+					keys += private_key->decrypt(cipher.data(), cipher.size()) == symmetric_key;
+				state.set_items_processed(keys);
+			});
+		add(prefix + "rsa_generate", [provider](BenchmarkState& state)
+			{
+				uint64_t keys = 0;
+				while (state.keep_running())
+					keys += provider->generate_rsa_private_key(RSAPrivateWrapper::BITS)->public_der().size() == RSAPublicWrapper::KEYSIZE;
+				state.set_items_processed(keys);
+			});
+	}
+}
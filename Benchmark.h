@@ -0,0 +1,201 @@
+/**
+ * @file Benchmark.h
+ * @brief Declaration of the benchmark runner for the MessageU project.
+ *
+ * The client executable runs the registered benchmark cases when started with
+ * "--benchmark [filter] [--json file]". Each case reports its timing and throughput, as a
+ * table and optionally as JSON in the Google Benchmark format.
+ *
+ * @version 2.0
+ * @author Dmitriy Gorodov
+ * @id 324725405
+ * @date 16/10/2026
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <iosfwd>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Iteration state handed to a benchmark case.
+ *
+ * A case loops on keep_running() and performs one unit of work per iteration. Timing starts
+ * with the first call, so setup done before the loop is not measured.
+ */
+class BenchmarkState
+{
+public:
+	explicit BenchmarkState(double min_time_seconds);
+
+	/**
+	 * @brief Returns true while the case should run another iteration.
+	 */
+	bool keep_running();
+
+	/**
+	 * @brief Sets the number of logical items (messages, records...) processed by the whole run.
+	 */
+	void set_items_processed(uint64_t items);
+
+	/**
+	 * @brief Sets the number of bytes processed by the whole run.
+	 */
+	void set_bytes_processed(uint64_t bytes);
+
+	/**
+	 * @brief Reports an extra per-case value, e.g. heap allocations per iteration.
+	 */
+	void set_counter(const std::string& name, double value);
+
+	uint64_t iterations() const;
+	double elapsed_seconds() const;
+	uint64_t items_processed() const;
+	uint64_t bytes_processed() const;
+	const std::vector<std::pair<std::string, double>>& counters() const;
+
+private:
+	double min_time_seconds_;
+	uint64_t iterations_;
+	uint64_t items_processed_;
+	uint64_t bytes_processed_;
+	std::vector<std::pair<std::string, double>> counters_;
+	bool started_;
+	std::chrono::steady_clock::time_point start_;
+	std::chrono::steady_clock::time_point end_;
+};
+
+/**
+ * @brief Result of a single benchmark case.
+ */
+struct BenchmarkResult
+{
+	std::string name;
+	uint64_t iterations;
+	double seconds;
+	uint64_t items;
+	uint64_t bytes;
+	std::vector<std::pair<std::string, double>> counters;
+};
+
+/**
+ * @brief The Benchmark class holds the benchmark cases and runs them.
+ */
+class Benchmark
+{
+public:
+	typedef std::function<void(BenchmarkState&)> Function;
+
+	static constexpr double DEFAULT_MIN_TIME_SECONDS = 0.5;
+
+	/**
+	 * @brief Constructs the runner and registers all benchmark cases.
+	 */
+	Benchmark();
+
+	/**
+	 * @brief Registers a benchmark case.
+	 * @param name Unique case name, e.g. "pipeline/depth:32/latency:5ms".
+	 * @param function The case body.
+	 */
+	void add(const std::string& name, Function function);
+
+	/**
+	 * @brief Runs all cases whose name contains the filter.
+	 * @param filter Substring to match; empty runs everything.
+	 * @return The results in registration order.
+	 */
+	std::vector<BenchmarkResult> run(const std::string& filter);
+
+	/**
+	 * @brief Prints the results as a table.
+	 */
+	void print(const std::vector<BenchmarkResult>& results) const;
+
+	/**
+	 * @brief Writes the results as JSON in the layout of Google Benchmark's --benchmark_format=json.
+	 *
+	 * Times are per iteration in nanoseconds; throughput and extra counters are per-benchmark fields.
+	 */
+	static void write_json(const std::vector<BenchmarkResult>& results, std::ostream& out);
+
+	/**
+	 * @brief Returns the number of global operator new calls made by the process so far, or 0
+	 *        unless the build defines MESSAGEU_COUNT_ALLOCATIONS.
+	 */
+	static uint64_t allocation_count();
+
+private:
+	std::vector<std::pair<std::string, Function>> cases_;
+
+	/**
+	 * @brief Registers the pipelined request engine cases (messages/sec against link latency).
+	 */
+	void add_pipeline_cases();
+
+	/**
+	 * @brief Registers the request serialization cases (copying vs. gathered builders).
+	 */
+	void add_serialization_cases();
+
+	/**
+	 * @brief Registers the private key cases (per-message key setup vs. a reused context).
+	 */
+	void add_private_key_cases();
+
+	/**
+	 * @brief Registers the public key cases (per-call key parsing vs. a cached peer encryptor).
+	 */
+	void add_public_key_cases();
+
+	/**
+	 * @brief Registers the symmetric key cases (per-message AES re-keying vs. a per-peer session).
+	 */
+	void add_symmetric_key_cases();
+
+	/**
+	 * @brief Registers the file cipher cases (serial CBC stream vs. chunked GCM on N threads).
+	 */
+	void add_file_cipher_cases();
+
+	/**
+	 * @brief Registers the hex codec cases (the former stream-based conversions vs. each kernel).
+	 */
+	void add_hex_cases();
+
+	/**
+	 * @brief Registers the Base64 codec cases (the former Crypto++ filter chain vs. each kernel).
+	 */
+	void add_base64_cases();
+
+	/**
+	 * @brief Registers the peer map cases (hex string keys vs. binary ClientId keys).
+	 */
+	void add_client_id_cases();
+
+	/**
+	 * @brief Registers the backlog cases (wrapped keys decrypted serially vs. on a thread pool).
+	 */
+	void add_backlog_cases();
+
+	/**
+	 * @brief Registers the primitive cases: each protocol, encoding and crypto building block
+	 *        on its own, at payload sizes from 16 B to 64 MiB.
+	 */
+	void add_primitive_cases();
+
+	/**
+	 * @brief Registers the file source cases (the former stream reads vs. buffered and mapped sources).
+	 */
+	void add_file_source_cases();
+
+	/**
+	 * @brief Registers the crypto provider cases: AES-CBC, AES-GCM and RSA on every built provider.
+	 */
+	void add_crypto_provider_cases();
+};
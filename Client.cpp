@@ -14,25 +14,45 @@
 #include "Client.h"
 #include "RSAWrapper.h"
 #include "AESWrapper.h"
+#include "GCMChunkCipher.h"
+#include "FilePart.h"
 #include "Base64Wrapper.h"
 #include "RequestBuilder.h"
 #include "ResponseHandler.h"
+#include "PendingMessageParser.h"
+#include "Tracer.h"
 #include "utils.h"
+#include <algorithm>
+#include <deque>
 #include <iostream>
 #include <fstream>
+#include <functional>
 #include <sstream>
 #include <iomanip>
+#include <ctime>
 #include <stdexcept>
 #include <cstring>
+#include <thread>
 #include <boost/array.hpp>
 #include <filesystem>
 
 using boost::asio::ip::tcp;
 
-Client::Client(const std::string& server_ip, uint16_t server_port)
-    : server_ip_(server_ip), server_port_(server_port), socket_(io_context_) 
+Client::Client(const std::string& server_ip, uint16_t server_port, bool gcm_files)
+    : server_ip_(server_ip), server_port_(server_port), socket_(io_context_), pipeline_(socket_),
+      crypto_threads_(std::max(1u, std::thread::hardware_concurrency())), gcm_files_(gcm_files), crypto_pool_(crypto_threads_),
+      current_request_code_(0), peer_key_store_("peers.keys"), message_store_("history"),
+      search_index_("history/search.idx"), transfer_journal_("transfers.journal")
 {
     load_client_info();
+    if (!private_key_.empty())
+        open_local_stores();
+    transfer_journal_.load();
+    restore_incoming_transfers();
+}
+
+Client::~Client()
+{
 }
 
 void Client::run() 
@@ -67,6 +87,8 @@ void Client::run()
         if (choice == CommandCode::EXIT)
         {
             std::cout << "Client is shutting down...\n";
+            save_statistics();
+            search_index_.save();
             break;
         }
 
@@ -96,6 +118,18 @@ void Client::run()
 		case CommandCode::SEND_FILE:
 			request_send_file();
 			break;
+        case CommandCode::SEND_BROADCAST_MESSAGE:
+            request_send_broadcast_message();
+            break;
+        case CommandCode::SHOW_STATISTICS:
+            print_statistics();
+            break;
+        case CommandCode::SHOW_HISTORY:
+            request_message_history();
+            break;
+        case CommandCode::SEARCH_HISTORY:
+            request_message_search();
+            break;
         default:
             std::cout << "Invalid option. Please try again...\n";
             break;
@@ -121,12 +155,11 @@ void Client::load_client_info()
     }
 
     std::string id_hex;
-    if (!std::getline(file, id_hex) || id_hex.empty()) 
+    if (!std::getline(file, id_hex) || !ClientId::from_hex(id_hex, &client_id_)) 
     {
         std::cerr << "Error: 'my.info' is corrupted or improperly formatted (missing client ID).\n";
         exit(EXIT_FAILURE);
     }
-    client_id_ = hex_string_to_bytes(id_hex);
 
     std::stringstream ss;
     ss << file.rdbuf();
@@ -144,14 +177,33 @@ void Client::save_client_info() const
     std::ofstream file("my.info");
     if (!file)
         throw std::runtime_error("Unable to open my.info for writing.");
-    file << client_name_ << "\n" << bytes_to_hex_string(client_id_) << "\n" << private_key_;
+    file << client_name_ << "\n" << client_id_.to_hex() << "\n" << private_key_;
+}
+
+void Client::open_local_stores()
+{
+    try
+    {
+        peer_key_store_.open(Base64Wrapper::decode(private_key_));
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "Warning: unable to open the peer key store: " << e.what() << "\n";
+        return;
+    }
+
+    // Without the storage key nothing is written to the history.
+    message_store_.open(peer_key_store_.storage_key());
+    search_index_.open(message_store_, peer_key_store_.storage_key());
 }
 
 void Client::connect_to_server() 
 {
+    TRACE_SCOPE("connect_to_server", "net");
     tcp::resolver resolver(io_context_);
     auto endpoints = resolver.resolve(server_ip_, std::to_string(server_port_));
     boost::asio::connect(socket_, endpoints);
+    socket_.set_option(tcp::no_delay(true));
 	std::cout << "Connected to the server at " << server_ip_ << ":" << server_port_ << "\n";
 }
 
@@ -166,13 +218,17 @@ void Client::print_menu()
         << "151) Send a request for symmetric key\n"
         << "152) Send your symmetric key\n"
 		<< "153) Send a file\n"
+        << "154) Send a text message to several clients\n"
+        << "160) Show request latency statistics\n"
+        << "170) Show message history\n"
+        << "171) Search message history\n"
         << "0) Exit client\n"
         << "Enter choice: ";
 }
 
 bool Client::is_client_registered() 
 {
-    if (client_id_.empty()) 
+    if (client_id_.is_null()) 
     {
         std::cerr << "You must register first.\n";
         return false;
@@ -188,37 +244,60 @@ std::string Client::prompt_target_username()
     return target_username;
 }
 
-std::vector<uint8_t> Client::get_target_id(const std::string& target_username) 
+ClientId Client::get_target_id(const std::string& target_username) 
 {
-    std::vector<uint8_t> target_id = get_client_id_by_username(target_username);
-    if (target_id.empty()) 
+    ClientId target_id = get_client_id_by_username(target_username);
+    if (target_id.is_null()) 
     {
         std::cerr << "The user with the username \"" << target_username << "\" does not exist.\n";
     }
     return target_id;
 }
 
-bool Client::receive_response(std::vector<uint8_t>* response_payload) 
+bool Client::receive_response_header(ResponseHeader* response_header)
 {
-    try 
+    TRACE_SCOPE("read_response_header", "net");
+    try
     {
         boost::array<uint8_t, RESPONSE_HEADER_SIZE> response_header_raw;
-        boost::asio::read(socket_, boost::asio::buffer(response_header_raw));
+        {
+            PhaseTimer timer(stats_, current_request_code_, RequestPhase::WAIT);
+            boost::asio::read(socket_, boost::asio::buffer(response_header_raw));
+        }
 
         ResponseHandler response_handler;
-        ResponseHeader response_header_struct = response_handler.get_response_header(response_header_raw);
+        *response_header = response_handler.get_response_header(response_header_raw);
 
-        if (response_header_struct.code == SERVER_ERROR_CODE) 
+        if (response_header->code == SERVER_ERROR_CODE)
         {
-            std::cerr << "Server responded with an error: " << response_header_struct.code << "\n";
+            std::cerr << "Server responded with an error: " << response_header->code << "\n";
             return false;
         }
 
+        return true;
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "Communication error: " << e.what() << "\n";
+        return false;
+    }
+}
+
+bool Client::receive_response(std::vector<uint8_t>* response_payload) 
+{
+    ResponseHeader response_header_struct;
+    if (!receive_response_header(&response_header_struct))
+        return false;
+
+    try 
+    {
         uint32_t payload_size = response_header_struct.payload_size;
         response_payload->resize(payload_size);
 
         if (payload_size > 0) 
         {
+            TRACE_SCOPE("read_payload", "net");
+            PhaseTimer timer(stats_, current_request_code_, RequestPhase::READ);
             boost::asio::read(socket_, boost::asio::buffer(*response_payload));
         }
 
@@ -234,6 +313,7 @@ bool Client::receive_response(std::vector<uint8_t>* response_payload)
 
 void Client::register_client() 
 {
+    TRACE_SCOPE("register_client", "client");
     std::ifstream file("my.info");
     if (file) 
     {
@@ -249,8 +329,8 @@ void Client::register_client()
         return;
     }
 
-    RSAPrivateWrapper rsa_private;
-    std::string public_key = rsa_private.getPublicKey();
+    std::unique_ptr<RSAPrivateWrapper> rsa_private(new RSAPrivateWrapper());
+    std::string public_key = rsa_private->getPublicKey();
 
     if (public_key.size() < MAX_PUBLIC_KEY_SIZE)
         public_key.resize(MAX_PUBLIC_KEY_SIZE, '\0');
@@ -259,19 +339,23 @@ void Client::register_client()
     std::vector<uint8_t> public_key_bytes(public_key.begin(), public_key.end());
 
     RequestBuilder request_builder;
+    PhaseTimer serialize_timer(stats_, RequestCode::REGISTER_CLIENT, RequestPhase::SERIALIZE);
     std::vector<uint8_t> request = request_builder.build_registration_request(client_name_, public_key_bytes);
-    boost::asio::write(socket_, boost::asio::buffer(request));
+    serialize_timer.stop();
+    send_request(RequestCode::REGISTER_CLIENT, boost::asio::buffer(request));
 
     std::vector<uint8_t> response_payload;
-    if (receive_response(&response_payload)) 
+    if (receive_response(&response_payload) && response_payload.size() == ClientId::SIZE) 
     {
         std::cout << "Registration successful.\n";
-        client_id_ = response_payload;
+        client_id_ = ClientId(response_payload.data());
         
-        std::string private_key_bin = rsa_private.getPrivateKey();
+        std::string private_key_bin = rsa_private->getPrivateKey();
         std::string private_key_base64 = Base64Wrapper::encode(private_key_bin);
         private_key_ = private_key_base64;
+        rsa_private_ = std::move(rsa_private);
         save_client_info();
+        open_local_stores();
     }
     else 
     {
@@ -283,29 +367,17 @@ void Client::request_client_list()
 {
     if (!is_client_registered()) return;
 
-    RequestBuilder request_builder;
-    std::vector<uint8_t> request = request_builder.build_client_list_request(client_id_);
-    boost::asio::write(socket_, boost::asio::buffer(request));
-
-    std::vector<uint8_t> response_payload;
-	bool is_pending_messages_response = false;
-    if (receive_response(&response_payload)) 
+    if (refresh_directory()) 
     {
-        if (response_payload.empty())
+        if (directory_.names().empty())
         {
             std::cout << "No clients are currently registered.\n";
             return;
         }
 
-        uint16_t record_size = MAX_CLIENT_NAME_SIZE + MAX_CLIENT_ID_SIZE;
-        size_t num_records = response_payload.size() / record_size;
         std::cout << "Registered clients:\n";
-
-        for (size_t i = 0; i < num_records; i++) 
+        for (const auto& client_name : directory_.names()) 
         {
-            size_t offset = i * record_size;
-            std::string client_name(response_payload.begin() + offset + MAX_CLIENT_ID_SIZE, response_payload.begin() + offset + MAX_CLIENT_ID_SIZE + MAX_CLIENT_NAME_SIZE);
-            client_name.erase(std::find(client_name.begin(), client_name.end(), '\0'), client_name.end());
             std::cout << " - " << client_name << "\n";
         }
     } 
@@ -318,15 +390,18 @@ void Client::request_client_list()
 
 void Client::request_public_key() 
 {
+    TRACE_SCOPE("request_public_key", "client");
     if (!is_client_registered()) return;
 
     std::string target_username = prompt_target_username();
-    std::vector<uint8_t> target_id = get_target_id(target_username);
-    if (target_id.empty()) return;
+    ClientId target_id = get_target_id(target_username);
+    if (target_id.is_null()) return;
 
     RequestBuilder request_builder;
+    PhaseTimer serialize_timer(stats_, RequestCode::FETCH_PUBLIC_KEY, RequestPhase::SERIALIZE);
     std::vector<uint8_t> request = request_builder.build_public_key_request(client_id_, target_id);
-    boost::asio::write(socket_, boost::asio::buffer(request));
+    serialize_timer.stop();
+    send_request(RequestCode::FETCH_PUBLIC_KEY, boost::asio::buffer(request));
 
     std::vector<uint8_t> response_payload;
     if (receive_response(&response_payload)) 
@@ -335,9 +410,19 @@ void Client::request_public_key()
 
         if (response_payload.size() >= record_size) 
         {
-            std::vector<uint8_t> target_public_key(response_payload.begin() + 16, response_payload.begin() + record_size);
-            std::cout << "The public key has been received.\n";
-            public_keys_[bytes_to_hex_string(target_id)] = bytes_to_hex_string(target_public_key);
+            try
+            {
+                // Parse the key once; every later key exchange with this client reuses it.
+                const char* public_key = reinterpret_cast<const char*>(&response_payload[MAX_CLIENT_ID_SIZE]);
+                std::unique_ptr<RSAPublicWrapper> target_public_key(new RSAPublicWrapper(public_key, MAX_PUBLIC_KEY_SIZE));
+                public_keys_[target_id] = std::move(target_public_key);
+                peer_key_store_.put(target_id, PeerKeyStore::PUBLIC_KEY, std::string(public_key, MAX_PUBLIC_KEY_SIZE));
+                std::cout << "The public key has been received.\n";
+            }
+            catch (std::exception& e)
+            {
+                std::cerr << "Invalid public key received from server: " << e.what() << "\n";
+            }
         }
         else 
         {
@@ -348,89 +433,503 @@ void Client::request_public_key()
 
 void Client::request_pending_messages() 
 {
+    TRACE_SCOPE("request_pending_messages", "client");
     if (!is_client_registered()) return;
 
+    // The response is consumed while it streams in, so the directory is brought up to date first.
+    if (directory_.is_stale())
+        refresh_directory();
+
     RequestBuilder request_builder;
+    PhaseTimer serialize_timer(stats_, RequestCode::LIST_PENDING_MESSAGES, RequestPhase::SERIALIZE);
     std::vector<uint8_t> request = request_builder.build_pending_messages_request(client_id_);
+    serialize_timer.stop();
 
-    boost::asio::write(socket_, boost::asio::buffer(request));
+    send_request(RequestCode::LIST_PENDING_MESSAGES, boost::asio::buffer(request));
 
-    std::vector<uint8_t> response_payload;
-    if (receive_response(&response_payload)) 
+    ResponseHeader response_header;
+    if (!receive_response_header(&response_header))
+    {
+        std::cerr << "Failed to retrieve pending messages.\n";
+        return;
+    }
+
+    if (response_header.payload_size == 0)
+    {
+        std::cout << "There are no pending messages. You are up to date.\n";
+        return;
+    }
+
+    // File records are decrypted straight to disk instead of being buffered.
+    auto is_file_record = [](uint8_t message_type)
     {
-        if (response_payload.empty())
+        return message_type == MessageType::FILE_SEND || message_type == MessageType::FILE_SEND_GCM || message_type == MessageType::FILE_PART;
+    };
+
+    // Other records are decrypted on the crypto pool and printed in order as they complete.
+    IncomingBacklog backlog;
+    const size_t max_queued_messages = 4 * crypto_threads_;
+
+    PendingMessageHeader current_record;
+    std::vector<uint8_t> message_content;
+    IncomingFile incoming_file;
+
+    PendingMessageParser parser(
+        [&](const PendingMessageHeader& header)
         {
-            std::cout << "There are no pending messages. You are up to date.\n";
-            return;
+            current_record = header;
+
+            if (is_file_record(header.message_type))
+            {
+                // A file is written while it streams in, so everything before it is delivered first.
+                deliver_incoming_messages(&backlog, 0);
+                backlog.symmetric_keys.clear();
+                std::cout << "From: " << sender_name(header.sender_id, &backlog.may_refresh_directory, true) << "\n";
+                begin_incoming_file(header.sender_id, header.message_type, &incoming_file);
+            }
+            else
+            {
+                message_content.clear();
+            }
+        },
+        [&](const uint8_t* content, size_t length)
+        {
+            if (is_file_record(current_record.message_type))
+                write_incoming_file(&incoming_file, content, length);
+            else
+                message_content.insert(message_content.end(), content, content + length);
+        },
+        [&]()
+        {
+            if (is_file_record(current_record.message_type))
+            {
+                end_incoming_file(&incoming_file);
+                std::cout << "-----<EOM>-----\n\n";
+            }
+            else
+            {
+                queue_incoming_message(&backlog, current_record.sender_id, current_record.message_type, std::move(message_content));
+                message_content = std::vector<uint8_t>();
+                deliver_incoming_messages(&backlog, max_queued_messages);
+            }
+        });
+
+    // Only the time spent in the socket counts as READ; decryption is timed per message.
+    std::chrono::steady_clock::duration read_time = std::chrono::steady_clock::duration::zero();
+    try
+    {
+        std::vector<uint8_t> chunk(FILE_CHUNK_SIZE);
+        uint32_t remaining = response_header.payload_size;
+        while (remaining > 0)
+        {
+            auto read_started = std::chrono::steady_clock::now();
+            size_t bytes_read;
+            {
+                TRACE_SCOPE("read_payload", "net");
+                bytes_read = socket_.read_some(boost::asio::buffer(chunk.data(), std::min<size_t>(chunk.size(), remaining)));
+            }
+            read_time += std::chrono::steady_clock::now() - read_started;
+            remaining -= static_cast<uint32_t>(bytes_read);
+            parser.feed(chunk.data(), bytes_read);
         }
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "Communication error: " << e.what() << "\n";
+    }
+    stats_.record(RequestCode::LIST_PENDING_MESSAGES, RequestPhase::READ, read_time);
+
+    // Whatever was received is delivered, even if reading the rest of the response failed.
+    try
+    {
+        deliver_incoming_messages(&backlog, 0);
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "Error delivering pending messages: " << e.what() << "\n";
+    }
+
+    if (parser.in_record())
+    {
+        std::cerr << "The pending messages response ended in the middle of a message.\n";
+        if (incoming_file.is_open())
+            discard_incoming_file(&incoming_file);
+    }
+
+    // The whole drain is written to the history with a single sync.
+    message_store_.flush();
+    search_index_.update(message_store_);
+}
+
+void Client::begin_incoming_file(const ClientId& sender_id, uint8_t message_type, IncomingFile* incoming_file)
+{
+    incoming_file->decryptor.reset();
+    incoming_file->chunked_decryptor.reset();
+    incoming_file->part_session.reset();
+    incoming_file->transfer = nullptr;
+    incoming_file->path.clear();
+    incoming_file->decrypt_time = std::chrono::steady_clock::duration::zero();
+    incoming_file->sender_id = sender_id;
+    incoming_file->message_type = message_type;
+
+    std::shared_ptr<AESWrapper> symmetric_key = find_symmetric_key(sender_id);
+    if (!symmetric_key)
+    {
+        std::cerr << "Content:\nCan't decrypt the file (symmetric key not found).\n";
+        return;
+    }
+
+    // A part's destination and decryptor depend on its part header, which starts the content.
+    if (message_type == MessageType::FILE_PART)
+    {
+        incoming_file->part_session = symmetric_key;
+        incoming_file->part_header_bytes.clear();
+        incoming_file->part_written = 0;
+        return;
+    }
 
-        std::unordered_map<std::string, std::string> client_map = get_client_mapping();
-        std::unordered_map<std::string, std::string> client_reverse_map;
+    incoming_file->path = make_received_file_path();
+    incoming_file->file.open(incoming_file->path, std::ios::binary | std::ios::trunc);
+    if (!incoming_file->file)
+    {
+        std::cerr << "Error saving file to " << incoming_file->path << "\n";
+        return;
+    }
 
-        for (const auto& pair : client_map) 
+    if (message_type == MessageType::FILE_SEND_GCM)
+        incoming_file->chunked_decryptor.reset(new GCMChunkDecryptor(symmetric_key, &crypto_pool_, crypto_threads_));
+    else
+        incoming_file->decryptor.reset(new AESStreamDecryptor(symmetric_key));
+}
+
+void Client::write_incoming_file(IncomingFile* incoming_file, const uint8_t* content, size_t length)
+{
+    TRACE_SCOPE("write_incoming_file", "messages");
+    if (!incoming_file->is_open()) return;
+
+    try
+    {
+        if (incoming_file->part_session && !incoming_file->chunked_decryptor)
         {
-            client_reverse_map[pair.second] = pair.first;
+            size_t header_length = std::min(length, FilePart::HEADER_SIZE - incoming_file->part_header_bytes.size());
+            incoming_file->part_header_bytes.append(reinterpret_cast<const char*>(content), header_length);
+            content += header_length;
+            length -= header_length;
+            if (incoming_file->part_header_bytes.size() < FilePart::HEADER_SIZE)
+                return;
+            begin_file_part(incoming_file);
+            if (!incoming_file->chunked_decryptor)
+                return;
         }
 
-        size_t offset = 0;
-        while (offset < response_payload.size()) 
+        auto decrypt_started = std::chrono::steady_clock::now();
+        if (incoming_file->chunked_decryptor)
+            incoming_file->chunked_decryptor->update(reinterpret_cast<const char*>(content), length, incoming_file->plain);
+        else
+            incoming_file->decryptor->update(reinterpret_cast<const char*>(content), length, incoming_file->plain);
+        incoming_file->decrypt_time += std::chrono::steady_clock::now() - decrypt_started;
+        store_incoming_plain(incoming_file);
+    }
+    catch (std::exception& e)
+    {
+        std::cerr << "Content:\nError decrypting file: " << e.what() << "\n";
+        discard_incoming_file(incoming_file);
+    }
+}
+
+void Client::begin_file_part(IncomingFile* incoming_file)
+{
+    FilePartHeader& header = incoming_file->part_header;
+    if (!FilePartHeader::parse(reinterpret_cast<const uint8_t*>(incoming_file->part_header_bytes.data()), &header))
+        throw std::runtime_error("invalid file part header");
+
+    // A completed transfer stays in the journal for a while, so late copies of its parts are recognized.
+    TransferRecord* completed = transfer_journal_.find(header.transfer_id);
+    if (completed && completed->direction == TransferRecord::INCOMING && completed->is_complete())
+    {
+        std::cout << "Content:\nPart " << header.index + 1 << " of " << header.count << " of an already saved file; ignoring the copy.\n";
+        incoming_file->part_session.reset();
+        return;
+    }
+
+    std::string transfer_key(header.transfer_id.begin(), header.transfer_id.end());
+    auto transfer_found = incoming_transfers_.find(transfer_key);
+    if (transfer_found == incoming_transfers_.end())
+    {
+        TransferRecord record;
+        record.direction = TransferRecord::INCOMING;
+        record.header = header;
+        record.peer_id = incoming_file->sender_id;
+        record.path = make_received_file_path() + "_" + bytes_to_hex_string(std::vector<uint8_t>(header.transfer_id.begin(), header.transfer_id.begin() + 4));
+
+        std::unique_ptr<IncomingTransfer> transfer(new IncomingTransfer());
+        transfer->file.open(record.path, std::ios::binary | std::ios::trunc);
+        if (!transfer->file)
+            throw std::runtime_error("unable to create " + record.path);
+        transfer->record = transfer_journal_.add(std::move(record));
+        transfer_found = incoming_transfers_.emplace(transfer_key, std::move(transfer)).first;
+    }
+
+    IncomingTransfer& transfer = *transfer_found->second;
+    if (transfer.record->peer_id != incoming_file->sender_id || !transfer.record->header.same_transfer(header))
+        throw std::runtime_error("file part does not match its transfer");
+
+    // A part whose acknowledgement the sender missed is sent again when the transfer resumes.
+    if (transfer.record->done[header.index])
+    {
+        std::cout << "Content:\nPart " << header.index + 1 << " of " << header.count << " of a file was already received; ignoring the copy.\n";
+        incoming_file->part_session.reset();
+        return;
+    }
+
+    incoming_file->transfer = &transfer;
+    incoming_file->path = transfer.record->path;
+    incoming_file->chunked_decryptor.reset(new GCMChunkDecryptor(incoming_file->part_session, &crypto_pool_, crypto_threads_, incoming_file->part_header_bytes));
+}
+
+void Client::restore_incoming_transfers()
+{
+    for (TransferRecord* record : transfer_journal_.records(TransferRecord::INCOMING))
+    {
+        if (record->is_complete())
+            continue;
+
+        // The parts already received are kept, so the file is opened without truncating it.
+        std::unique_ptr<IncomingTransfer> transfer(new IncomingTransfer());
+        transfer->record = record;
+        if (std::filesystem::exists(record->path))
+            transfer->file.open(record->path, std::ios::binary | std::ios::in | std::ios::out);
+        if (!transfer->file.is_open())
         {
-			uint8_t record_size = MAX_CLIENT_ID_SIZE + MAX_MESSAGE_ID_BYTES + MAX_MESSAGE_TYPE_BYTES + MAX_MESSAGE_CONTENT_BYTES;
-            
-            if (offset + record_size > response_payload.size())
-                break;
+            transfer_journal_.remove(record);
+            continue;
+        }
+
+        std::string transfer_key(record->header.transfer_id.begin(), record->header.transfer_id.end());
+        incoming_transfers_.emplace(transfer_key, std::move(transfer));
+    }
+}
 
-            std::vector<uint8_t> sender_id(response_payload.begin() + offset, response_payload.begin() + offset + MAX_CLIENT_ID_SIZE);
-            offset += MAX_CLIENT_ID_SIZE;
+void Client::store_incoming_plain(IncomingFile* incoming_file)
+{
+    if (incoming_file->plain.empty())
+        return;
 
-            uint32_t message_id;
-            memcpy(&message_id, &response_payload[offset], MAX_MESSAGE_ID_BYTES);
-            offset += MAX_MESSAGE_ID_BYTES;
+    if (!incoming_file->transfer)
+    {
+        incoming_file->file.write(incoming_file->plain.data(), incoming_file->plain.size());
+        return;
+    }
 
-            uint8_t message_type = response_payload[offset];
-            offset += MAX_MESSAGE_TYPE_BYTES;
+    // Parts may arrive in any order, so each one is written at its own offset.
+    const FilePartHeader& header = incoming_file->part_header;
+    if (incoming_file->part_written + incoming_file->plain.size() > header.length())
+        throw std::runtime_error("file part is longer than announced");
 
-            uint32_t message_size;
-            memcpy(&message_size, &response_payload[offset], MAX_MESSAGE_CONTENT_BYTES);
-            offset += MAX_MESSAGE_CONTENT_BYTES;
+    std::ofstream& file = incoming_file->transfer->file;
+    file.seekp(static_cast<std::streamoff>(header.offset() + incoming_file->part_written));
+    file.write(incoming_file->plain.data(), incoming_file->plain.size());
+    incoming_file->part_written += incoming_file->plain.size();
+}
 
-            if (offset + message_size > response_payload.size())
-                break;
+void Client::end_incoming_file(IncomingFile* incoming_file)
+{
+    TRACE_SCOPE("end_incoming_file", "messages");
+    if (!incoming_file->is_open()) return;
 
-            std::vector<uint8_t> message_content(response_payload.begin() + offset, response_payload.begin() + offset + message_size);
-            offset += message_size;
+    try
+    {
+        if (incoming_file->part_session && !incoming_file->chunked_decryptor)
+            throw std::runtime_error("file part is truncated");
 
-            std::string sender_id_hex = bytes_to_hex_string(sender_id);
-            std::string sender_username = client_reverse_map[sender_id_hex];
-            std::cout << "From: " << sender_username << "\n";
+        auto decrypt_started = std::chrono::steady_clock::now();
+        if (incoming_file->chunked_decryptor)
+            incoming_file->chunked_decryptor->finish(incoming_file->plain);
+        else
+            incoming_file->decryptor->finish(incoming_file->plain);
+        incoming_file->decrypt_time += std::chrono::steady_clock::now() - decrypt_started;
+        stats_.record(RequestCode::LIST_PENDING_MESSAGES, RequestPhase::DECRYPT, incoming_file->decrypt_time);
+        store_incoming_plain(incoming_file);
+        incoming_file->decryptor.reset();
+        incoming_file->chunked_decryptor.reset();
+
+        if (incoming_file->transfer)
+        {
+            end_file_part(incoming_file);
+            return;
+        }
 
-            handle_incoming_message(sender_id_hex, message_type, message_content);
-            std::cout << "-----<EOM>-----\n\n";
+        incoming_file->file.close();
+        if (incoming_file->file.fail())
+        {
+            std::cerr << "Error saving file to " << incoming_file->path << "\n";
+            return;
         }
+        std::cout << "Content:\nFile saved at: " << incoming_file->path << "\n";
+        message_store_.append(incoming_file->sender_id, incoming_file->message_type, "File saved at: " + incoming_file->path);
     }
-    else 
+    catch (std::exception& e)
     {
-        std::cerr << "Failed to retrieve pending messages.\n";
+        std::cerr << "Content:\nError decrypting file: " << e.what() << "\n";
+        discard_incoming_file(incoming_file);
+    }
+}
+
+void Client::end_file_part(IncomingFile* incoming_file)
+{
+    IncomingTransfer* transfer = incoming_file->transfer;
+    const FilePartHeader& header = incoming_file->part_header;
+    if (incoming_file->part_written != header.length())
+        throw std::runtime_error("file part is shorter than announced");
+
+    incoming_file->part_session.reset();
+    incoming_file->transfer = nullptr;
+
+    // The part is checkpointed only once its data has left the stream.
+    transfer->file.flush();
+    if (transfer->file.fail())
+    {
+        std::cerr << "Error saving file to " << transfer->record->path << "\n";
+        return;
+    }
+
+    TransferRecord* record = transfer->record;
+    transfer_journal_.mark_done(record, header.index);
+    if (!record->is_complete())
+    {
+        std::cout << "Content:\nReceived part " << header.index + 1 << " of " << header.count << " of a file ("
+            << record->done_count << " of " << header.count << " parts received).\n";
+        return;
     }
+
+    // The completed record is kept by the journal; only the open file is released.
+    transfer->file.close();
+    if (transfer->file.fail())
+        std::cerr << "Error saving file to " << record->path << "\n";
+    else
+    {
+        std::cout << "Content:\nFile saved at: " << record->path << " (" << header.count << " parts)\n";
+        message_store_.append(record->peer_id, MessageType::FILE_PART, "File saved at: " + record->path);
+    }
+    incoming_transfers_.erase(std::string(header.transfer_id.begin(), header.transfer_id.end()));
+}
+
+void Client::discard_incoming_file(IncomingFile* incoming_file)
+{
+    incoming_file->decryptor.reset();
+    incoming_file->chunked_decryptor.reset();
+
+    // A bad part only leaves its own range missing; the other parts of the transfer are kept.
+    if (incoming_file->part_session)
+    {
+        incoming_file->part_session.reset();
+        incoming_file->transfer = nullptr;
+        return;
+    }
+
+    incoming_file->file.close();
+    std::error_code error;
+    std::filesystem::remove(incoming_file->path, error);
+}
+
+std::string Client::make_received_file_path() const
+{
+    char* tmp = nullptr;
+    size_t len = 0;
+    errno_t err = _dupenv_s(&tmp, &len, "TMP");
+    std::string tmp_dir = (err == 0 && tmp != nullptr) ? std::string(tmp) : "C:\\Temp";
+    if (tmp)
+    {
+        free(tmp);
+    }
+
+    std::ostringstream oss;
+    oss << tmp_dir << "\\received_file_" << std::time(nullptr);
+    return oss.str();
+}
+
+void Client::queue_incoming_message(IncomingBacklog* backlog, const ClientId& sender_id, uint8_t message_type, std::vector<uint8_t> message_content)
+{
+    // The sender's key as of this message: the last one queued in this backlog, or the known one.
+    std::shared_future<std::shared_ptr<AESWrapper>> symmetric_key;
+    auto queued_key = backlog->symmetric_keys.find(sender_id);
+    if (queued_key != backlog->symmetric_keys.end())
+    {
+        symmetric_key = queued_key->second;
+    }
+    else
+    {
+        std::promise<std::shared_ptr<AESWrapper>> current_key;
+        current_key.set_value(find_symmetric_key(sender_id));
+        symmetric_key = current_key.get_future().share();
+    }
+
+    const RSAPrivateWrapper* rsa_private = nullptr;
+    if (message_type == MessageType::SYMMETRIC_KEY_REQUEST || message_type == MessageType::SYMMETRIC_KEY_SEND)
+    {
+        try
+        {
+            rsa_private = &private_key_context();
+        }
+        catch (std::exception& e)
+        {
+            std::cerr << "Error loading the private key: " << e.what() << "\n";
+        }
+    }
+
+    std::shared_ptr<std::promise<std::shared_ptr<AESWrapper>>> received_key;
+    if (message_type == MessageType::SYMMETRIC_KEY_SEND)
+    {
+        received_key = std::make_shared<std::promise<std::shared_ptr<AESWrapper>>>();
+        backlog->symmetric_keys[sender_id] = received_key->get_future().share();
+    }
+
+    // Tasks only wait on keys of messages queued before them, which the pool has already started.
+    auto task = std::make_shared<std::packaged_task<DecryptedMessage()>>(
+        [sender_id, message_type, message_content = std::move(message_content), rsa_private, symmetric_key, received_key]()
+        {
+            // A failure is reported with the message, like the per-type errors, so it never leaves future::get().
+            DecryptedMessage message;
+            try
+            {
+                message = decrypt_incoming_message(message_type, message_content, rsa_private, symmetric_key, received_key.get());
+            }
+            catch (const std::exception& e)
+            {
+                message = DecryptedMessage();
+                message.error = std::string("Error decrypting message: ") + e.what();
+            }
+            message.sender_id = sender_id;
+            message.message_type = message_type;
+            return message;
+        });
+    backlog->messages.push_back(task->get_future());
+    boost::asio::post(crypto_pool_, [task]() { (*task)(); });
 }
 
-void Client::handle_incoming_message(const std::string& sender_id_hex, uint8_t message_type, const std::vector<uint8_t>& message_content) 
+Client::DecryptedMessage Client::decrypt_incoming_message(uint8_t message_type, const std::vector<uint8_t>& message_content, const RSAPrivateWrapper* rsa_private,
+    const std::shared_future<std::shared_ptr<AESWrapper>>& symmetric_key, std::promise<std::shared_ptr<AESWrapper>>* received_key)
 {
+    TRACE_SCOPE("decrypt_incoming_message", "messages");
+
+    DecryptedMessage message;
+    auto decrypt_started = std::chrono::steady_clock::now();
+    const char* content = reinterpret_cast<const char*>(message_content.data());
+    unsigned int content_length = static_cast<unsigned int>(message_content.size());
+
     switch (message_type)
     {
     case MessageType::SYMMETRIC_KEY_REQUEST:
     {
         try
         {
-            std::string decoded_private_key = Base64Wrapper::decode(private_key_);
-            RSAPrivateWrapper rsa_private(decoded_private_key);
-            std::string cipher_text(message_content.begin(), message_content.end());
-            std::string decrypted_message = rsa_private.decrypt(cipher_text);
-            std::cout << "Content:\n" << decrypted_message << "\n";
+            if (!rsa_private)
+                throw std::runtime_error("private key unavailable");
+            message.content = rsa_private->decrypt(content, content_length);
         }
         catch (std::exception& e)
         {
-            std::cerr << "Content:\nError decrypting message: " << e.what() << "\n";
+            message.error = std::string("Error decrypting message: ") + e.what();
         }
     }
     break;
@@ -439,127 +938,114 @@ void Client::handle_incoming_message(const std::string& sender_id_hex, uint8_t m
     {
         try
         {
-            std::string decoded_private_key = Base64Wrapper::decode(private_key_);
-            RSAPrivateWrapper rsa_private(decoded_private_key);
-            std::string cipher_text(message_content.begin(), message_content.end());
-            std::string decrypted_key = rsa_private.decrypt(cipher_text);
-            std::vector<uint8_t> symmetric_key(decrypted_key.begin(), decrypted_key.end());
+            if (!rsa_private)
+                throw std::runtime_error("private key unavailable");
+            std::string decrypted_key = rsa_private->decrypt(content, content_length);
 
-            if (symmetric_key.size() != AESWrapper::DEFAULT_KEYLENGTH)
+            if (decrypted_key.size() != AESWrapper::DEFAULT_KEYLENGTH)
             {
-                std::cerr << "Content:\nReceived symmetric key has invalid length.\n";
+                message.error = "Received symmetric key has invalid length.";
             }
             else
             {
-                std::cout << "Content:\nSymmetric key received\n";
-                symmetric_keys_[sender_id_hex] = bytes_to_hex_string(symmetric_key);
+                message.content = "Symmetric key received";
+                message.symmetric_key = std::make_shared<AESWrapper>(reinterpret_cast<const unsigned char*>(decrypted_key.data()), AESWrapper::DEFAULT_KEYLENGTH);
             }
         }
         catch (std::exception& e)
         {
-            std::cerr << "Content:\nError decrypting symmetric key: " << e.what() << "\n";
+            message.error = std::string("Error decrypting symmetric key: ") + e.what();
         }
+
+        // Later messages from the sender use this key, or the previous one if this one is unusable.
+        received_key->set_value(message.symmetric_key ? message.symmetric_key : symmetric_key.get());
     }
     break;
 
     case MessageType::TEXT_MESSAGE_SEND:
     {
-        auto symmetric_key_found = symmetric_keys_.find(sender_id_hex);
-        if (symmetric_key_found == symmetric_keys_.end())
+        std::shared_ptr<AESWrapper> sender_key = symmetric_key.get();
+        // Waiting for a key still being decrypted is not part of this message's decryption.
+        decrypt_started = std::chrono::steady_clock::now();
+        if (!sender_key)
         {
-            std::cerr << "Content:\nCan't decrypt the message (symmetric key not found).\n";
+            message.error = "Can't decrypt the message (symmetric key not found).";
         }
         else
         {
-            std::vector<uint8_t> symmetric_key_bytes = hex_string_to_bytes(symmetric_key_found->second);
             try
             {
-                AESWrapper aes(&symmetric_key_bytes[0], static_cast<unsigned int>(symmetric_key_bytes.size()));
-                std::string cipher_text(message_content.begin(), message_content.end());
-                std::string decrypted_message_text = aes.decrypt(cipher_text.c_str(), static_cast<unsigned int>(cipher_text.size()));
-                std::cout << "Content:\n" << decrypted_message_text << "\n";
+                message.content = sender_key->decrypt(content, content_length);
             }
             catch (std::exception& e)
             {
-                std::cerr << "Content:\nError decrypting message: " << e.what() << "\n";
+                message.error = std::string("Error decrypting message: ") + e.what();
             }
         }
     }
     break;
 
-    case MessageType::FILE_SEND:
+    default:
+        message.error = "Unknown message type.";
+        break;
+    }
+
+    message.decrypt_time = std::chrono::steady_clock::now() - decrypt_started;
+    return message;
+}
+
+void Client::deliver_incoming_messages(IncomingBacklog* backlog, size_t max_queued)
+{
+    TRACE_SCOPE("deliver_incoming_messages", "messages");
+    while (!backlog->messages.empty())
     {
-        auto symmetric_key_found = symmetric_keys_.find(sender_id_hex);
-        if (symmetric_key_found == symmetric_keys_.end())
+        std::future<DecryptedMessage>& next = backlog->messages.front();
+        if (backlog->messages.size() <= max_queued && next.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+            break;
+
+        DecryptedMessage message = next.get();
+        backlog->messages.pop_front();
+        stats_.record(RequestCode::LIST_PENDING_MESSAGES, RequestPhase::DECRYPT, message.decrypt_time);
+
+        std::cout << "From: " << sender_name(message.sender_id, &backlog->may_refresh_directory, true) << "\n";
+        if (message.error.empty())
         {
-            std::cerr << "Content:\nCan't decrypt the file (symmetric key not found).\n";
+            std::cout << "Content:\n" << message.content << "\n";
+            message_store_.append(message.sender_id, message.message_type, message.content);
         }
         else
         {
-            std::vector<uint8_t> symmetric_key_bytes = hex_string_to_bytes(symmetric_key_found->second);
-            try
-            {
-                AESWrapper aes(&symmetric_key_bytes[0], static_cast<unsigned int>(symmetric_key_bytes.size()));
-                std::string cipher_text(message_content.begin(), message_content.end());
-                std::string decrypted_file_content = aes.decrypt(cipher_text.c_str(), static_cast<unsigned int>(cipher_text.size()));
-
-                char* tmp = nullptr;
-                size_t len = 0;
-				errno_t err = _dupenv_s(&tmp, &len, "TMP");
-				std::string tmp_dir = (err == 0 && tmp != nullptr) ? std::string(tmp) : "C:\\Temp";
-				if (tmp)
-				{
-					free(tmp);
-				}
-
-                std::ostringstream oss;
-                oss << tmp_dir << "\\received_file_" << std::time(nullptr);
-				std::string temp_file_path = oss.str();
-
-                std::ofstream file(temp_file_path, std::ios::binary);
-                if (!file)
-                {
-					std::cerr << "Error saving file to " << temp_file_path << "\n";
-				}
-                else
-                {
-                    file.write(decrypted_file_content.c_str(), decrypted_file_content.size());
-                    file.close();
-                    std::cout << "Content:\nFile saved at: " << temp_file_path << "\n";
-                }
-
-            }
-            catch (std::exception& e)
-            {
-                std::cerr << "Content:\nError decrypting file: " << e.what() << "\n";
-            }
+            std::cerr << "Content:\n" << message.error << "\n";
         }
-    }
-	break;
 
-    default:
-        std::cerr << "Content:\nUnknown message type.\n";
-        break;
+        if (message.symmetric_key)
+            set_symmetric_key(message.sender_id, message.symmetric_key);
+        std::cout << "-----<EOM>-----\n\n";
     }
 }
 
 void Client::request_receive_symmetric_key() 
 {
+    TRACE_SCOPE("request_receive_symmetric_key", "client");
     if (!is_client_registered()) return;
 
     std::string target_username = prompt_target_username();
-    std::vector<uint8_t> target_id = get_target_id(target_username);
-    if (target_id.empty()) return;
+    ClientId target_id = get_target_id(target_username);
+    if (target_id.is_null()) return;
 
     if (!is_public_key(target_id, target_username)) return;
 
     std::string text_message = "Request for symmetric key";
+    PhaseTimer encrypt_timer(stats_, RequestCode::SEND_MESSAGE, RequestPhase::ENCRYPT);
     std::string encrypted_message = encrypt_with_public_key(target_id, text_message);
+    encrypt_timer.stop();
 
     RequestBuilder request_builder;
     MessageType message_type = MessageType::SYMMETRIC_KEY_REQUEST;
-    std::vector<uint8_t> request = request_builder.build_send_message_request(client_id_, target_id, message_type, encrypted_message);
-    boost::asio::write(socket_, boost::asio::buffer(request));
+    PhaseTimer serialize_timer(stats_, RequestCode::SEND_MESSAGE, RequestPhase::SERIALIZE);
+    GatherRequest request = request_builder.build_send_message_gather(client_id_, target_id, message_type, boost::asio::buffer(encrypted_message));
+    serialize_timer.stop();
+    send_request(RequestCode::SEND_MESSAGE, request.buffers());
 
     std::vector<uint8_t> response_payload;
     if (receive_response(&response_payload)) 
@@ -570,64 +1056,66 @@ void Client::request_receive_symmetric_key()
 
 void Client::request_send_symmetric_key() 
 {
+    TRACE_SCOPE("request_send_symmetric_key", "client");
     if (!is_client_registered()) return;
 
     std::string target_username = prompt_target_username();
-    std::vector<uint8_t> target_id = get_target_id(target_username);
-    if (target_id.empty()) return;
+    ClientId target_id = get_target_id(target_username);
+    if (target_id.is_null()) return;
 
     if (!is_public_key(target_id, target_username)) return;
 
-    AESWrapper aes;
-    const unsigned char* symmetric_key_raw = aes.getKey();
-    std::vector<uint8_t> symmetric_key(symmetric_key_raw, symmetric_key_raw + AESWrapper::DEFAULT_KEYLENGTH);
-
-    std::string symmetric_key_str(symmetric_key.begin(), symmetric_key.end());
+    std::shared_ptr<AESWrapper> symmetric_key = std::make_shared<AESWrapper>();
+    std::string symmetric_key_str(reinterpret_cast<const char*>(symmetric_key->getKey()), AESWrapper::DEFAULT_KEYLENGTH);
+    PhaseTimer encrypt_timer(stats_, RequestCode::SEND_MESSAGE, RequestPhase::ENCRYPT);
     std::string encrypted_symmetric_key = encrypt_with_public_key(target_id, symmetric_key_str);
+    encrypt_timer.stop();
 
     RequestBuilder request_builder;
     MessageType message_type = MessageType::SYMMETRIC_KEY_SEND;
-    std::vector<uint8_t> request = request_builder.build_send_message_request(client_id_, target_id, message_type, encrypted_symmetric_key);
-    boost::asio::write(socket_, boost::asio::buffer(request));
+    PhaseTimer serialize_timer(stats_, RequestCode::SEND_MESSAGE, RequestPhase::SERIALIZE);
+    GatherRequest request = request_builder.build_send_message_gather(client_id_, target_id, message_type, boost::asio::buffer(encrypted_symmetric_key));
+    serialize_timer.stop();
+    send_request(RequestCode::SEND_MESSAGE, request.buffers());
 
     std::vector<uint8_t> response_payload;
     if (receive_response(&response_payload)) 
     {
         std::cout << "The symmetric key successfully sent to " << target_username << ".\n";
-        symmetric_keys_[bytes_to_hex_string(target_id)] = bytes_to_hex_string(symmetric_key);
+        set_symmetric_key(target_id, symmetric_key);
     }
 }
 
 void Client::request_send_text_message() 
 {
+    TRACE_SCOPE("request_send_text_message", "client");
     if (!is_client_registered()) return;
 
     std::string target_username = prompt_target_username();
-    std::vector<uint8_t> target_id = get_target_id(target_username);
-    if (target_id.empty()) return;
-
-    std::string target_id_hex = bytes_to_hex_string(target_id);
+    ClientId target_id = get_target_id(target_username);
+    if (target_id.is_null()) return;
 
-    auto target_symmetric_key = symmetric_keys_.find(target_id_hex);
-    if (target_symmetric_key == symmetric_keys_.end()) 
+    std::shared_ptr<AESWrapper> target_symmetric_key = find_symmetric_key(target_id);
+    if (!target_symmetric_key) 
     {
         std::cerr << "Symmetric key for client " << target_username << " not found. Please request a key exchange first.\n";
         return;
     }
 
-    std::vector<uint8_t> target_symmetric_key_bytes = hex_string_to_bytes(target_symmetric_key->second);
-
     std::cout << "Enter your message:\n";
     std::string text_message;
     std::getline(std::cin, text_message);
 
-    AESWrapper aes(&target_symmetric_key_bytes[0], static_cast<unsigned int>(target_symmetric_key_bytes.size()));
-    std::string encrypted_message = aes.encrypt(text_message.c_str(), static_cast<unsigned int>(text_message.size()));
+    PhaseTimer encrypt_timer(stats_, RequestCode::SEND_MESSAGE, RequestPhase::ENCRYPT);
+    std::string encrypted_message = target_symmetric_key->encrypt(text_message.c_str(), static_cast<unsigned int>(text_message.size()));
+    encrypt_timer.stop();
 
     RequestBuilder request_builder;
     MessageType message_type = MessageType::TEXT_MESSAGE_SEND;
-    std::vector<uint8_t> request = request_builder.build_send_message_request(client_id_, target_id, message_type, encrypted_message);
-    boost::asio::write(socket_, boost::asio::buffer(request));
+    PhaseTimer serialize_timer(stats_, RequestCode::SEND_MESSAGE, RequestPhase::SERIALIZE);
+    GatherRequest request = request_builder.build_send_message_gather(client_id_, target_id, message_type, boost::asio::buffer(encrypted_message));
+    serialize_timer.stop();
+    send_request(RequestCode::SEND_MESSAGE, request.buffers());
 
     std::vector<uint8_t> response_payload;
     if (receive_response(&response_payload)) 
@@ -638,23 +1126,20 @@ void Client::request_send_text_message()
 
 void Client::request_send_file() 
 {
+   TRACE_SCOPE("request_send_file", "client");
    if (!is_client_registered()) return;
 
     std::string target_username = prompt_target_username();
-    std::vector<uint8_t> target_id = get_target_id(target_username);
-	if (target_id.empty()) return;
+    ClientId target_id = get_target_id(target_username);
+	if (target_id.is_null()) return;
 
-    std::string target_id_hex = bytes_to_hex_string(target_id);
-
-    auto target_symmetric_key = symmetric_keys_.find(target_id_hex);
-    if (target_symmetric_key == symmetric_keys_.end())
+    std::shared_ptr<AESWrapper> target_symmetric_key = find_symmetric_key(target_id);
+    if (!target_symmetric_key)
     {
         std::cerr << "Symmetric key for client " << target_username << " not found. Please request a key exchange first.\n";
         return;
     }
 
-    std::vector<uint8_t> target_symmetric_key_bytes = hex_string_to_bytes(target_symmetric_key->second);
-
 	std::cout << "Enter the path to the file you want to send: ";
 	std::string file_path;
 	std::getline(std::cin, file_path);
@@ -665,46 +1150,408 @@ void Client::request_send_file()
 		return;
     }
 
-	std::ifstream file(file_path, std::ios::binary);
+	// The file is memory-mapped where possible, so the encryptor reads it without a copy.
+	std::unique_ptr<FileSource> file = FileSource::open(file_path);
 	if (!file)
 	{
 		std::cerr << "Error opening file.\n";
 		return;
 	}
 
-	std::vector<uint8_t> file_content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
-	file.close();
+    uint64_t file_size = file->size();
+    // The GCM and multipart types are opt-in: a peer without them could not decrypt the file.
+    if (gcm_files_ && file_size >= MULTIPART_FILE_THRESHOLD)
+    {
+        send_file_parts(target_username, target_id, target_symmetric_key, file_path, *file);
+        return;
+    }
 
-    AESWrapper aes(&target_symmetric_key_bytes[0], static_cast<unsigned int>(target_symmetric_key_bytes.size()));
-	std::string encrypted_file_content = aes.encrypt(reinterpret_cast<const char*>(file_content.data()), static_cast<unsigned int>(file_content.size()));
+    // Large files use the chunked GCM format so that every core takes part in the encryption.
+    bool parallel = gcm_files_ && file_size >= PARALLEL_FILE_THRESHOLD;
+    uint64_t encrypted_file_size = parallel ? GCMChunk::cipher_length(file_size) : AESStreamEncryptor::cipher_length(file_size);
+    if (encrypted_file_size > MAX_SEND_CONTENT_SIZE)
+    {
+        std::cerr << "File is too large to send. Larger files are sent in parts when the client is started with --gcm-files.\n";
+        return;
+    }
 
     RequestBuilder request_builder;
-    MessageType message_type = MessageType::FILE_SEND;
-    std::vector<uint8_t> request = request_builder.build_send_message_request(client_id_, target_id, message_type, encrypted_file_content);
-    boost::asio::write(socket_, boost::asio::buffer(request));
+    MessageType message_type = parallel ? MessageType::FILE_SEND_GCM : MessageType::FILE_SEND;
+    PhaseTimer serialize_timer(stats_, RequestCode::SEND_MESSAGE, RequestPhase::SERIALIZE);
+    GatherRequest request_head = request_builder.build_send_message_head(client_id_, target_id, message_type, static_cast<uint32_t>(encrypted_file_size));
+    serialize_timer.stop();
+
+    // The request is written in pieces; encryption and writing are each recorded once, in total.
+    current_request_code_ = RequestCode::SEND_MESSAGE;
+    std::chrono::steady_clock::duration encrypt_time = std::chrono::steady_clock::duration::zero();
+    std::chrono::steady_clock::duration write_time = std::chrono::steady_clock::duration::zero();
+    auto write_started = std::chrono::steady_clock::now();
+    {
+        TRACE_SCOPE("write_request", "net");
+        boost::asio::write(socket_, request_head.buffers());
+    }
+    write_time += std::chrono::steady_clock::now() - write_started;
+
+    // Read, encrypt and send one window at a time so memory use does not depend on the file size.
+    std::unique_ptr<AESStreamEncryptor> encryptor;
+    std::unique_ptr<GCMChunkEncryptor> chunked_encryptor;
+    size_t window_size = FILE_CHUNK_SIZE;
+    if (parallel)
+    {
+        chunked_encryptor.reset(new GCMChunkEncryptor(target_symmetric_key, &crypto_pool_));
+        window_size = chunked_encryptor->chunk_size() * crypto_threads_;
+    }
+    else
+    {
+        encryptor.reset(new AESStreamEncryptor(target_symmetric_key));
+    }
+
+    std::string file_chunk;
+    std::string encrypted_chunk;
+    uint64_t bytes_read = 0;
+
+    while (bytes_read < file_size)
+    {
+        // Past the end of a file that shrank the window is zero-padded, keeping the announced size.
+        size_t chunk_size = static_cast<size_t>(std::min<uint64_t>(window_size, file_size - bytes_read));
+        const char* window = file->read(bytes_read, chunk_size, file_chunk);
+        bytes_read += chunk_size;
+
+        auto encrypt_started = std::chrono::steady_clock::now();
+        if (chunked_encryptor)
+            chunked_encryptor->encrypt(window, chunk_size, bytes_read == file_size, encrypted_chunk);
+        else
+            encryptor->update(window, chunk_size, encrypted_chunk);
+        write_started = std::chrono::steady_clock::now();
+        encrypt_time += write_started - encrypt_started;
+        {
+            TRACE_SCOPE("write_request", "net");
+            boost::asio::write(socket_, boost::asio::buffer(encrypted_chunk));
+        }
+        write_time += std::chrono::steady_clock::now() - write_started;
+    }
+    if (encryptor)
+    {
+        auto encrypt_started = std::chrono::steady_clock::now();
+        encryptor->finish(encrypted_chunk);
+        write_started = std::chrono::steady_clock::now();
+        encrypt_time += write_started - encrypt_started;
+        {
+            TRACE_SCOPE("write_request", "net");
+            boost::asio::write(socket_, boost::asio::buffer(encrypted_chunk));
+        }
+        write_time += std::chrono::steady_clock::now() - write_started;
+    }
+    stats_.record(RequestCode::SEND_MESSAGE, RequestPhase::ENCRYPT, encrypt_time);
+    stats_.record(RequestCode::SEND_MESSAGE, RequestPhase::WRITE, write_time);
+
+    bool file_read_failed = file->truncated();
+    file.reset();
 
     std::vector<uint8_t> response_payload;
     if (receive_response(&response_payload))
     {
-        std::cout << "File successfully sent to " << target_username << ".\n";
+        if (file_read_failed)
+            std::cerr << "The file changed while it was being sent; " << target_username << " received a zero-padded copy.\n";
+        else
+            std::cout << "File successfully sent to " << target_username << ".\n";
+    }
+
+}
+
+void Client::send_file_parts(const std::string& target_username, const ClientId& target_id, std::shared_ptr<AESWrapper> session, const std::string& file_path, FileSource& file)
+{
+    TRACE_SCOPE("send_file_parts", "client");
+    std::error_code error;
+    std::string absolute_path = std::filesystem::absolute(file_path, error).string();
+    int64_t modified = static_cast<int64_t>(std::filesystem::last_write_time(file_path, error).time_since_epoch().count());
+
+    uint64_t file_size = file.size();
+    TransferRecord* record = transfer_journal_.find_outgoing(target_id, absolute_path, file_size, modified);
+    if (record)
+    {
+        std::cout << "Resuming the transfer: " << record->done_count << " of " << record->header.count << " parts were already delivered.\n";
+    }
+    else
+    {
+        // An unfinished transfer of an older version of the file can no longer be resumed.
+        for (TransferRecord* stale : transfer_journal_.records(TransferRecord::OUTGOING))
+        {
+            if (stale->peer_id == target_id && stale->path == absolute_path)
+                transfer_journal_.remove(stale);
+        }
+
+        TransferRecord new_record;
+        new_record.direction = TransferRecord::OUTGOING;
+        new_record.header = FilePartHeader::for_file(file_size);
+        new_record.peer_id = target_id;
+        new_record.path = absolute_path;
+        new_record.modified = modified;
+        record = transfer_journal_.add(std::move(new_record));
+    }
+
+    for (unsigned int attempt = 1; ; attempt++)
+    {
+        std::cout << "Sending the file in " << record->header.count - record->done_count << " parts...\n";
+        send_missing_parts(record, session, file);
+
+        // Only a lost connection is retried; a part the server rejected would be rejected again.
+        if (record->is_complete() || pipeline_.last_error().empty() || attempt == FilePart::MAX_SEND_ATTEMPTS)
+            break;
+        std::cerr << "Connection lost after " << record->done_count << " of " << record->header.count << " parts; reconnecting...\n";
+        std::this_thread::sleep_for(std::chrono::seconds(attempt));
+        if (!reconnect_to_server())
+            break;
+    }
+
+    if (!record->is_complete())
+    {
+        std::cerr << "Sending the file to " << target_username << " stopped after " << record->done_count << " of " << record->header.count
+            << " parts. Send the same file again to resume.\n";
+        return;
+    }
+
+    uint32_t part_count = record->header.count;
+    transfer_journal_.remove(record);
+    if (file.truncated())
+        std::cerr << "The file changed while it was being sent; " << target_username << " received a zero-padded copy.\n";
+    else
+        std::cout << "File successfully sent to " << target_username << " in " << part_count << " parts.\n";
+}
+
+void Client::send_missing_parts(TransferRecord* record, std::shared_ptr<AESWrapper> session, FileSource& file)
+{
+    TRACE_SCOPE("send_missing_parts", "client");
+    const ClientId target_id = record->peer_id;
+    const size_t max_parts_in_memory = std::min(crypto_threads_ + 1, FilePart::MAX_PARTS_IN_MEMORY);
+    pipeline_.clear_error();
+
+    // A part lives from the moment it is read until the server has acknowledged it.
+    struct OutgoingPart
+    {
+        FilePartHeader header;
+        const char* plain;	// into the file mapping, or into buffer
+        std::string buffer;
+        std::string content;	// part header followed by the GCM content
+        std::chrono::steady_clock::duration encrypt_time;
+        std::string error;
+    };
+
+    const FilePartHeader& transfer = record->header;
+    RequestBuilder request_builder;
+    uint32_t next_part = 0;
+    size_t parts_in_memory = 0;
+    size_t parts_encrypting = 0;
+    bool failed = false;
+
+    // The io_context runs the pipeline and the completions of the pool's encryptions; the work
+    // guard keeps it running while a part is still being encrypted.
+    auto work = boost::asio::make_work_guard(io_context_);
+    std::function<void()> schedule_parts;
+    std::function<void(std::shared_ptr<OutgoingPart>)> submit_part;
+
+    schedule_parts = [&]()
+    {
+        while (!failed && parts_in_memory < max_parts_in_memory)
+        {
+            // Parts acknowledged by an earlier attempt are skipped.
+            while (next_part < transfer.count && record->done[next_part])
+                next_part++;
+            if (next_part == transfer.count)
+                break;
+
+            auto part = std::make_shared<OutgoingPart>();
+            part->header = transfer;
+            part->header.index = next_part++;
+            // A mapped part is not copied; the pool thread encrypts it straight from the mapping.
+            part->plain = file.read(part->header.offset(), part->header.length(), part->buffer);
+
+            parts_in_memory++;
+            parts_encrypting++;
+            boost::asio::post(crypto_pool_, [this, session, part, &submit_part]()
+                {
+                    TRACE_SCOPE("encrypt_file_part", "gcm");
+                    auto encrypt_started = std::chrono::steady_clock::now();
+                    try
+                    {
+                        // This already runs on a pool thread, so the part's chunks are sealed here.
+                        std::string part_header = part->header.pack();
+                        GCMChunkEncryptor encryptor(session, nullptr, GCMChunk::DEFAULT_CHUNK_SIZE, part_header);
+                        std::string cipher;
+                        encryptor.encrypt(part->plain, part->header.length(), true, cipher);
+                        part->content.reserve(part_header.size() + cipher.size());
+                        part->content.append(part_header).append(cipher);
+                    }
+                    catch (const std::exception& e)
+                    {
+                        part->error = e.what();
+                    }
+                    part->plain = nullptr;
+                    part->buffer = std::string();
+                    part->encrypt_time = std::chrono::steady_clock::now() - encrypt_started;
+                    boost::asio::post(io_context_, [part, &submit_part]() { submit_part(part); });
+                });
+        }
+
+        if (parts_encrypting == 0 && (failed || parts_in_memory == 0))
+            work.reset();
+    };
+
+    submit_part = [&](std::shared_ptr<OutgoingPart> part)
+    {
+        parts_encrypting--;
+        stats_.record(RequestCode::SEND_MESSAGE, RequestPhase::ENCRYPT, part->encrypt_time);
+        if (!part->error.empty() || failed)
+        {
+            if (!part->error.empty() && !failed)
+                std::cerr << "Error encrypting part " << part->header.index + 1 << ": " << part->error << "\n";
+            failed = true;
+            parts_in_memory--;
+            schedule_parts();
+            return;
+        }
+
+        PhaseTimer serialize_timer(stats_, RequestCode::SEND_MESSAGE, RequestPhase::SERIALIZE);
+        GatherRequest request = request_builder.build_send_message_gather(client_id_, target_id, MessageType::FILE_PART, boost::asio::buffer(part->content));
+        serialize_timer.stop();
+
+        // As on the synchronous path, WAIT runs from the end of the write to the response.
+        pipeline_.submit(request,
+            [&, part](bool success, const ResponseHeader&, std::vector<uint8_t>&)
+            {
+                if (pipeline_.last_error().empty())
+                    stats_.record(RequestCode::SEND_MESSAGE, RequestPhase::WAIT, std::chrono::steady_clock::now() - pipeline_.written_at());
+                parts_in_memory--;
+                if (success)
+                {
+                    transfer_journal_.mark_done(record, part->header.index);
+                }
+                else if (!failed)
+                {
+                    failed = true;
+                    if (!pipeline_.last_error().empty())
+                        std::cerr << "Communication error while sending part " << part->header.index + 1 << ": " << pipeline_.last_error() << "\n";
+                    else
+                        std::cerr << "Server rejected part " << part->header.index + 1 << " of the file.\n";
+                }
+                schedule_parts();
+            });
+    };
+
+    schedule_parts();
+    pipeline_.wait();
+}
+
+bool Client::reconnect_to_server()
+{
+    boost::system::error_code error;
+    socket_.close(error);
+    try
+    {
+        connect_to_server();
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "Unable to reconnect: " << e.what() << "\n";
+        return false;
+    }
+    pipeline_.clear_error();
+    return true;
+}
+
+void Client::request_send_broadcast_message()
+{
+    TRACE_SCOPE("request_send_broadcast_message", "client");
+    if (!is_client_registered()) return;
+
+    std::cout << "Enter the target clients' usernames (comma separated): ";
+    std::string target_usernames_line;
+    std::getline(std::cin, target_usernames_line);
+
+    std::vector<std::pair<std::string, ClientId>> targets;
+    std::stringstream target_usernames(target_usernames_line);
+    std::string target_username;
+    while (std::getline(target_usernames, target_username, ','))
+    {
+        target_username.erase(0, target_username.find_first_not_of(' '));
+        target_username.erase(target_username.find_last_not_of(' ') + 1);
+        if (target_username.empty()) continue;
+
+        ClientId target_id = get_target_id(target_username);
+        if (target_id.is_null()) continue;
+
+        if (!find_symmetric_key(target_id))
+        {
+            std::cerr << "Symmetric key for client " << target_username << " not found. Skipping.\n";
+            continue;
+        }
+        targets.emplace_back(target_username, target_id);
+    }
+
+    if (targets.empty())
+    {
+        std::cerr << "No valid target clients were given.\n";
+        return;
     }
 
+    std::cout << "Enter your message:\n";
+    std::string text_message;
+    std::getline(std::cin, text_message);
+
+    // The requests refer to the ciphertexts without copying them; they live until wait() returns.
+    std::deque<std::string> encrypted_messages;
+    RequestBuilder request_builder;
+    for (const auto& target : targets)
+    {
+        const AESWrapper& aes = *symmetric_keys_[target.second];
+        PhaseTimer encrypt_timer(stats_, RequestCode::SEND_MESSAGE, RequestPhase::ENCRYPT);
+        encrypted_messages.push_back(aes.encrypt(text_message.c_str(), static_cast<unsigned int>(text_message.size())));
+        encrypt_timer.stop();
+
+        PhaseTimer serialize_timer(stats_, RequestCode::SEND_MESSAGE, RequestPhase::SERIALIZE);
+        GatherRequest request = request_builder.build_send_message_gather(client_id_, target.second, MessageType::TEXT_MESSAGE_SEND, boost::asio::buffer(encrypted_messages.back()));
+        serialize_timer.stop();
+
+        // As on the synchronous path, WAIT runs from the end of the write to the response.
+        std::string target_username = target.first;
+        pipeline_.submit(request,
+            [this, target_username](bool success, const ResponseHeader&, std::vector<uint8_t>&)
+            {
+                if (pipeline_.last_error().empty())
+                    stats_.record(RequestCode::SEND_MESSAGE, RequestPhase::WAIT, std::chrono::steady_clock::now() - pipeline_.written_at());
+                if (success)
+                    std::cout << "Message successfully sent to " << target_username << ".\n";
+                else if (!pipeline_.last_error().empty())
+                    std::cerr << "Communication error while sending to " << target_username << ": " << pipeline_.last_error() << "\n";
+                else
+                    std::cerr << "Server rejected the message to " << target_username << ".\n";
+            });
+    }
+
+    pipeline_.wait();
 }
 
-std::string Client::encrypt_with_public_key(const std::vector<uint8_t>& target_id, const std::string& message) 
+RSAPrivateWrapper& Client::private_key_context()
 {
-    std::string target_id_hex = bytes_to_hex_string(target_id);
-    std::vector<uint8_t> target_public_key_bytes = hex_string_to_bytes(public_keys_[target_id_hex]);
+    if (!rsa_private_)
+    {
+        std::string decoded_private_key = Base64Wrapper::decode(private_key_);
+        rsa_private_.reset(new RSAPrivateWrapper(decoded_private_key));
+    }
+    return *rsa_private_;
+}
 
-    std::string public_key_str(target_public_key_bytes.begin(), target_public_key_bytes.end());
-    RSAPublicWrapper rsa_public(public_key_str);
-    return rsa_public.encrypt(message);
+std::string Client::encrypt_with_public_key(const ClientId& target_id, const std::string& message) 
+{
+    RSAPublicWrapper* target_public_key = find_public_key(target_id);
+    if (!target_public_key)
+        throw std::runtime_error("Public key not found");
+    return target_public_key->encrypt(message);
 }
 
-bool Client::is_public_key(const std::vector<uint8_t>& target_id, const std::string& target_username) 
+bool Client::is_public_key(const ClientId& target_id, const std::string& target_username) 
 {
-    auto target_public_key = public_keys_.find(bytes_to_hex_string(target_id));
-    if (target_public_key == public_keys_.end()) 
+    if (!find_public_key(target_id)) 
     {
         std::cerr << "Public key for client " << target_username << " not found. Please request the public key first.\n";
         return false;
@@ -712,62 +1559,280 @@ bool Client::is_public_key(const std::vector<uint8_t>& target_id, const std::str
     return true;
 }
 
-std::vector<uint8_t> Client::get_client_id_by_username(const std::string& username) 
+RSAPublicWrapper* Client::find_public_key(const ClientId& peer_id)
+{
+    auto loaded = public_keys_.find(peer_id);
+    if (loaded != public_keys_.end())
+        return loaded->second.get();
+
+    std::string public_key;
+    if (!peer_key_store_.find(peer_id, PeerKeyStore::PUBLIC_KEY, &public_key))
+        return nullptr;
+    try
+    {
+        std::unique_ptr<RSAPublicWrapper>& entry = public_keys_[peer_id];
+        entry.reset(new RSAPublicWrapper(public_key.data(), static_cast<unsigned int>(public_key.size())));
+        return entry.get();
+    }
+    catch (const std::exception&)
+    {
+        public_keys_.erase(peer_id);
+        return nullptr;
+    }
+}
+
+std::shared_ptr<AESWrapper> Client::find_symmetric_key(const ClientId& peer_id)
+{
+    auto loaded = symmetric_keys_.find(peer_id);
+    if (loaded != symmetric_keys_.end())
+        return loaded->second;
+
+    std::string key;
+    if (!peer_key_store_.find(peer_id, PeerKeyStore::SYMMETRIC_KEY, &key) || key.size() != AESWrapper::DEFAULT_KEYLENGTH)
+        return nullptr;
+    std::shared_ptr<AESWrapper> symmetric_key = std::make_shared<AESWrapper>(reinterpret_cast<const unsigned char*>(key.data()), AESWrapper::DEFAULT_KEYLENGTH);
+    symmetric_keys_[peer_id] = symmetric_key;
+    return symmetric_key;
+}
+
+void Client::set_symmetric_key(const ClientId& peer_id, std::shared_ptr<AESWrapper> symmetric_key)
 {
+    symmetric_keys_[peer_id] = symmetric_key;
+    peer_key_store_.put(peer_id, PeerKeyStore::SYMMETRIC_KEY, std::string(reinterpret_cast<const char*>(symmetric_key->getKey()), AESWrapper::DEFAULT_KEYLENGTH));
+}
+
+ClientId Client::get_client_id_by_username(const std::string& username) 
+{
+    bool refreshed = false;
+    if (directory_.is_stale())
+    {
+        if (!refresh_directory())
+            return ClientId();
+        refreshed = true;
+    }
+
+    ClientId client_id = directory_.find_id(username);
+
+    // The name may belong to a client that registered after the directory was loaded.
+    if (client_id.is_null() && !refreshed && refresh_directory())
+        client_id = directory_.find_id(username);
+
+    return client_id;
+}
+
+bool Client::refresh_directory() 
+{
+    TRACE_SCOPE("refresh_directory", "client");
     RequestBuilder request_builder;
+    PhaseTimer serialize_timer(stats_, RequestCode::LIST_ALL_CLIENTS, RequestPhase::SERIALIZE);
     std::vector<uint8_t> request = request_builder.build_client_list_request(client_id_);
-    boost::asio::write(socket_, boost::asio::buffer(request));
+    serialize_timer.stop();
+    send_request(RequestCode::LIST_ALL_CLIENTS, boost::asio::buffer(request));
 
     std::vector<uint8_t> response_payload;
     if (!receive_response(&response_payload)) 
     {
-        return std::vector<uint8_t>();
+        return false;
     }
 
-    uint16_t record_size = MAX_CLIENT_NAME_SIZE + MAX_CLIENT_ID_SIZE;
-    size_t num_records = response_payload.size() / record_size;
+    directory_.update(response_payload);
+    return true;
+}
 
-    for (size_t i = 0; i < num_records; i++) 
-    {
-        size_t offset = i * record_size;
-        std::string client_name(response_payload.begin() + offset + MAX_CLIENT_ID_SIZE, response_payload.begin() + offset + MAX_CLIENT_ID_SIZE + MAX_CLIENT_NAME_SIZE);
-        client_name.erase(std::find(client_name.begin(), client_name.end(), '\0'), client_name.end());
+bool Client::refresh_directory_on_new_connection()
+{
+    TRACE_SCOPE("refresh_directory_on_new_connection", "client");
+    tcp::socket socket(io_context_);
+    tcp::resolver resolver(io_context_);
+    boost::asio::connect(socket, resolver.resolve(server_ip_, std::to_string(server_port_)));
+
+    RequestBuilder request_builder;
+    std::vector<uint8_t> request = request_builder.build_client_list_request(client_id_);
+    boost::asio::write(socket, boost::asio::buffer(request));
+
+    boost::array<uint8_t, RESPONSE_HEADER_SIZE> response_header_raw;
+    boost::asio::read(socket, boost::asio::buffer(response_header_raw));
+    ResponseHandler response_handler;
+    ResponseHeader response_header = response_handler.get_response_header(response_header_raw);
+    if (response_header.code == SERVER_ERROR_CODE)
+        return false;
 
-        if (client_name == username) 
+    std::vector<uint8_t> response_payload(response_header.payload_size);
+    boost::asio::read(socket, boost::asio::buffer(response_payload));
+    directory_.update(response_payload);
+    return true;
+}
+
+std::string Client::sender_name(const ClientId& sender_id, bool* may_refresh, bool socket_busy)
+{
+    std::string name = directory_.find_name(sender_id);
+    if (!name.empty())
+        return name;
+
+    if (*may_refresh)
+    {
+        *may_refresh = false;
+        try
+        {
+            if (socket_busy ? refresh_directory_on_new_connection() : refresh_directory())
+                name = directory_.find_name(sender_id);
+        }
+        catch (const std::exception& e)
         {
-            std::vector<uint8_t> found_client_id(response_payload.begin() + offset, response_payload.begin() + offset + MAX_CLIENT_ID_SIZE);
-            return found_client_id;
+            std::cerr << "Unable to refresh the client list: " << e.what() << "\n";
         }
     }
-    return std::vector<uint8_t>();
+
+    return name.empty() ? sender_id.to_hex() : name;
 }
 
-std::unordered_map<std::string, std::string> Client::get_client_mapping() 
+void Client::print_statistics() const
 {
-    std::unordered_map<std::string, std::string> client_mapping;
+    if (stats_.empty())
+    {
+        std::cout << "No requests have been timed yet.\n";
+        return;
+    }
 
-    RequestBuilder request_builder;
-    std::vector<uint8_t> request = request_builder.build_client_list_request(client_id_);
-    boost::asio::write(socket_, boost::asio::buffer(request));
+    std::cout << "Request latency by phase:\n";
+    stats_.print(std::cout);
+}
 
-    std::vector<uint8_t> response_payload;
-    if (!receive_response(&response_payload)) 
+/**
+ * @brief Formats a time in milliseconds since the epoch as local "YYYY-MM-DD HH:MM:SS".
+ */
+static std::string format_time(int64_t milliseconds)
+{
+    std::time_t seconds = static_cast<std::time_t>(milliseconds / 1000);
+    std::tm local_time = {};
+#ifdef _WIN32
+    localtime_s(&local_time, &seconds);
+#else
+    localtime_r(&seconds, &local_time);
+#endif
+    std::ostringstream oss;
+    oss << std::put_time(&local_time, "%Y-%m-%d %H:%M:%S");
+    return oss.str();
+}
+
+void Client::request_message_history()
+{
+    TRACE_SCOPE("request_message_history", "client");
+    if (!is_client_registered()) return;
+
+    // Senders are shown by name, so the directory is brought up to date first.
+    bool may_refresh = !directory_.is_stale();
+    if (!may_refresh)
+        refresh_directory();
+
+    MessageQuery query;
+
+    std::cout << "Enter a username to show only their messages (empty for all): ";
+    std::string username;
+    std::getline(std::cin, username);
+    if (!username.empty())
+    {
+        query.sender_id = get_target_id(username);
+        if (query.sender_id.is_null()) return;
+    }
+
+    std::cout << "Enter the kind of messages (text, file, key; empty for all): ";
+    std::string kind;
+    std::getline(std::cin, kind);
+    if (kind == "text")
+        query.message_types = 1u << MessageType::TEXT_MESSAGE_SEND;
+    else if (kind == "file")
+        query.message_types = (1u << MessageType::FILE_SEND) | (1u << MessageType::FILE_SEND_GCM) | (1u << MessageType::FILE_PART);
+    else if (kind == "key")
+        query.message_types = (1u << MessageType::SYMMETRIC_KEY_REQUEST) | (1u << MessageType::SYMMETRIC_KEY_SEND);
+    else if (!kind.empty())
+    {
+        std::cerr << "Unknown kind of messages.\n";
+        return;
+    }
+
+    std::cout << "Enter the number of messages to show (default " << query.limit << "): ";
+    std::string limit;
+    std::getline(std::cin, limit);
+    try
+    {
+        if (!limit.empty())
+            query.limit = std::stoul(limit);
+    }
+    catch (const std::exception&)
     {
-        return client_mapping;
+        std::cerr << "Invalid number.\n";
+        return;
+    }
+
+    std::vector<StoredMessage> messages = message_store_.query(query);
+    if (messages.empty())
+    {
+        std::cout << "No stored messages match.\n";
+        return;
+    }
+
+    for (const auto& message : messages)
+    {
+        std::cout << "[" << format_time(message.received_at) << "] From: " << sender_name(message.sender_id, &may_refresh) << "\n"
+            << "Content:\n" << message.content << "\n-----<EOM>-----\n\n";
+    }
+    std::cout << messages.size() << " of " << message_store_.size() << " stored messages shown.\n";
+}
+
+void Client::request_message_search()
+{
+    TRACE_SCOPE("request_message_search", "client");
+    if (!is_client_registered()) return;
+
+    bool may_refresh = !directory_.is_stale();
+    if (!may_refresh)
+        refresh_directory();
+
+    std::cout << "Enter the words to search for: ";
+    std::string words;
+    std::getline(std::cin, words);
+    if (SearchIndex::split_words(words).empty())
+    {
+        std::cerr << "Enter at least one word.\n";
+        return;
     }
 
-    const uint16_t record_size = MAX_CLIENT_NAME_SIZE + MAX_CLIENT_ID_SIZE;
-    size_t num_records = response_payload.size() / record_size;
+    const size_t limit = 20;
+    auto started = std::chrono::steady_clock::now();
+    std::vector<uint32_t> positions = search_index_.search(words, limit);
+    auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started);
+    if (positions.empty())
+    {
+        std::cout << "No stored text messages contain these words.\n";
+        return;
+    }
 
-    for (size_t i = 0; i < num_records; i++) 
+    // Shown oldest first, like the history.
+    StoredMessage message;
+    for (auto position = positions.rbegin(); position != positions.rend(); ++position)
     {
-        size_t offset = i * record_size;
-        std::vector<uint8_t> user_id(response_payload.begin() + offset, response_payload.begin() + offset + MAX_CLIENT_ID_SIZE);
-        std::string user_id_hex = bytes_to_hex_string(user_id);
-        std::string username(response_payload.begin() + offset + 16, response_payload.begin() + offset + MAX_CLIENT_ID_SIZE + MAX_CLIENT_NAME_SIZE);
-        username.erase(std::find(username.begin(), username.end(), '\0'), username.end());
-        client_mapping[username] = user_id_hex;
+        if (!message_store_.read(*position, &message))
+            continue;
+        std::cout << "[" << format_time(message.received_at) << "] From: " << sender_name(message.sender_id, &may_refresh) << "\n"
+            << "Content:\n" << message.content << "\n-----<EOM>-----\n\n";
     }
+    std::ostringstream search_time;
+    search_time << std::fixed << std::setprecision(2) << elapsed.count();
+    std::cout << "The newest " << positions.size() << " matches shown (searched in " << search_time.str() << " ms).\n";
+}
 
-    return client_mapping;
-}
\ No newline at end of file
+void Client::save_statistics() const
+{
+    if (stats_.empty())
+        return;
+
+    std::ofstream file("latency_stats.json");
+    if (!file)
+    {
+        std::cerr << "Unable to open latency_stats.json for writing.\n";
+        return;
+    }
+    file << stats_.to_json();
+    std::cout << "Request latency statistics saved to latency_stats.json.\n";
+}
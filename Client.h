@@ -14,10 +14,33 @@
 
 #pragma once
 
+#include "ClientDirectory.h"
+#include "ClientId.h"
+#include "FilePart.h"
+#include "FileSource.h"
+#include "MessageStore.h"
+#include "PeerKeyStore.h"
+#include "RequestPipeline.h"
+#include "RequestStats.h"
+#include "SearchIndex.h"
+#include "TransferJournal.h"
+#include "Tracer.h"
+#include <chrono>
+#include <deque>
+#include <fstream>
+#include <future>
+#include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include <boost/asio.hpp>
 
+class AESStreamDecryptor;
+class AESWrapper;
+class GCMChunkDecryptor;
+class RSAPrivateWrapper;
+class RSAPublicWrapper;
+
 /**
  * @brief The Client class encapsulates the client-side functionality.
  *
@@ -32,8 +55,11 @@ public:
 	 *
 	 * @param server_ip The IP address of the server.
 	 * @param server_port The port number of the server.
+	 * @param gcm_files true to send large files as FILE_SEND_GCM and FILE_PART messages, which
+	 *                  only clients that support these types can receive ("--gcm-files").
 	 */
-	Client(const std::string& server_ip, uint16_t server_port);
+	Client(const std::string& server_ip, uint16_t server_port, bool gcm_files = false);
+	~Client();
 	
 	/**
 	 * @brief Runs the client, displaying the menu and handling user commands.
@@ -46,19 +72,85 @@ private:
 	boost::asio::io_context io_context_;
 	boost::asio::ip::tcp::socket socket_;
 
+	/**
+	 * @brief Asynchronous engine for operations that send several requests back to back.
+	 */
+	RequestPipeline pipeline_;
+
+	/**
+	 * @brief Worker threads for the parallel file cipher, one per core.
+	 */
+	size_t crypto_threads_;
+
+	/**
+	 * @brief Whether large files may use the message types this client added (5 and 6).
+	 */
+	bool gcm_files_;
+	boost::asio::thread_pool crypto_pool_;
+
+	/**
+	 * @brief Latency histograms of every request, by request code and phase (menu 160).
+	 */
+	RequestStats stats_;
+
+	/**
+	 * @brief Code of the last request written, under which its response is timed.
+	 */
+	uint16_t current_request_code_;
+
 	std::string client_name_;
-	std::vector<uint8_t> client_id_;
+	ClientId client_id_;
 	std::string private_key_;
 
 	/**
-	* @brief Mapping of client usernames to their IDs.
+	 * @brief Private key decryption context, parsed from private_key_ on first use.
+	 */
+	std::unique_ptr<RSAPrivateWrapper> rsa_private_;
+
+	/**
+	 * @brief Cached client list, indexed by username and by client ID.
+	 */
+	ClientDirectory directory_;
+
+	/**
+	* @brief Mapping of client IDs to their loaded public keys and encryptors.
 	*/
-	std::unordered_map<std::string, std::string> public_keys_;
+	std::unordered_map<ClientId, std::unique_ptr<RSAPublicWrapper>, ClientIdHash> public_keys_;
 
 	/**
-	* @brief Mapping of client usernames to their symmetric keys.
+	* @brief Mapping of client IDs to their symmetric key sessions.
+	*
+	* Each session holds its expanded key schedule, so messages and files to and from a peer
+	* reuse it instead of re-keying AES every time.
 	*/
-	std::unordered_map<std::string, std::string> symmetric_keys_;
+	std::unordered_map<ClientId, std::shared_ptr<AESWrapper>, ClientIdHash> symmetric_keys_;
+
+	/**
+	 * @brief The peers' keys from earlier sessions, kept encrypted in "peers.keys".
+	 *
+	 * public_keys_ and symmetric_keys_ are filled from it on a peer's first lookup.
+	 */
+	PeerKeyStore peer_key_store_;
+
+	/**
+	 * @brief The history of received messages, kept in "history" (menu 170).
+	 *
+	 * Messages are added as they are delivered and written once per pending-message drain.
+	 */
+	MessageStore message_store_;
+
+	/**
+	 * @brief The word index of the stored text messages (menu 171), saved on exit.
+	 *
+	 * It is brought up to date after every pending-message drain.
+	 */
+	SearchIndex search_index_;
+
+	/**
+	 * @brief Opens the local stores sealed with the storage key derived from the private key:
+	 *        the peer keys, the message history and its search index.
+	 */
+	void open_local_stores();
 
 	/**
 	 * @brief Loads the client information from "my.info" if it exists.
@@ -87,9 +179,9 @@ private:
 	/**
 	* @brief Gets the target client's ID based on username.
 	* @param target_username The target username.
-	* @return A vector of bytes representing the client ID.
+	* @return The client ID, or the null ID if the username is unknown.
 	*/
-	std::vector<uint8_t> get_target_id(const std::string& target_username);
+	ClientId get_target_id(const std::string& target_username);
 
 	/**
 	 * @brief Receives a response from the server.
@@ -100,12 +192,182 @@ private:
 	bool receive_response(std::vector<uint8_t> *response_payload);
 
 	/**
-	 * @brief Handles an incoming message from the server.
-	 * @param sender_id_hex The sender's client ID in hexadecimal.
+	 * @brief Receives only the header of a response, leaving the payload on the socket.
+	 *
+	 * @param response_header Pointer to store the response header.
+	 * @return true if a valid header is received, false otherwise.
+	 */
+	bool receive_response_header(ResponseHeader* response_header);
+
+	/**
+	 * @brief Writes a complete request and times the write.
+	 * @param request_code The request code; the response that follows is timed under it.
+	 * @param buffers The serialized request.
+	 */
+	template <typename ConstBufferSequence>
+	void send_request(uint16_t request_code, const ConstBufferSequence& buffers)
+	{
+		TRACE_SCOPE("write_request", "net");
+		current_request_code_ = request_code;
+		PhaseTimer timer(stats_, request_code, RequestPhase::WRITE);
+		boost::asio::write(socket_, buffers);
+	}
+
+	/**
+	 * @brief Checkpoints of unfinished multipart transfers, kept in "transfers.journal".
+	 */
+	TransferJournal transfer_journal_;
+
+	/**
+	 * @brief A multipart file being reassembled; its parts may arrive over several drains.
+	 */
+	struct IncomingTransfer
+	{
+		TransferRecord* record;	// sender, header, path and received parts, in transfer_journal_
+		std::ofstream file;
+	};
+
+	/**
+	 * @brief Multipart files with parts still missing, by transfer ID.
+	 */
+	std::unordered_map<std::string, std::unique_ptr<IncomingTransfer>> incoming_transfers_;
+
+	/**
+	 * @brief Reopens the files of the incoming transfers recorded in the journal.
+	 *
+	 * Completed transfers are skipped; transfers whose file has disappeared are dropped from the journal.
+	 */
+	void restore_incoming_transfers();
+
+	/**
+	 * @brief State of a received file that is decrypted straight to disk.
+	 */
+	struct IncomingFile
+	{
+		std::unique_ptr<AESStreamDecryptor> decryptor;
+		std::unique_ptr<GCMChunkDecryptor> chunked_decryptor;
+		std::ofstream file;
+		std::string path;
+		std::string plain;
+		std::chrono::steady_clock::duration decrypt_time = std::chrono::steady_clock::duration::zero();
+		ClientId sender_id;
+		uint8_t message_type = 0;
+
+		// FILE_PART records: the part header is collected before the decryptor can be created.
+		std::shared_ptr<AESWrapper> part_session;
+		std::string part_header_bytes;
+		FilePartHeader part_header;
+		IncomingTransfer* transfer = nullptr;
+		uint64_t part_written = 0;
+
+		bool is_open() const { return decryptor || chunked_decryptor || part_session; }
+	};
+
+	/**
+	 * @brief Opens the destination of a file record and prepares its decryptor.
+	 *
+	 * If the sender's symmetric key is unknown the content of the record is skipped.
+	 * @param sender_id The sender's client ID.
+	 * @param message_type FILE_SEND or FILE_SEND_GCM.
+	 * @param incoming_file The state to initialize.
+	 */
+	void begin_incoming_file(const ClientId& sender_id, uint8_t message_type, IncomingFile* incoming_file);
+
+	/**
+	 * @brief Decrypts the next piece of a file record and appends it to the file.
+	 */
+	void write_incoming_file(IncomingFile* incoming_file, const uint8_t* content, size_t length);
+
+	/**
+	 * @brief Starts a FILE_PART record once its part header is complete.
+	 *
+	 * Finds or creates the transfer, and prepares a decryptor bound to the part header.
+	 * @throws std::runtime_error if the header is invalid or does not match its transfer.
+	 */
+	void begin_file_part(IncomingFile* incoming_file);
+
+	/**
+	 * @brief Writes the decrypted plaintext of a file record to its file.
+	 * @throws std::runtime_error if a part holds more data than its header announced.
+	 */
+	void store_incoming_plain(IncomingFile* incoming_file);
+
+	/**
+	 * @brief Marks a decrypted part as received and closes the transfer once it is complete.
+	 * @throws std::runtime_error if the part is shorter than its header announced.
+	 */
+	void end_file_part(IncomingFile* incoming_file);
+
+	/**
+	 * @brief Finishes the decryption of a file record and closes the file.
+	 */
+	void end_incoming_file(IncomingFile* incoming_file);
+
+	/**
+	 * @brief Abandons a file record and removes the partial file.
+	 */
+	void discard_incoming_file(IncomingFile* incoming_file);
+
+	/**
+	 * @brief Returns a new path in the temporary directory for a received file.
+	 */
+	std::string make_received_file_path() const;
+
+	/**
+	 * @brief Result of decrypting a buffered pending message on the crypto thread pool.
+	 */
+	struct DecryptedMessage
+	{
+		ClientId sender_id;
+		uint8_t message_type;
+		std::string content;
+		std::string error;
+		std::shared_ptr<AESWrapper> symmetric_key;	// set for a valid SYMMETRIC_KEY_SEND
+		std::chrono::nanoseconds decrypt_time;
+	};
+
+	/**
+	 * @brief Buffered pending messages being decrypted in parallel, kept in message order.
+	 */
+	struct IncomingBacklog
+	{
+		std::deque<std::future<DecryptedMessage>> messages;
+
+		// Each sender's symmetric key as of the last queued message; it may still be decrypting.
+		std::unordered_map<ClientId, std::shared_future<std::shared_ptr<AESWrapper>>, ClientIdHash> symmetric_keys;
+
+		// Cleared once a missing sender has made the drain fetch the client list again.
+		bool may_refresh_directory = true;
+	};
+
+	/**
+	 * @brief Starts decrypting a buffered pending message on the crypto thread pool.
+	 *
+	 * A message that depends on a symmetric key sent earlier in the backlog waits for that key
+	 * only, so independent messages, including every RSA decryption, run concurrently.
+	 * @param backlog The messages queued so far.
+	 * @param sender_id The sender's client ID.
 	 * @param message_type The message type.
-	 * @param message_content The message content.
+	 * @param message_content The encrypted content.
+	 */
+	void queue_incoming_message(IncomingBacklog* backlog, const ClientId& sender_id, uint8_t message_type, std::vector<uint8_t> message_content);
+
+	/**
+	 * @brief Prints decrypted messages in message order and applies received symmetric keys.
+	 * @param backlog The queued messages.
+	 * @param max_queued Delivers (waiting if needed) until at most this many remain queued;
+	 *                   messages that are already decrypted are delivered in any case.
 	 */
-	void handle_incoming_message(const std::string& sender_id_hex, uint8_t message_type, const std::vector<uint8_t>& message_content);
+	void deliver_incoming_messages(IncomingBacklog* backlog, size_t max_queued);
+
+	/**
+	 * @brief Decrypts one buffered pending message; runs on a crypto pool thread.
+	 * @param rsa_private The private key context, or nullptr if it could not be loaded.
+	 * @param symmetric_key The sender's symmetric key as of this message (nullptr if unknown).
+	 * @param received_key For SYMMETRIC_KEY_SEND, receives the sender's key after this message.
+	 */
+	static DecryptedMessage decrypt_incoming_message(uint8_t message_type, const std::vector<uint8_t>& message_content, const RSAPrivateWrapper* rsa_private,
+		const std::shared_future<std::shared_ptr<AESWrapper>>& symmetric_key, std::promise<std::shared_ptr<AESWrapper>>* received_key);
 
 	/**
 	 * @brief Checks if the public key for a target client exists.
@@ -113,7 +375,31 @@ private:
 	 * @param target_username The target username.
 	 * @return true if public key is available, false otherwise.
 	 */
-	bool is_public_key(const std::vector<uint8_t>& target_id, const std::string& target_username);
+	bool is_public_key(const ClientId& target_id, const std::string& target_username);
+
+	/**
+	 * @brief Returns a peer's public key encryptor, loading it from the key store on first use.
+	 * @return nullptr if the peer's public key has not been fetched.
+	 */
+	RSAPublicWrapper* find_public_key(const ClientId& peer_id);
+
+	/**
+	 * @brief Returns a peer's symmetric key session, loading it from the key store on first use.
+	 * @return nullptr if no symmetric key has been exchanged with the peer.
+	 */
+	std::shared_ptr<AESWrapper> find_symmetric_key(const ClientId& peer_id);
+
+	/**
+	 * @brief Sets a peer's symmetric key session and saves the key in the key store.
+	 */
+	void set_symmetric_key(const ClientId& peer_id, std::shared_ptr<AESWrapper> symmetric_key);
+
+	/**
+	 * @brief Returns the private key decryption context, building it on first use.
+	 *
+	 * The Base64 key is decoded and parsed once per session; every decrypt reuses it.
+	 */
+	RSAPrivateWrapper& private_key_context();
 
 	/**
 	 * @brief Encrypts a message using the target client's public key.
@@ -121,7 +407,7 @@ private:
 	 * @param message The message to encrypt.
 	 * @return The encrypted message as a string.
 	 */
-	std::string encrypt_with_public_key(const std::vector<uint8_t>& target_id, const std::string& message);
+	std::string encrypt_with_public_key(const ClientId& target_id, const std::string& message);
 
 	/**
 	 * @brief Registers the client with the server.
@@ -160,22 +446,104 @@ private:
 
 	/**
 	 * @brief Encrypts a file with a symmetric key and sends it to a target client.
+	 *
+	 * Files are sent as FILE_SEND, which every client understands. With gcm_files_ set, files of
+	 * PARALLEL_FILE_THRESHOLD bytes or more are sent as FILE_SEND_GCM, with the chunks of each
+	 * window encrypted on the crypto thread pool, and files of MULTIPART_FILE_THRESHOLD bytes or
+	 * more as FILE_PART messages by send_file_parts.
 	 */
 	void request_send_file();
 
 	/**
-	 * @brief Retrieves a client ID by the given username from the client list.
+	 * @brief Sends a file as a multipart transfer, resuming an interrupted one.
+	 *
+	 * Every part the server acknowledges is checkpointed in the transfer journal. Sending the
+	 * same, unchanged file to the same peer again sends only the parts that are missing; if the
+	 * connection drops, the client reconnects and resumes, up to FilePart::MAX_SEND_ATTEMPTS connections.
+	 * @param target_username The recipient, for messages to the user.
+	 * @param target_id The recipient's client ID.
+	 * @param session The recipient's symmetric key session.
+	 * @param file_path The file to send, which identifies the transfer in the journal.
+	 * @param file The open file.
+	 */
+	void send_file_parts(const std::string& target_username, const ClientId& target_id, std::shared_ptr<AESWrapper> session, const std::string& file_path, FileSource& file);
+
+	/**
+	 * @brief Sends the parts of a transfer that the journal does not mark as acknowledged.
+	 *
+	 * Parts are read in order, encrypted concurrently on the crypto thread pool (one part per
+	 * thread) and pipelined to the server as they become ready. At most MAX_PARTS_IN_MEMORY
+	 * parts are held at once, so memory use does not depend on the file size. Sending stops at
+	 * the first failure; pipeline_.last_error() tells a lost connection from a rejected part.
+	 * @param record The transfer's journal record.
+	 * @param session The recipient's symmetric key session.
+	 * @param file The open file; a mapped file's parts are encrypted straight from the mapping.
+	 */
+	void send_missing_parts(TransferRecord* record, std::shared_ptr<AESWrapper> session, FileSource& file);
+
+	/**
+	 * @brief Closes the socket and connects to the server again.
+	 * @return false if the server could not be reached.
+	 */
+	bool reconnect_to_server();
+
+	/**
+	 * @brief Encrypts one text message for several target clients and pipelines the sends.
+	 */
+	void request_send_broadcast_message();
+
+	/**
+	 * @brief Retrieves a client ID by the given username from the client directory.
+	 *
+	 * The directory is refreshed if it is stale, or once if the name is not in it.
 	 * @param username The username to search for.
-	 * @return The client ID as a vector of bytes.
+	 * @return The client ID, or the null ID if not found.
 	 */
-	std::vector<uint8_t> get_client_id_by_username(const std::string& username);
+	ClientId get_client_id_by_username(const std::string& username);
 	
 	/**
-	 * @brief Retrieves a mapping of client usernames to their IDs.
-	 * @return An unordered_map where key is the username and value is the client ID in hex.
+	 * @brief Downloads the client list from the server into the client directory.
+	 * @return true if the directory was updated, false otherwise.
 	 */
-	std::unordered_map<std::string, std::string> get_client_mapping();
+	bool refresh_directory();
 	
+	/**
+	 * @brief Downloads the client list over a connection of its own, for use while a response
+	 *        is still being read from the client's socket.
+	 * @return true if the directory was updated, false otherwise.
+	 */
+	bool refresh_directory_on_new_connection();
+	
+	/**
+	 * @brief Returns a sender's username for display.
+	 *
+	 * A sender may have registered after the directory was loaded, so on a miss the directory
+	 * is refreshed once if *may_refresh is set, which it then clears.
+	 * @param socket_busy true while a response is being read, so the refresh needs its own connection.
+	 * @return The username, or the sender's hexadecimal ID if it is still unknown.
+	 */
+	std::string sender_name(const ClientId& sender_id, bool* may_refresh, bool socket_busy = false);
+	
+	/**
+	 * @brief Prints the latency histograms recorded so far.
+	 */
+	void print_statistics() const;
+
+	/**
+	 * @brief Writes the latency histograms to "latency_stats.json" if anything was recorded.
+	 */
+	void save_statistics() const;
+
+	/**
+	 * @brief Prints the newest stored messages, optionally of one sender and one kind.
+	 */
+	void request_message_history();
+
+	/**
+	 * @brief Prints the newest stored text messages that contain every word entered.
+	 */
+	void request_message_search();
+
 	/**
 	 * @brief Prints the client menu.
 	 */
@@ -0,0 +1,74 @@
+/**
+ * @file ClientDirectory.cpp
+ * @brief Implementation of the ClientDirectory class for the MessageU project.
+ *
+ * Parses client list responses into the name and ID indexes and tracks their age.
+ *
+ * @version 2.0
+ * @author Dmitriy Gorodov
+ * @id 342725405
+ * @date 16/10/2026
+ */
+
+#include "ClientDirectory.h"
+#include <algorithm>
+
+ClientDirectory::ClientDirectory(std::chrono::steady_clock::duration ttl)
+	: ttl_(ttl), loaded_(false)
+{
+}
+
+void ClientDirectory::update(const std::vector<uint8_t>& client_list_payload)
+{
+	const size_t record_size = MAX_CLIENT_ID_SIZE + MAX_CLIENT_NAME_SIZE;
+	size_t num_records = client_list_payload.size() / record_size;
+
+	ids_by_name_.clear();
+	names_by_id_.clear();
+	names_.clear();
+	ids_by_name_.reserve(num_records);
+	names_by_id_.reserve(num_records);
+	names_.reserve(num_records);
+
+	for (size_t i = 0; i < num_records; i++)
+	{
+		auto record = client_list_payload.begin() + i * record_size;
+		ClientId client_id(&*record);
+		std::string username(record + MAX_CLIENT_ID_SIZE, record + record_size);
+		username.erase(std::find(username.begin(), username.end(), '\0'), username.end());
+
+		names_by_id_[client_id] = username;
+		ids_by_name_[username] = client_id;
+		names_.push_back(std::move(username));
+	}
+
+	updated_at_ = std::chrono::steady_clock::now();
+	loaded_ = true;
+}
+
+bool ClientDirectory::is_stale() const
+{
+	return !loaded_ || std::chrono::steady_clock::now() - updated_at_ >= ttl_;
+}
+
+void ClientDirectory::invalidate()
+{
+	loaded_ = false;
+}
+
+ClientId ClientDirectory::find_id(const std::string& username) const
+{
+	auto found = ids_by_name_.find(username);
+	return found == ids_by_name_.end() ? ClientId() : found->second;
+}
+
+std::string ClientDirectory::find_name(const ClientId& client_id) const
+{
+	auto found = names_by_id_.find(client_id);
+	return found == names_by_id_.end() ? std::string() : found->second;
+}
+
+const std::vector<std::string>& ClientDirectory::names() const
+{
+	return names_;
+}
@@ -0,0 +1,77 @@
+/**
+ * @file ClientDirectory.h
+ * @brief Declaration of the ClientDirectory class for the MessageU project.
+ *
+ * This header defines a client-side cache of the server's client list, indexed both by
+ * username and by client ID.
+ *
+ * @version 2.0
+ * @author Dmitriy Gorodov
+ * @id 324725405
+ * @date 16/10/2026
+ */
+
+#pragma once
+
+#include "ClientId.h"
+#include "utils.h"
+#include <chrono>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief The ClientDirectory class caches the client list returned by LIST_ALL_CLIENTS.
+ *
+ * Lookups in both directions are hash lookups and need no round trip. The cache is refreshed
+ * by the owner, either explicitly or when it has become older than its time to live.
+ */
+class ClientDirectory
+{
+public:
+	static constexpr std::chrono::seconds DEFAULT_TTL = std::chrono::minutes(10);
+
+	explicit ClientDirectory(std::chrono::steady_clock::duration ttl = DEFAULT_TTL);
+
+	/**
+	 * @brief Replaces the cached directory with a client list response payload.
+	 * @param client_list_payload Records of client ID (16 bytes) and name (255 bytes).
+	 */
+	void update(const std::vector<uint8_t>& client_list_payload);
+
+	/**
+	 * @brief Returns true if the directory was never loaded or its time to live has passed.
+	 */
+	bool is_stale() const;
+
+	/**
+	 * @brief Marks the directory as stale so the next lookup refreshes it.
+	 */
+	void invalidate();
+
+	/**
+	 * @brief Looks up a client ID by username.
+	 * @return The client ID, or the null ID if the name is unknown.
+	 */
+	ClientId find_id(const std::string& username) const;
+
+	/**
+	 * @brief Looks up a username by client ID.
+	 * @return The username, or an empty string if the ID is unknown.
+	 */
+	std::string find_name(const ClientId& client_id) const;
+
+	/**
+	 * @brief Returns the usernames in the order the server listed them.
+	 */
+	const std::vector<std::string>& names() const;
+
+private:
+	std::chrono::steady_clock::duration ttl_;
+	std::chrono::steady_clock::time_point updated_at_;
+	bool loaded_;
+
+	std::unordered_map<std::string, ClientId> ids_by_name_;
+	std::unordered_map<ClientId, std::string, ClientIdHash> names_by_id_;
+	std::vector<std::string> names_;
+};
@@ -0,0 +1,31 @@
+/**
+ * @file ClientId.cpp
+ * @brief Implementation of the ClientId value type for the MessageU project.
+ *
+ * Converts client IDs to and from their hexadecimal form, as stored in my.info.
+ *
+ * @version 2.0
+ * @author Dmitriy Gorodov
+ * @id 342725405
+ * @date 16/10/2026
+ */
+
+#include "ClientId.h"
+#include "HexCodec.h"
+
+bool ClientId::from_hex(const std::string& hex, ClientId* client_id)
+{
+	ClientId parsed;
+	if (hex.size() != 2 * SIZE || !HexCodec::decode(hex.data(), hex.size(), parsed.bytes_.data()))
+		return false;
+
+	*client_id = parsed;
+	return true;
+}
+
+std::string ClientId::to_hex() const
+{
+	std::string hex(2 * SIZE, '\0');
+	HexCodec::encode(bytes_.data(), SIZE, &hex[0]);
+	return hex;
+}
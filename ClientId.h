@@ -0,0 +1,80 @@
+/**
+ * @file ClientId.h
+ * @brief Declaration of the ClientId value type for the MessageU project.
+ *
+ * This header defines the 16-byte client identifier assigned by the server at registration,
+ * and the hash used to key the client's per-peer maps with it.
+ *
+ * @version 2.0
+ * @author Dmitriy Gorodov
+ * @id 324725405
+ * @date 16/10/2026
+ */
+
+#pragma once
+
+#include "utils.h"
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+/**
+ * @brief A client ID held by value as its 16 raw bytes.
+ *
+ * The all-zero ID is the null ID. It stands for "no client", e.g. an unregistered client or
+ * a name that is not in the directory.
+ */
+class ClientId
+{
+public:
+	static const size_t SIZE = MAX_CLIENT_ID_SIZE;
+
+	/**
+	 * @brief Constructs the null ID.
+	 */
+	ClientId() : bytes_() {}
+
+	/**
+	 * @brief Constructs an ID from SIZE bytes.
+	 */
+	explicit ClientId(const uint8_t* bytes) { memcpy(bytes_.data(), bytes, SIZE); }
+
+	/**
+	 * @brief Parses an ID from 32 hexadecimal digits.
+	 * @return false if the string is not a hexadecimal ID; the ID is left unchanged.
+	 */
+	static bool from_hex(const std::string& hex, ClientId* client_id);
+
+	/**
+	 * @brief Returns the ID as 32 lowercase hexadecimal digits.
+	 */
+	std::string to_hex() const;
+
+	const uint8_t* data() const { return bytes_.data(); }
+
+	bool is_null() const { return *this == ClientId(); }
+
+	bool operator==(const ClientId& other) const { return memcmp(bytes_.data(), other.bytes_.data(), SIZE) == 0; }
+	bool operator!=(const ClientId& other) const { return !(*this == other); }
+
+private:
+	std::array<uint8_t, SIZE> bytes_;
+};
+
+/**
+ * @brief Hash of a ClientId for unordered containers.
+ *
+ * Server IDs are UUIDs, so their bytes are already well mixed; the hash folds the two 64-bit
+ * halves together instead of hashing every byte.
+ */
+struct ClientIdHash
+{
+	size_t operator()(const ClientId& client_id) const
+	{
+		uint64_t low, high;
+		memcpy(&low, client_id.data(), sizeof(low));
+		memcpy(&high, client_id.data() + sizeof(low), sizeof(high));
+		return static_cast<size_t>(low ^ (high * 0x9e3779b97f4a7c15ULL));
+	}
+};
@@ -0,0 +1,61 @@
+/**
+ * @file CryptoProvider.cpp
+ * @brief Implementation of the CryptoProvider registry for the MessageU project.
+ *
+ * @version 2.0
+ * @author Dmitriy Gorodov
+ * @id 342725405
+ * @date 16/10/2026
+ */
+
+#include "CryptoProvider.h"
+#include "CryptoppProvider.h"
+#ifdef MESSAGEU_WITH_OPENSSL
+#include "OpenSSLProvider.h"
+#endif
+
+/**
+ * @brief The providers, built on first use so that no other static object depends on their order.
+ */
+static const std::vector<const CryptoProvider*>& providers()
+{
+	static const CryptoppProvider cryptopp;
+#ifdef MESSAGEU_WITH_OPENSSL
+	static const OpenSSLProvider openssl;
+	static const std::vector<const CryptoProvider*> built = { &cryptopp, &openssl };
+#else
+	static const std::vector<const CryptoProvider*> built = { &cryptopp };
+#endif
+	return built;
+}
+
+static const CryptoProvider* current_provider = nullptr;
+
+const CryptoProvider& CryptoProvider::current()
+{
+	return current_provider ? *current_provider : *providers().front();
+}
+
+bool CryptoProvider::select(const std::string& name)
+{
+	const CryptoProvider* provider = find(name);
+	if (!provider)
+		return false;
+	current_provider = provider;
+	return true;
+}
+
+const CryptoProvider* CryptoProvider::find(const std::string& name)
+{
+	for (const CryptoProvider* provider : providers())
+	{
+		if (name == provider->name())
+			return provider;
+	}
+	return nullptr;
+}
+
+std::vector<const CryptoProvider*> CryptoProvider::all()
+{
+	return providers();
+}
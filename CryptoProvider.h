@@ -0,0 +1,172 @@
+/**
+ * @file CryptoProvider.h
+ * @brief Declaration of the CryptoProvider interface for the MessageU project.
+ *
+ * A crypto provider implements the primitives behind AESWrapper, RSAPublicWrapper,
+ * RSAPrivateWrapper and the chunked GCM format: random bytes, AES-128 in CBC mode (zero IV,
+ * PKCS#7 padding) and GCM, and RSA with OAEP-SHA1 on keys in the DER formats of the protocol
+ * (X.509 public keys, PKCS#8 private keys). Every provider produces the same bytes, so clients
+ * on different providers interoperate.
+ *
+ * The Crypto++ provider is always built. The OpenSSL EVP provider is built when
+ * MESSAGEU_WITH_OPENSSL is defined (and libcrypto is linked). The provider is chosen once,
+ * at startup, before any key object is created ("--crypto name").
+ *
+ * @version 2.0
+ * @author Dmitriy Gorodov
+ * @id 324725405
+ * @date 16/10/2026
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @brief An AES-CBC stream in one direction, over the key of an AESCipher.
+ */
+class CBCStream
+{
+public:
+	virtual ~CBCStream() {}
+
+	/**
+	 * @brief Processes the next chunk.
+	 * @param out Replaced with the output that became available (whole blocks only). A
+	 *            decryptor holds the last block back until finish(), as it carries the padding.
+	 */
+	virtual void update(const char* in, size_t length, std::string& out) = 0;
+
+	/**
+	 * @brief Pads and encrypts, or removes the padding of, the remaining input.
+	 * @throws std::exception if a decrypted input is truncated or its padding is invalid.
+	 */
+	virtual void finish(std::string& out) = 0;
+};
+
+/**
+ * @brief An AES-128 key with its expanded schedules. The const members may be called from
+ *        several threads at once.
+ */
+class AESCipher
+{
+public:
+	virtual ~AESCipher() {}
+
+	virtual std::unique_ptr<CBCStream> cbc_encryptor() const = 0;
+	virtual std::unique_ptr<CBCStream> cbc_decryptor() const = 0;
+
+	/**
+	 * @brief Encrypts and authenticates one GCM message.
+	 * @param cipher Output of length bytes.
+	 * @param tag Output of tag_length bytes.
+	 */
+	virtual void gcm_seal(const unsigned char* nonce, size_t nonce_length, const unsigned char* aad, size_t aad_length,
+		const unsigned char* plain, size_t length, unsigned char* cipher, unsigned char* tag, size_t tag_length) const = 0;
+
+	/**
+	 * @brief Decrypts and verifies one GCM message.
+	 * @param plain Output of length bytes.
+	 * @return false if the message fails authentication.
+	 */
+	virtual bool gcm_open(const unsigned char* nonce, size_t nonce_length, const unsigned char* aad, size_t aad_length,
+		const unsigned char* cipher, size_t length, const unsigned char* tag, size_t tag_length, unsigned char* plain) const = 0;
+};
+
+/**
+ * @brief An RSA public key.
+ */
+class RSAPublicKey
+{
+public:
+	virtual ~RSAPublicKey() {}
+
+	/**
+	 * @brief Returns the key in X.509 SubjectPublicKeyInfo DER.
+	 */
+	virtual std::string der() const = 0;
+
+	/**
+	 * @brief Encrypts with OAEP-SHA1.
+	 * @throws std::exception if the plaintext is too long for the key.
+	 */
+	virtual std::string encrypt(const char* plain, size_t length) = 0;
+};
+
+/**
+ * @brief An RSA private key. decrypt() may be called from several threads at once.
+ */
+class RSAPrivateKey
+{
+public:
+	virtual ~RSAPrivateKey() {}
+
+	/**
+	 * @brief Returns the key in PKCS#8 PrivateKeyInfo DER.
+	 */
+	virtual std::string der() const = 0;
+
+	/**
+	 * @brief Returns the public half in X.509 SubjectPublicKeyInfo DER.
+	 */
+	virtual std::string public_der() const = 0;
+
+	/**
+	 * @brief Decrypts with OAEP-SHA1.
+	 * @throws std::exception if the ciphertext is not valid for the key.
+	 */
+	virtual std::string decrypt(const char* cipher, size_t length) const = 0;
+};
+
+/**
+ * @brief The CryptoProvider interface creates the key objects of one crypto library.
+ */
+class CryptoProvider
+{
+public:
+	virtual ~CryptoProvider() {}
+
+	/**
+	 * @brief Returns the provider's name, as given to "--crypto", e.g. "openssl".
+	 */
+	virtual const char* name() const = 0;
+
+	/**
+	 * @brief Fills a buffer from the library's cryptographically secure generator. Thread-safe.
+	 */
+	virtual void random_bytes(unsigned char* buffer, size_t length) const = 0;
+
+	virtual std::unique_ptr<AESCipher> aes(const unsigned char* key, size_t length) const = 0;
+	virtual std::unique_ptr<RSAPublicKey> rsa_public_key(const char* der, size_t length) const = 0;
+	virtual std::unique_ptr<RSAPrivateKey> rsa_private_key(const char* der, size_t length) const = 0;
+
+	/**
+	 * @brief Generates an RSA key with the public exponent 17, whose public key in DER is the
+	 *        protocol's 160 bytes at 1024 bits.
+	 */
+	virtual std::unique_ptr<RSAPrivateKey> generate_rsa_private_key(unsigned int bits) const = 0;
+
+	/**
+	 * @brief Returns the provider in use; Crypto++ unless another one was selected.
+	 */
+	static const CryptoProvider& current();
+
+	/**
+	 * @brief Makes a built provider the current one.
+	 * @return false if no provider of that name was built.
+	 */
+	static bool select(const std::string& name);
+
+	/**
+	 * @brief Returns a built provider by name, or nullptr.
+	 */
+	static const CryptoProvider* find(const std::string& name);
+
+	/**
+	 * @brief Returns every built provider, Crypto++ first.
+	 */
+	static std::vector<const CryptoProvider*> all();
+};
@@ -0,0 +1,227 @@
+/**
+ * @file CryptoppProvider.cpp
+ * @brief Implementation of the Crypto++ crypto provider for the MessageU project.
+ *
+ * @version 2.0
+ * @author Dmitriy Gorodov
+ * @id 342725405
+ * @date 16/10/2026
+ */
+
+#include "CryptoppProvider.h"
+
+#include <aes.h>
+#include <filters.h>
+#include <gcm.h>
+#include <modes.h>
+#include <osrng.h>
+#include <rsa.h>
+
+#include <stdexcept>
+#include <vector>
+
+/**
+ * @brief Returns the calling thread's generator; AutoSeededRandomPool is not thread-safe.
+ */
+static CryptoPP::AutoSeededRandomPool& thread_rng()
+{
+	static thread_local CryptoPP::AutoSeededRandomPool rng;
+	return rng;
+}
+
+static const CryptoPP::byte ZERO_IV[CryptoPP::AES::BLOCKSIZE] = { 0 };	// for practical use iv should never be a fixed value!
+
+/**
+ * @brief A CBC stream through a StreamTransformationFilter over its own copy of a cipher's schedule.
+ *
+ * Crypto++ block ciphers keep scratch state, so streams that may run on different threads do not
+ * share one. Copying the schedule copies the expanded key; the key is not expanded again.
+ */
+template <typename Mode, typename Schedule>
+class CryptoppCBCStream : public CBCStream
+{
+public:
+	explicit CryptoppCBCStream(const Schedule& schedule)
+		: _schedule(schedule), _mode(_schedule, ZERO_IV), _filter(_mode, new CryptoPP::StringSink(_output))
+	{
+	}
+
+	void update(const char* in, size_t length, std::string& out) override
+	{
+		_filter.Put(reinterpret_cast<const CryptoPP::byte*>(in), length);
+		out.clear();
+		out.swap(_output);
+	}
+
+	void finish(std::string& out) override
+	{
+		_filter.MessageEnd();
+		out.clear();
+		out.swap(_output);
+	}
+
+private:
+	Schedule _schedule;
+	Mode _mode;
+	std::string _output;
+	CryptoPP::StreamTransformationFilter _filter;
+};
+
+typedef CryptoppCBCStream<CryptoPP::CBC_Mode_ExternalCipher::Encryption, CryptoPP::AES::Encryption> CryptoppCBCEncryptor;
+typedef CryptoppCBCStream<CryptoPP::CBC_Mode_ExternalCipher::Decryption, CryptoPP::AES::Decryption> CryptoppCBCDecryptor;
+
+class CryptoppAESCipher : public AESCipher
+{
+public:
+	CryptoppAESCipher(const unsigned char* key, size_t length)
+		: _key(key, key + length)
+	{
+		_encryption.SetKey(key, length);
+		_decryption.SetKey(key, length);
+	}
+
+	std::unique_ptr<CBCStream> cbc_encryptor() const override
+	{
+		return std::unique_ptr<CBCStream>(new CryptoppCBCEncryptor(_encryption));
+	}
+
+	std::unique_ptr<CBCStream> cbc_decryptor() const override
+	{
+		return std::unique_ptr<CBCStream>(new CryptoppCBCDecryptor(_decryption));
+	}
+
+	void gcm_seal(const unsigned char* nonce, size_t nonce_length, const unsigned char* aad, size_t aad_length,
+		const unsigned char* plain, size_t length, unsigned char* cipher, unsigned char* tag, size_t tag_length) const override
+	{
+		CryptoPP::GCM<CryptoPP::AES>::Encryption gcm;
+		gcm.SetKeyWithIV(_key.data(), _key.size(), nonce, nonce_length);
+		gcm.EncryptAndAuthenticate(cipher, tag, tag_length, nonce, nonce_length, aad, aad_length, plain, length);
+	}
+
+	bool gcm_open(const unsigned char* nonce, size_t nonce_length, const unsigned char* aad, size_t aad_length,
+		const unsigned char* cipher, size_t length, const unsigned char* tag, size_t tag_length, unsigned char* plain) const override
+	{
+		CryptoPP::GCM<CryptoPP::AES>::Decryption gcm;
+		gcm.SetKeyWithIV(_key.data(), _key.size(), nonce, nonce_length);
+		return gcm.DecryptAndVerify(plain, tag, tag_length, nonce, nonce_length, aad, aad_length, cipher, length);
+	}
+
+private:
+	std::vector<unsigned char> _key;
+	// Keyed once, then copied into every stream.
+	CryptoPP::AES::Encryption _encryption;
+	CryptoPP::AES::Decryption _decryption;
+};
+
+class CryptoppRSAPublicKey : public RSAPublicKey
+{
+public:
+	CryptoppRSAPublicKey(const char* der, size_t length)
+	{
+		CryptoPP::StringSource ss(reinterpret_cast<const CryptoPP::byte*>(der), length, true);
+		_publicKey.Load(ss);
+	}
+
+	std::string der() const override
+	{
+		std::string key;
+		CryptoPP::StringSink ss(key);
+		_publicKey.Save(ss);
+		return key;
+	}
+
+	std::string encrypt(const char* plain, size_t length) override
+	{
+		if (!_encryptor)
+			_encryptor.reset(new CryptoPP::RSAES_OAEP_SHA_Encryptor(_publicKey));
+
+		std::string cipher(_encryptor->CiphertextLength(length), '\0');
+		if (cipher.empty())
+			throw std::length_error("plaintext is too long for the RSA key");
+
+		_encryptor->Encrypt(_rng, reinterpret_cast<const CryptoPP::byte*>(plain), length, reinterpret_cast<CryptoPP::byte*>(&cipher[0]));
+		return cipher;
+	}
+
+private:
+	CryptoPP::AutoSeededRandomPool _rng;
+	CryptoPP::RSA::PublicKey _publicKey;
+	std::unique_ptr<CryptoPP::RSAES_OAEP_SHA_Encryptor> _encryptor;	// built on first encrypt, then reused
+};
+
+class CryptoppRSAPrivateKey : public RSAPrivateKey
+{
+public:
+	explicit CryptoppRSAPrivateKey(unsigned int bits)
+	{
+		_privateKey.Initialize(thread_rng(), bits);
+		_decryptor.reset(new CryptoPP::RSAES_OAEP_SHA_Decryptor(_privateKey));
+	}
+
+	CryptoppRSAPrivateKey(const char* der, size_t length)
+	{
+		CryptoPP::StringSource ss(reinterpret_cast<const CryptoPP::byte*>(der), length, true);
+		_privateKey.Load(ss);
+		_decryptor.reset(new CryptoPP::RSAES_OAEP_SHA_Decryptor(_privateKey));
+	}
+
+	std::string der() const override
+	{
+		std::string key;
+		CryptoPP::StringSink ss(key);
+		_privateKey.Save(ss);
+		return key;
+	}
+
+	std::string public_der() const override
+	{
+		CryptoPP::RSAFunction publicKey(_privateKey);
+		std::string key;
+		CryptoPP::StringSink ss(key);
+		publicKey.Save(ss);
+		return key;
+	}
+
+	std::string decrypt(const char* cipher, size_t length) const override
+	{
+		std::string decrypted(_decryptor->MaxPlaintextLength(length), '\0');
+		if (decrypted.empty())
+			throw std::runtime_error("RSA ciphertext has an invalid length");
+
+		CryptoPP::DecodingResult result = _decryptor->Decrypt(thread_rng(), reinterpret_cast<const CryptoPP::byte*>(cipher), length, reinterpret_cast<CryptoPP::byte*>(&decrypted[0]));
+		if (!result.isValidCoding)
+			throw std::runtime_error("RSA decryption failed");
+
+		decrypted.resize(result.messageLength);
+		return decrypted;
+	}
+
+private:
+	CryptoPP::RSA::PrivateKey _privateKey;
+	std::unique_ptr<CryptoPP::RSAES_OAEP_SHA_Decryptor> _decryptor;	// built with the key, then reused
+};
+
+void CryptoppProvider::random_bytes(unsigned char* buffer, size_t length) const
+{
+	thread_rng().GenerateBlock(buffer, length);
+}
+
+std::unique_ptr<AESCipher> CryptoppProvider::aes(const unsigned char* key, size_t length) const
+{
+	return std::unique_ptr<AESCipher>(new CryptoppAESCipher(key, length));
+}
+
+std::unique_ptr<RSAPublicKey> CryptoppProvider::rsa_public_key(const char* der, size_t length) const
+{
+	return std::unique_ptr<RSAPublicKey>(new CryptoppRSAPublicKey(der, length));
+}
+
+std::unique_ptr<RSAPrivateKey> CryptoppProvider::rsa_private_key(const char* der, size_t length) const
+{
+	return std::unique_ptr<RSAPrivateKey>(new CryptoppRSAPrivateKey(der, length));
+}
+
+std::unique_ptr<RSAPrivateKey> CryptoppProvider::generate_rsa_private_key(unsigned int bits) const
+{
+	return std::unique_ptr<RSAPrivateKey>(new CryptoppRSAPrivateKey(bits));
+}
@@ -0,0 +1,33 @@
+/**
+ * @file CryptoppProvider.h
+ * @brief Declaration of the Crypto++ crypto provider for the MessageU project.
+ *
+ * @version 2.0
+ * @author Dmitriy Gorodov
+ * @id 324725405
+ * @date 16/10/2026
+ */
+
+#pragma once
+
+#include "CryptoProvider.h"
+
+/**
+ * @brief The CryptoppProvider class implements the crypto primitives with Crypto++ ("cryptopp").
+ *
+ * An AES cipher keeps its encryption and decryption schedules, which the CBC streams share. The
+ * RSA keys keep their OAEP encryptor or decryptor; private key operations draw blinding values
+ * from a generator per thread.
+ */
+class CryptoppProvider : public CryptoProvider
+{
+public:
+	const char* name() const override { return "cryptopp"; }
+
+	void random_bytes(unsigned char* buffer, size_t length) const override;
+
+	std::unique_ptr<AESCipher> aes(const unsigned char* key, size_t length) const override;
+	std::unique_ptr<RSAPublicKey> rsa_public_key(const char* der, size_t length) const override;
+	std::unique_ptr<RSAPrivateKey> rsa_private_key(const char* der, size_t length) const override;
+	std::unique_ptr<RSAPrivateKey> generate_rsa_private_key(unsigned int bits) const override;
+};
@@ -0,0 +1,73 @@
+/**
+ * @file FilePart.cpp
+ * @brief Implementation of the multipart file transfer format for the MessageU project.
+ *
+ * Serializes and validates part headers.
+ *
+ * @version 2.0
+ * @author Dmitriy Gorodov
+ * @id 342725405
+ * @date 16/10/2026
+ */
+
+#include "FilePart.h"
+#include "AESWrapper.h"
+#include <cstring>
+
+FilePartHeader FilePartHeader::for_file(uint64_t total_size, uint32_t part_size)
+{
+	FilePartHeader header;
+	AESWrapper::GenerateKey(header.transfer_id.data(), static_cast<unsigned int>(header.transfer_id.size()));
+	header.index = 0;
+	header.count = static_cast<uint32_t>((total_size + part_size - 1) / part_size);
+	header.part_size = part_size;
+	header.total_size = total_size;
+	return header;
+}
+
+bool FilePartHeader::parse(const uint8_t* bytes, FilePartHeader* header)
+{
+	FilePartHeader parsed;
+	memcpy(parsed.transfer_id.data(), bytes, FilePart::TRANSFER_ID_SIZE);
+	bytes += FilePart::TRANSFER_ID_SIZE;
+	memcpy(&parsed.index, bytes, 4);
+	memcpy(&parsed.count, bytes + 4, 4);
+	memcpy(&parsed.part_size, bytes + 8, 4);
+	memcpy(&parsed.total_size, bytes + 12, 8);
+
+	if (parsed.part_size == 0 || parsed.part_size > FilePart::MAX_PART_SIZE || parsed.total_size == 0)
+		return false;
+	if ((parsed.total_size + parsed.part_size - 1) / parsed.part_size != parsed.count || parsed.index >= parsed.count)
+		return false;
+
+	*header = parsed;
+	return true;
+}
+
+std::string FilePartHeader::pack() const
+{
+	std::string bytes(FilePart::HEADER_SIZE, '\0');
+	char* out = &bytes[0];
+	memcpy(out, transfer_id.data(), FilePart::TRANSFER_ID_SIZE);
+	out += FilePart::TRANSFER_ID_SIZE;
+	memcpy(out, &index, 4);
+	memcpy(out + 4, &count, 4);
+	memcpy(out + 8, &part_size, 4);
+	memcpy(out + 12, &total_size, 8);
+	return bytes;
+}
+
+uint64_t FilePartHeader::offset() const
+{
+	return static_cast<uint64_t>(index) * part_size;
+}
+
+uint32_t FilePartHeader::length() const
+{
+	return static_cast<uint32_t>(index + 1 < count ? part_size : total_size - offset());
+}
+
+bool FilePartHeader::same_transfer(const FilePartHeader& other) const
+{
+	return transfer_id == other.transfer_id && count == other.count && part_size == other.part_size && total_size == other.total_size;
+}
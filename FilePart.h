@@ -0,0 +1,88 @@
+/**
+ * @file FilePart.h
+ * @brief Declaration of the multipart file transfer format for the MessageU project.
+ *
+ * A file too large for one message is sent as a sequence of FILE_PART messages. Each one
+ * carries a part header followed by that part of the file in the chunked AES-GCM format.
+ *
+ * Content layout (FILE_PART messages):
+ *   transfer ID (16 bytes) | part index (4) | part count (4) | part size (4) | total size (8) | GCM content
+ * Integers are little endian. Every part but the last holds exactly "part size" bytes of the
+ * file; part i starts at offset i * part size. The part header is the associated data of every
+ * GCM chunk of the part, so a part cannot be moved to another position or transfer.
+ *
+ * @version 2.0
+ * @author Dmitriy Gorodov
+ * @id 324725405
+ * @date 16/10/2026
+ */
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief Parameters of the multipart file transfer format.
+ */
+namespace FilePart
+{
+	const size_t TRANSFER_ID_SIZE = 16;
+	const size_t HEADER_SIZE = TRANSFER_ID_SIZE + 4 + 4 + 4 + 8;
+	const uint32_t DEFAULT_PART_SIZE = 16 * 1024 * 1024;
+	const uint32_t MAX_PART_SIZE = 1024 * 1024 * 1024;
+
+	/**
+	 * @brief Upper bound on the parts a sender holds in memory (being encrypted or sent) at once.
+	 */
+	const size_t MAX_PARTS_IN_MEMORY = 16;
+
+	/**
+	 * @brief Connections a sender uses for one transfer before leaving the rest for a later retry.
+	 */
+	const unsigned int MAX_SEND_ATTEMPTS = 3;
+}
+
+/**
+ * @brief The header of one part of a multipart file transfer.
+ */
+struct FilePartHeader
+{
+	std::array<uint8_t, FilePart::TRANSFER_ID_SIZE> transfer_id;
+	uint32_t index;
+	uint32_t count;
+	uint32_t part_size;
+	uint64_t total_size;
+
+	/**
+	 * @brief Returns the header of the first part of a new transfer with a random transfer ID.
+	 */
+	static FilePartHeader for_file(uint64_t total_size, uint32_t part_size = FilePart::DEFAULT_PART_SIZE);
+
+	/**
+	 * @brief Parses a header from HEADER_SIZE bytes.
+	 * @return false if the fields are inconsistent (e.g. the index is not below the count).
+	 */
+	static bool parse(const uint8_t* bytes, FilePartHeader* header);
+
+	/**
+	 * @brief Serializes the header into HEADER_SIZE bytes.
+	 */
+	std::string pack() const;
+
+	/**
+	 * @brief Returns the offset of this part in the file.
+	 */
+	uint64_t offset() const;
+
+	/**
+	 * @brief Returns the number of file bytes in this part.
+	 */
+	uint32_t length() const;
+
+	/**
+	 * @brief Returns true if the other header describes the same transfer (any part of it).
+	 */
+	bool same_transfer(const FilePartHeader& other) const;
+};
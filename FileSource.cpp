@@ -0,0 +1,111 @@
+/**
+ * @file FileSource.cpp
+ * @brief Implementation of the read-only file sources for the MessageU project.
+ *
+ * @version 2.0
+ * @author Dmitriy Gorodov
+ * @id 342725405
+ * @date 16/10/2026
+ */
+
+#include "FileSource.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+
+std::unique_ptr<FileSource> FileSource::open(const std::string& path)
+{
+#ifdef _WIN32
+	try
+	{
+		return std::unique_ptr<FileSource>(new MappedFileSource(path));
+	}
+	catch (const std::exception&)
+	{
+	}
+#endif
+
+	try
+	{
+		return std::unique_ptr<FileSource>(new BufferedFileSource(path));
+	}
+	catch (const std::exception&)
+	{
+		return nullptr;
+	}
+}
+
+MappedFileSource::MappedFileSource(const std::string& path)
+	: path_(path)
+{
+	try
+	{
+		mapping_ = boost::interprocess::file_mapping(path.c_str(), boost::interprocess::read_only);
+		region_ = boost::interprocess::mapped_region(mapping_, boost::interprocess::read_only);
+	}
+	catch (const boost::interprocess::interprocess_exception& e)
+	{
+		throw std::runtime_error("Unable to map " + path + ": " + e.what());
+	}
+	size_ = region_.get_size();
+
+	// Only a hint; systems without it simply read ahead less.
+	region_.advise(boost::interprocess::mapped_region::advice_sequential);
+}
+
+const char* MappedFileSource::read(uint64_t offset, size_t length, std::string& buffer)
+{
+	// Pages past the current end of the file fault on access, so never hand out more of the
+	// mapping than the file still holds. If the size cannot be read the file was removed or
+	// renamed, which leaves the mapped pages intact.
+	uint64_t end = size_;
+	std::error_code error;
+	uint64_t on_disk = std::filesystem::file_size(path_, error);
+	if (!error && on_disk < end)
+		end = on_disk;
+
+	const char* data = static_cast<const char*>(region_.get_address());
+	if (offset + length <= end)
+		return data + offset;
+
+	size_t available = offset < end ? static_cast<size_t>(end - offset) : 0;
+	buffer.assign(length, '\0');
+	if (available)
+		std::memcpy(&buffer[0], data + offset, available);
+	truncated_ = true;
+	return buffer.data();
+}
+
+BufferedFileSource::BufferedFileSource(const std::string& path)
+	: file_(path, std::ios::binary | std::ios::ate), position_(0)
+{
+	if (!file_)
+		throw std::runtime_error("Unable to open " + path + " for reading.");
+	size_ = static_cast<uint64_t>(file_.tellg());
+	file_.seekg(0);
+}
+
+const char* BufferedFileSource::read(uint64_t offset, size_t length, std::string& buffer)
+{
+	buffer.resize(length);
+	if (length == 0)
+		return buffer.data();
+
+	// Sequential reads, the common case, need no seek.
+	if (position_ != offset)
+	{
+		file_.clear();
+		file_.seekg(static_cast<std::streamoff>(offset));
+	}
+	file_.read(&buffer[0], length);
+	size_t got = static_cast<size_t>(file_.gcount());
+	position_ = offset + got;
+	if (got != length)
+	{
+		std::fill(buffer.begin() + got, buffer.end(), '\0');
+		truncated_ = true;
+		file_.clear();
+	}
+	return buffer.data();
+}
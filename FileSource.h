@@ -0,0 +1,123 @@
+/**
+ * @file FileSource.h
+ * @brief Declaration of the read-only file sources used to send files in the MessageU project.
+ *
+ * A FileSource hands out ranges of a file that is about to be encrypted. The mapped source
+ * maps the whole file read-only and returns pointers into the mapping, so the encryptor reads
+ * the page cache directly and no copy of the file is made. The buffered source reads each range
+ * with one large read. It is used for files that cannot be mapped (e.g. empty files), and on
+ * systems that let a mapped file be truncated.
+ *
+ * @version 2.0
+ * @author Dmitriy Gorodov
+ * @id 324725405
+ * @date 16/10/2026
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+/**
+ * @brief A read-only view of a file, read in ranges.
+ *
+ * The size is taken when the source is opened. A range that reaches past the end of the file,
+ * because the file shrank after it was opened, is padded with zeros and marks the source as
+ * truncated, so a request that already announced the size stays well-formed.
+ */
+class FileSource
+{
+public:
+	/**
+	 * @brief Opens a file, mapped on Windows if possible and buffered otherwise.
+	 *
+	 * Windows refuses to truncate a file while a view of it is mapped. Elsewhere a file that
+	 * shrinks under a mapping faults whoever reads the lost pages, so files are read buffered.
+	 * @return The source, or nullptr if the file cannot be opened.
+	 */
+	static std::unique_ptr<FileSource> open(const std::string& path);
+
+	virtual ~FileSource() {}
+
+	/**
+	 * @brief Returns the size of the file when it was opened.
+	 */
+	uint64_t size() const { return size_; }
+
+	/**
+	 * @brief Returns true if a range could not be read in full and was padded with zeros.
+	 */
+	bool truncated() const { return truncated_; }
+
+	/**
+	 * @brief Returns true if ranges are handed out from a memory mapping.
+	 */
+	virtual bool mapped() const = 0;
+
+	/**
+	 * @brief Returns length bytes of the file starting at offset.
+	 *
+	 * The returned pointer is either into the mapping, valid while the source lives, or into
+	 * buffer, valid until the caller changes it. Callers that read from several threads give
+	 * each range its own buffer.
+	 * @param offset The offset of the range.
+	 * @param length The length of the range.
+	 * @param buffer Storage for the range if it is not mapped.
+	 */
+	virtual const char* read(uint64_t offset, size_t length, std::string& buffer) = 0;
+
+protected:
+	uint64_t size_ = 0;
+	bool truncated_ = false;
+};
+
+/**
+ * @brief A FileSource over a read-only mapping of the whole file.
+ *
+ * The mapping is advised for sequential access, so the system reads ahead and drops pages
+ * behind the reader early. Every read checks the size on disk first and reports the part a
+ * shrunken file no longer holds as truncated. The pages are read after the check, so where the
+ * system lets a mapped file be truncated this only narrows the window in which a read faults.
+ */
+class MappedFileSource : public FileSource
+{
+public:
+	/**
+	 * @brief Maps a file.
+	 * @throws std::runtime_error if the file cannot be mapped.
+	 */
+	explicit MappedFileSource(const std::string& path);
+
+	bool mapped() const override { return true; }
+	const char* read(uint64_t offset, size_t length, std::string& buffer) override;
+
+private:
+	std::string path_;
+	boost::interprocess::file_mapping mapping_;
+	boost::interprocess::mapped_region region_;
+};
+
+/**
+ * @brief A FileSource that reads every range from an ifstream into the caller's buffer.
+ */
+class BufferedFileSource : public FileSource
+{
+public:
+	/**
+	 * @brief Opens a file.
+	 * @throws std::runtime_error if the file cannot be opened.
+	 */
+	explicit BufferedFileSource(const std::string& path);
+
+	bool mapped() const override { return false; }
+	const char* read(uint64_t offset, size_t length, std::string& buffer) override;
+
+private:
+	std::ifstream file_;
+	uint64_t position_;	// where the next read starts without a seek
+};
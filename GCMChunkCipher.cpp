@@ -0,0 +1,240 @@
+/**
+ * @file GCMChunkCipher.cpp
+ * @brief Implementation of the chunked AES-GCM encryptor and decryptor for the MessageU project.
+ *
+ * Each chunk is sealed by its own GCM object, so the chunks of a window are independent tasks
+ * on the thread pool. The caller waits for the whole window before the records are used.
+ *
+ * @version 2.0
+ * @author Dmitriy Gorodov
+ * @id 342725405
+ * @date 16/10/2026
+ */
+
+#include "GCMChunkCipher.h"
+#include "CryptoProvider.h"
+#include "Tracer.h"
+
+#include <algorithm>
+#include <cstring>
+#include <future>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include <boost/asio/post.hpp>
+
+static const size_t CHUNK_AAD_SIZE = 5;
+
+/**
+ * @brief Runs function(0) .. function(count - 1) on the pool and waits for all of them.
+ *
+ * Every task is waited for before the first failure is rethrown, since they all refer to
+ * the caller's buffers. Without a pool the calls are made in order on the calling thread.
+ */
+template <typename Function>
+static void run_parallel(boost::asio::thread_pool* pool, size_t count, const Function& function)
+{
+	if (!pool || count == 1)
+	{
+		for (size_t i = 0; i < count; i++)
+			function(i);
+		return;
+	}
+
+	std::vector<std::future<void>> done;
+	done.reserve(count);
+	for (size_t i = 0; i < count; i++)
+	{
+		auto task = std::make_shared<std::packaged_task<void()>>([&function, i]() { function(i); });
+		done.push_back(task->get_future());
+		boost::asio::post(*pool, [task]() { (*task)(); });
+	}
+
+	for (auto& task_done : done)
+		task_done.wait();
+	for (auto& task_done : done)
+		task_done.get();
+}
+
+static void make_chunk_nonce(const unsigned char* prefix, uint32_t index, unsigned char* nonce)
+{
+	memcpy(nonce, prefix, GCMChunk::NONCE_PREFIX_SIZE);
+	nonce[8] = static_cast<unsigned char>(index >> 24);
+	nonce[9] = static_cast<unsigned char>(index >> 16);
+	nonce[10] = static_cast<unsigned char>(index >> 8);
+	nonce[11] = static_cast<unsigned char>(index);
+}
+
+/**
+ * @brief Builds the associated data of a chunk: its index, the last-chunk flag and the caller's data.
+ */
+static std::vector<unsigned char> make_chunk_aad(uint32_t index, bool last, const std::string& associated_data)
+{
+	std::vector<unsigned char> aad(CHUNK_AAD_SIZE + associated_data.size());
+	aad[0] = static_cast<unsigned char>(index >> 24);
+	aad[1] = static_cast<unsigned char>(index >> 16);
+	aad[2] = static_cast<unsigned char>(index >> 8);
+	aad[3] = static_cast<unsigned char>(index);
+	aad[4] = last ? 1 : 0;
+	if (!associated_data.empty())
+		memcpy(&aad[CHUNK_AAD_SIZE], associated_data.data(), associated_data.size());
+	return aad;
+}
+
+uint64_t GCMChunk::cipher_length(uint64_t plain_length, uint32_t chunk_size)
+{
+	uint64_t chunks = plain_length == 0 ? 1 : (plain_length + chunk_size - 1) / chunk_size;
+	return HEADER_SIZE + plain_length + chunks * TAG_SIZE;
+}
+
+
+GCMChunkEncryptor::GCMChunkEncryptor(std::shared_ptr<const AESWrapper> session, boost::asio::thread_pool* pool, uint32_t chunk_size,
+	const std::string& associated_data)
+	: _session(std::move(session)), _pool(pool), _chunkSize(chunk_size), _associatedData(associated_data), _nextChunk(0), _headerSent(false), _finished(false)
+{
+	if (chunk_size == 0 || chunk_size > GCMChunk::MAX_CHUNK_SIZE)
+		throw std::invalid_argument("invalid chunk size");
+
+	CryptoProvider::current().random_bytes(_noncePrefix, sizeof(_noncePrefix));
+}
+
+uint32_t GCMChunkEncryptor::chunk_size() const
+{
+	return _chunkSize;
+}
+
+void GCMChunkEncryptor::encrypt(const char* plain, size_t length, bool last, std::string& cipher)
+{
+	TRACE_SCOPE("GCMChunkEncryptor::encrypt", "gcm");
+	if (_finished)
+		throw std::logic_error("the last window was already encrypted");
+	if (!last && (length == 0 || length % _chunkSize != 0))
+		throw std::invalid_argument("only the last window may hold a partial chunk");
+
+	size_t chunks = length == 0 ? 1 : (length + _chunkSize - 1) / _chunkSize;
+	size_t header_size = _headerSent ? 0 : GCMChunk::HEADER_SIZE;
+
+	cipher.resize(header_size + length + chunks * GCMChunk::TAG_SIZE);
+	unsigned char* out = reinterpret_cast<unsigned char*>(&cipher[0]);
+	if (!_headerSent)
+	{
+		memcpy(out, _noncePrefix, GCMChunk::NONCE_PREFIX_SIZE);
+		out[8] = static_cast<unsigned char>(_chunkSize);
+		out[9] = static_cast<unsigned char>(_chunkSize >> 8);
+		out[10] = static_cast<unsigned char>(_chunkSize >> 16);
+		out[11] = static_cast<unsigned char>(_chunkSize >> 24);
+		out += GCMChunk::HEADER_SIZE;
+	}
+
+	const unsigned char* in = reinterpret_cast<const unsigned char*>(plain);
+	const uint32_t first_chunk = _nextChunk;
+	const size_t record_size = _chunkSize + GCMChunk::TAG_SIZE;
+
+	run_parallel(_pool, chunks, [&](size_t i)
+		{
+			TRACE_SCOPE("GCMChunk::encrypt_chunk", "gcm");
+			size_t offset = i * _chunkSize;
+			size_t chunk_length = std::min<size_t>(_chunkSize, length - offset);
+			uint32_t index = first_chunk + static_cast<uint32_t>(i);
+			unsigned char* record = out + i * record_size;
+
+			unsigned char nonce[GCMChunk::HEADER_SIZE];
+			make_chunk_nonce(_noncePrefix, index, nonce);
+			std::vector<unsigned char> aad = make_chunk_aad(index, last && i == chunks - 1, _associatedData);
+
+			_session->cipher().gcm_seal(nonce, sizeof(nonce), aad.data(), aad.size(), in + offset, chunk_length, record, record + chunk_length, GCMChunk::TAG_SIZE);
+		});
+
+	_nextChunk += static_cast<uint32_t>(chunks);
+	_headerSent = true;
+	_finished = last;
+}
+
+
+GCMChunkDecryptor::GCMChunkDecryptor(std::shared_ptr<const AESWrapper> session, boost::asio::thread_pool* pool, size_t window,
+	const std::string& associated_data)
+	: _session(std::move(session)), _pool(pool), _window(window ? window : 1), _associatedData(associated_data), _headerRead(false), _chunkSize(0), _noncePrefix(), _nextChunk(0)
+{
+}
+
+void GCMChunkDecryptor::update(const char* cipher, size_t length, std::string& plain)
+{
+	plain.clear();
+	_pending.append(cipher, length);
+
+	if (!_headerRead)
+	{
+		if (_pending.size() < GCMChunk::HEADER_SIZE)
+			return;
+
+		const unsigned char* header = reinterpret_cast<const unsigned char*>(_pending.data());
+		memcpy(_noncePrefix, header, GCMChunk::NONCE_PREFIX_SIZE);
+		_chunkSize = header[8] | (header[9] << 8) | (header[10] << 16) | (static_cast<uint32_t>(header[11]) << 24);
+		if (_chunkSize == 0 || _chunkSize > GCMChunk::MAX_CHUNK_SIZE)
+			throw std::runtime_error("invalid chunk size in encrypted content");
+
+		_pending.erase(0, GCMChunk::HEADER_SIZE);
+		_headerRead = true;
+	}
+
+	// A complete record at the very end may be the final one, so it waits for more data or finish().
+	size_t record_size = _chunkSize + GCMChunk::TAG_SIZE;
+	size_t complete = _pending.size() / record_size;
+	if (complete > 0 && _pending.size() % record_size == 0)
+		complete--;
+
+	if (complete >= _window)
+		open_records(complete, false, plain);
+}
+
+void GCMChunkDecryptor::finish(std::string& plain)
+{
+	plain.clear();
+	if (!_headerRead || _pending.size() < GCMChunk::TAG_SIZE)
+		throw std::runtime_error("encrypted content is truncated");
+
+	size_t record_size = _chunkSize + GCMChunk::TAG_SIZE;
+	open_records((_pending.size() + record_size - 1) / record_size, true, plain);
+}
+
+void GCMChunkDecryptor::open_records(size_t count, bool last_is_final, std::string& plain)
+{
+	TRACE_SCOPE("GCMChunkDecryptor::open_records", "gcm");
+	const size_t record_size = _chunkSize + GCMChunk::TAG_SIZE;
+	const size_t consumed = std::min(count * record_size, _pending.size());
+	const size_t last_record_size = consumed - (count - 1) * record_size;
+	if (last_record_size < GCMChunk::TAG_SIZE)
+		throw std::runtime_error("encrypted content is truncated");
+
+	plain.resize(consumed - count * GCMChunk::TAG_SIZE);
+	unsigned char* out = reinterpret_cast<unsigned char*>(&plain[0]);
+	const unsigned char* in = reinterpret_cast<const unsigned char*>(_pending.data());
+	const uint32_t first_chunk = _nextChunk;
+
+	std::vector<char> verified(count, 0);
+	run_parallel(_pool, count, [&](size_t i)
+		{
+			TRACE_SCOPE("GCMChunk::decrypt_chunk", "gcm");
+			const unsigned char* record = in + i * record_size;
+			size_t chunk_length = (i == count - 1 ? last_record_size : record_size) - GCMChunk::TAG_SIZE;
+			uint32_t index = first_chunk + static_cast<uint32_t>(i);
+
+			unsigned char nonce[GCMChunk::HEADER_SIZE];
+			make_chunk_nonce(_noncePrefix, index, nonce);
+			std::vector<unsigned char> aad = make_chunk_aad(index, last_is_final && i == count - 1, _associatedData);
+
+			verified[i] = _session->cipher().gcm_open(nonce, sizeof(nonce), aad.data(), aad.size(), record, chunk_length, record + chunk_length, GCMChunk::TAG_SIZE, out + i * _chunkSize);
+		});
+
+	for (char chunk_verified : verified)
+	{
+		if (!chunk_verified)
+		{
+			plain.clear();
+			throw std::runtime_error("encrypted content failed authentication");
+		}
+	}
+
+	_pending.erase(0, consumed);
+	_nextChunk += static_cast<uint32_t>(count);
+}
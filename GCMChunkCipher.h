@@ -0,0 +1,140 @@
+/**
+ * @file GCMChunkCipher.h
+ * @brief Declaration of the chunked AES-GCM encryptor and decryptor for the MessageU project.
+ *
+ * This header declares a message encryption mode for large payloads. The payload is split into
+ * fixed-size chunks that are sealed independently with AES-GCM, so the chunks of a window are
+ * encrypted and decrypted on several threads at once.
+ *
+ * Content layout (FILE_SEND_GCM messages):
+ *   nonce prefix (8 bytes) | chunk size (4 bytes, little endian) | chunk records...
+ * Each record is the chunk ciphertext followed by a 16-byte tag. Every chunk but the last holds
+ * exactly "chunk size" bytes of plaintext. The nonce of chunk i is the prefix followed by i
+ * (4 bytes, big endian), and its associated data is i and a last-chunk flag, so records cannot
+ * be reordered, dropped or cut off without failing authentication. A caller may append its own
+ * associated data to that of every chunk (FILE_PART messages bind their part header this way).
+ *
+ * @version 2.0
+ * @author Dmitriy Gorodov
+ * @id 324725405
+ * @date 16/10/2026
+ */
+
+#pragma once
+
+#include "AESWrapper.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <boost/asio/thread_pool.hpp>
+
+/**
+ * @brief Parameters of the chunked AES-GCM content format.
+ */
+namespace GCMChunk
+{
+	const size_t NONCE_PREFIX_SIZE = 8;
+	const size_t HEADER_SIZE = NONCE_PREFIX_SIZE + 4;
+	const size_t TAG_SIZE = 16;
+	const uint32_t DEFAULT_CHUNK_SIZE = 1024 * 1024;
+	const uint32_t MAX_CHUNK_SIZE = 16 * 1024 * 1024;
+
+	/**
+	 * @brief Returns the content length for a plaintext of the given length.
+	 */
+	uint64_t cipher_length(uint64_t plain_length, uint32_t chunk_size = DEFAULT_CHUNK_SIZE);
+}
+
+/**
+ * @brief Encrypts a payload window by window, sealing the chunks of each window in parallel.
+ */
+class GCMChunkEncryptor
+{
+public:
+	/**
+	 * @brief Constructs an encryptor with a fresh random nonce prefix.
+	 * @param session The symmetric key session; it is kept alive while in use.
+	 * @param pool Thread pool the chunks are sealed on, or nullptr to seal them on the calling
+	 *             thread (for callers that already run on a pool thread).
+	 * @param chunk_size Plaintext bytes per chunk.
+	 * @param associated_data Authenticated with every chunk; the decryptor must be given the same.
+	 */
+	GCMChunkEncryptor(std::shared_ptr<const AESWrapper> session, boost::asio::thread_pool* pool, uint32_t chunk_size = GCMChunk::DEFAULT_CHUNK_SIZE,
+		const std::string& associated_data = std::string());
+
+	uint32_t chunk_size() const;
+
+	/**
+	 * @brief Encrypts the next window of plaintext.
+	 *
+	 * The content header is emitted in front of the first window.
+	 * @param length A multiple of the chunk size, unless this is the last window.
+	 * @param last true for the final window of the payload.
+	 * @param cipher Replaced with the records of the window.
+	 * @throws std::invalid_argument if a window other than the last one is not whole chunks.
+	 */
+	void encrypt(const char* plain, size_t length, bool last, std::string& cipher);
+
+private:
+	std::shared_ptr<const AESWrapper> _session;
+	boost::asio::thread_pool* _pool;
+	uint32_t _chunkSize;
+	std::string _associatedData;
+	unsigned char _noncePrefix[GCMChunk::NONCE_PREFIX_SIZE];
+	uint32_t _nextChunk;
+	bool _headerSent;
+	bool _finished;
+
+	GCMChunkEncryptor(const GCMChunkEncryptor& encryptor);
+};
+
+/**
+ * @brief Decrypts chunked AES-GCM content as it arrives, opening whole windows in parallel.
+ */
+class GCMChunkDecryptor
+{
+public:
+	/**
+	 * @brief Constructs a decryptor.
+	 * @param session The symmetric key session; it is kept alive while in use.
+	 * @param pool Thread pool the chunks are opened on, or nullptr to open them on the calling thread.
+	 * @param window Number of complete records collected before they are opened together.
+	 * @param associated_data The associated data the content was encrypted with.
+	 */
+	GCMChunkDecryptor(std::shared_ptr<const AESWrapper> session, boost::asio::thread_pool* pool, size_t window,
+		const std::string& associated_data = std::string());
+
+	/**
+	 * @brief Decrypts the next piece of content.
+	 * @param plain Replaced with the plaintext that became available (possibly none).
+	 * @throws std::runtime_error if the header is invalid or a chunk fails authentication.
+	 */
+	void update(const char* cipher, size_t length, std::string& plain);
+
+	/**
+	 * @brief Decrypts the remaining records; the final one must carry the last-chunk flag.
+	 * @param plain Replaced with the remaining plaintext.
+	 * @throws std::runtime_error if the content is truncated or fails authentication.
+	 */
+	void finish(std::string& plain);
+
+private:
+	std::shared_ptr<const AESWrapper> _session;
+	boost::asio::thread_pool* _pool;
+	size_t _window;
+	std::string _associatedData;
+	std::string _pending;
+	bool _headerRead;
+	uint32_t _chunkSize;
+	unsigned char _noncePrefix[GCMChunk::NONCE_PREFIX_SIZE];
+	uint32_t _nextChunk;
+
+	/**
+	 * @brief Opens the first count records of _pending and removes them.
+	 * @param last_is_final true if the last of those records ends the payload.
+	 */
+	void open_records(size_t count, bool last_is_final, std::string& plain);
+
+	GCMChunkDecryptor(const GCMChunkDecryptor& decryptor);
+};
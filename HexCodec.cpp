@@ -0,0 +1,283 @@
+/**
+ * @file HexCodec.cpp
+ * @brief Implementation of the hexadecimal codec kernels for the MessageU project.
+ *
+ * The SIMD kernels convert 16 (SSSE3) or 32 (AVX2) bytes per step with nibble shuffles, and hand
+ * the tail to the table kernel. They are compiled for their instruction set only and are called
+ * after a CPUID check, so the executable still runs on CPUs without them.
+ *
+ * @version 2.0
+ * @author Dmitriy Gorodov
+ * @id 342725405
+ * @date 16/10/2026
+ */
+
+#include "HexCodec.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define HEX_CODEC_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define HEX_TARGET(isa)
+#else
+#define HEX_TARGET(isa) __attribute__((target(isa)))
+#endif
+#endif
+
+static const char HEX_DIGITS[] = "0123456789abcdef";
+
+static const int8_t HEX_VALUES[256] = {
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	 0,  1,  2,  3,  4,  5,  6,  7,  8,  9, -1, -1, -1, -1, -1, -1,
+	-1, 10, 11, 12, 13, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, 10, 11, 12, 13, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1
+};
+
+int HexCodec::digit_value(char digit)
+{
+	return HEX_VALUES[static_cast<uint8_t>(digit)];
+}
+
+static void encode_table(const uint8_t* bytes, size_t length, char* hex)
+{
+	for (size_t i = 0; i < length; i++)
+	{
+		hex[2 * i] = HEX_DIGITS[bytes[i] >> 4];
+		hex[2 * i + 1] = HEX_DIGITS[bytes[i] & 0x0f];
+	}
+}
+
+static bool decode_table(const char* hex, size_t hex_length, uint8_t* bytes)
+{
+	for (size_t i = 0; i < hex_length / 2; i++)
+	{
+		int high = HEX_VALUES[static_cast<uint8_t>(hex[2 * i])];
+		int low = HEX_VALUES[static_cast<uint8_t>(hex[2 * i + 1])];
+		if ((high | low) < 0)
+			return false;
+		bytes[i] = static_cast<uint8_t>((high << 4) | low);
+	}
+	return true;
+}
+
+#ifdef HEX_CODEC_X86
+
+HEX_TARGET("ssse3") static void encode_ssse3(const uint8_t* bytes, size_t length, char* hex)
+{
+	const __m128i digits = _mm_loadu_si128(reinterpret_cast<const __m128i*>(HEX_DIGITS));
+	const __m128i nibble_mask = _mm_set1_epi8(0x0f);
+
+	size_t i = 0;
+	for (; i + 16 <= length; i += 16)
+	{
+		__m128i input = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + i));
+		__m128i high = _mm_shuffle_epi8(digits, _mm_and_si128(_mm_srli_epi16(input, 4), nibble_mask));
+		__m128i low = _mm_shuffle_epi8(digits, _mm_and_si128(input, nibble_mask));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(hex + 2 * i), _mm_unpacklo_epi8(high, low));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(hex + 2 * i + 16), _mm_unpackhi_epi8(high, low));
+	}
+	encode_table(bytes + i, length - i, hex + 2 * i);
+}
+
+/**
+ * @brief Converts 16 hex digits to their values; returns false if any is not a digit.
+ */
+HEX_TARGET("ssse3") static inline bool digit_values_ssse3(__m128i digits, __m128i* values)
+{
+	__m128i decimal = _mm_sub_epi8(digits, _mm_set1_epi8('0'));
+	__m128i is_decimal = _mm_cmpeq_epi8(_mm_min_epu8(decimal, _mm_set1_epi8(9)), decimal);
+	__m128i letter = _mm_sub_epi8(_mm_or_si128(digits, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+	__m128i is_letter = _mm_cmpeq_epi8(_mm_min_epu8(letter, _mm_set1_epi8(5)), letter);
+	if (_mm_movemask_epi8(_mm_or_si128(is_decimal, is_letter)) != 0xffff)
+		return false;
+
+	*values = _mm_or_si128(_mm_and_si128(is_decimal, decimal), _mm_and_si128(is_letter, _mm_add_epi8(letter, _mm_set1_epi8(10))));
+	return true;
+}
+
+HEX_TARGET("ssse3") static bool decode_ssse3(const char* hex, size_t hex_length, uint8_t* bytes)
+{
+	// Multiply-add of each (high, low) pair by (16, 1) forms the byte in a 16-bit lane.
+	const __m128i pair_weights = _mm_set1_epi16(0x0110);
+
+	size_t length = hex_length / 2;
+	size_t i = 0;
+	for (; i + 16 <= length; i += 16)
+	{
+		__m128i first, second;
+		if (!digit_values_ssse3(_mm_loadu_si128(reinterpret_cast<const __m128i*>(hex + 2 * i)), &first) ||
+			!digit_values_ssse3(_mm_loadu_si128(reinterpret_cast<const __m128i*>(hex + 2 * i + 16)), &second))
+			return false;
+
+		__m128i output = _mm_packus_epi16(_mm_maddubs_epi16(first, pair_weights), _mm_maddubs_epi16(second, pair_weights));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(bytes + i), output);
+	}
+	return decode_table(hex + 2 * i, hex_length - 2 * i, bytes + i);
+}
+
+HEX_TARGET("avx2") static void encode_avx2(const uint8_t* bytes, size_t length, char* hex)
+{
+	const __m256i digits = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(HEX_DIGITS)));
+	const __m256i nibble_mask = _mm256_set1_epi8(0x0f);
+
+	size_t i = 0;
+	for (; i + 32 <= length; i += 32)
+	{
+		__m256i input = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(bytes + i));
+		__m256i high = _mm256_shuffle_epi8(digits, _mm256_and_si256(_mm256_srli_epi16(input, 4), nibble_mask));
+		__m256i low = _mm256_shuffle_epi8(digits, _mm256_and_si256(input, nibble_mask));
+
+		// Unpacking works within 128-bit lanes; the permutes put the four quarters back in order.
+		__m256i first = _mm256_unpacklo_epi8(high, low);
+		__m256i second = _mm256_unpackhi_epi8(high, low);
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(hex + 2 * i), _mm256_permute2x128_si256(first, second, 0x20));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(hex + 2 * i + 32), _mm256_permute2x128_si256(first, second, 0x31));
+	}
+	encode_table(bytes + i, length - i, hex + 2 * i);
+}
+
+/**
+ * @brief Converts 32 hex digits to their values; returns false if any is not a digit.
+ */
+HEX_TARGET("avx2") static inline bool digit_values_avx2(__m256i digits, __m256i* values)
+{
+	__m256i decimal = _mm256_sub_epi8(digits, _mm256_set1_epi8('0'));
+	__m256i is_decimal = _mm256_cmpeq_epi8(_mm256_min_epu8(decimal, _mm256_set1_epi8(9)), decimal);
+	__m256i letter = _mm256_sub_epi8(_mm256_or_si256(digits, _mm256_set1_epi8(0x20)), _mm256_set1_epi8('a'));
+	__m256i is_letter = _mm256_cmpeq_epi8(_mm256_min_epu8(letter, _mm256_set1_epi8(5)), letter);
+	if (_mm256_movemask_epi8(_mm256_or_si256(is_decimal, is_letter)) != -1)
+		return false;
+
+	*values = _mm256_or_si256(_mm256_and_si256(is_decimal, decimal), _mm256_and_si256(is_letter, _mm256_add_epi8(letter, _mm256_set1_epi8(10))));
+	return true;
+}
+
+HEX_TARGET("avx2") static bool decode_avx2(const char* hex, size_t hex_length, uint8_t* bytes)
+{
+	const __m256i pair_weights = _mm256_set1_epi16(0x0110);
+
+	size_t length = hex_length / 2;
+	size_t i = 0;
+	for (; i + 32 <= length; i += 32)
+	{
+		__m256i first, second;
+		if (!digit_values_avx2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(hex + 2 * i)), &first) ||
+			!digit_values_avx2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(hex + 2 * i + 32)), &second))
+			return false;
+
+		__m256i packed = _mm256_packus_epi16(_mm256_maddubs_epi16(first, pair_weights), _mm256_maddubs_epi16(second, pair_weights));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(bytes + i), _mm256_permute4x64_epi64(packed, 0xd8));
+	}
+	return decode_table(hex + 2 * i, hex_length - 2 * i, bytes + i);
+}
+
+static bool cpu_supports(HexCodec::Kernel kernel)
+{
+#ifdef _MSC_VER
+	int info[4];
+	__cpuid(info, 0);
+	int max_leaf = info[0];
+	__cpuid(info, 1);
+	bool ssse3 = (info[2] & (1 << 9)) != 0;
+	bool os_saves_ymm = (info[2] & (1 << 27)) != 0 && (info[2] & (1 << 28)) != 0 && (_xgetbv(0) & 0x6) == 0x6;
+
+	if (kernel == HexCodec::Kernel::SSSE3)
+		return ssse3;
+	if (!ssse3 || !os_saves_ymm || max_leaf < 7)
+		return false;
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1 << 5)) != 0;
+#else
+	if (kernel == HexCodec::Kernel::SSSE3)
+		return __builtin_cpu_supports("ssse3");
+	return __builtin_cpu_supports("ssse3") && __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif
+
+bool HexCodec::is_supported(Kernel kernel)
+{
+	if (kernel == Kernel::TABLE)
+		return true;
+#ifdef HEX_CODEC_X86
+	return cpu_supports(kernel);
+#else
+	return false;
+#endif
+}
+
+HexCodec::Kernel HexCodec::best_kernel()
+{
+	static const Kernel best = is_supported(Kernel::AVX2) ? Kernel::AVX2 : is_supported(Kernel::SSSE3) ? Kernel::SSSE3 : Kernel::TABLE;
+	return best;
+}
+
+const char* HexCodec::kernel_name(Kernel kernel)
+{
+	switch (kernel)
+	{
+	case Kernel::SSSE3:
+		return "ssse3";
+	case Kernel::AVX2:
+		return "avx2";
+	default:
+		return "table";
+	}
+}
+
+void HexCodec::encode(const uint8_t* bytes, size_t length, char* hex)
+{
+	encode(bytes, length, hex, best_kernel());
+}
+
+void HexCodec::encode(const uint8_t* bytes, size_t length, char* hex, Kernel kernel)
+{
+	switch (kernel)
+	{
+#ifdef HEX_CODEC_X86
+	case Kernel::AVX2:
+		encode_avx2(bytes, length, hex);
+		break;
+	case Kernel::SSSE3:
+		encode_ssse3(bytes, length, hex);
+		break;
+#endif
+	default:
+		encode_table(bytes, length, hex);
+		break;
+	}
+}
+
+bool HexCodec::decode(const char* hex, size_t hex_length, uint8_t* bytes)
+{
+	return decode(hex, hex_length, bytes, best_kernel());
+}
+
+bool HexCodec::decode(const char* hex, size_t hex_length, uint8_t* bytes, Kernel kernel)
+{
+	switch (kernel)
+	{
+#ifdef HEX_CODEC_X86
+	case Kernel::AVX2:
+		return decode_avx2(hex, hex_length, bytes);
+	case Kernel::SSSE3:
+		return decode_ssse3(hex, hex_length, bytes);
+#endif
+	default:
+		return decode_table(hex, hex_length, bytes);
+	}
+}
@@ -0,0 +1,64 @@
+/**
+ * @file HexCodec.h
+ * @brief Declaration of the hexadecimal codec kernels for the MessageU project.
+ *
+ * This header declares the table-driven and SIMD (SSSE3, AVX2) hex encoders and decoders behind
+ * bytes_to_hex_string and hex_string_to_bytes. The fastest kernel the CPU supports is selected
+ * once, at first use.
+ *
+ * @version 2.0
+ * @author Dmitriy Gorodov
+ * @id 324725405
+ * @date 16/10/2026
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace HexCodec
+{
+	enum class Kernel
+	{
+		TABLE,
+		SSSE3,
+		AVX2
+	};
+
+	/**
+	 * @brief Returns the fastest kernel supported by this CPU.
+	 */
+	Kernel best_kernel();
+
+	/**
+	 * @brief Returns true if the kernel can run on this CPU.
+	 */
+	bool is_supported(Kernel kernel);
+
+	/**
+	 * @brief Returns a short name of the kernel, e.g. "avx2".
+	 */
+	const char* kernel_name(Kernel kernel);
+
+	/**
+	 * @brief Encodes bytes as lowercase hexadecimal.
+	 * @param hex Output of 2 * length characters (not NUL-terminated).
+	 */
+	void encode(const uint8_t* bytes, size_t length, char* hex);
+	void encode(const uint8_t* bytes, size_t length, char* hex, Kernel kernel);
+
+	/**
+	 * @brief Decodes pairs of hexadecimal digits (either case).
+	 * @param hex_length An even number of characters.
+	 * @param bytes Output of hex_length / 2 bytes.
+	 * @return false if the input holds a character that is not a hexadecimal digit.
+	 */
+	bool decode(const char* hex, size_t hex_length, uint8_t* bytes);
+	bool decode(const char* hex, size_t hex_length, uint8_t* bytes, Kernel kernel);
+
+	/**
+	 * @brief Returns the value of one hexadecimal digit, or -1 if the character is not one.
+	 */
+	int digit_value(char digit);
+}
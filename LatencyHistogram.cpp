@@ -0,0 +1,152 @@
+/**
+ * @file LatencyHistogram.cpp
+ * @brief Implementation of the LatencyHistogram class for the MessageU project.
+ *
+ * Maps values to log-linear buckets and computes percentiles from the bucket counts.
+ *
+ * @version 2.0
+ * @author Dmitriy Gorodov
+ * @id 342725405
+ * @date 16/10/2026
+ */
+
+#include "LatencyHistogram.h"
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+/**
+ * @brief Returns the index of the highest set bit of a non-zero value.
+ */
+static unsigned int highest_bit(uint64_t value)
+{
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanReverse64(&index, value);
+	return static_cast<unsigned int>(index);
+#else
+	return 63 - static_cast<unsigned int>(__builtin_clzll(value));
+#endif
+}
+
+LatencyHistogram::LatencyHistogram()
+	: count_(0), min_(UINT64_MAX), max_(0), sum_(0)
+{
+}
+
+size_t LatencyHistogram::bucket_index(uint64_t value)
+{
+	if (value < LINEAR_LIMIT)
+		return static_cast<size_t>(value);
+
+	unsigned int bit = highest_bit(value);
+	if (bit > HIGHEST_BIT)
+		return BUCKET_COUNT - 1;
+
+	// The top SUB_BUCKET_BITS + 1 bits select the bucket within the value's power of two.
+	unsigned int shift = bit - SUB_BUCKET_BITS;
+	uint64_t sub_bucket = (value >> shift) - (1ULL << SUB_BUCKET_BITS);
+	return static_cast<size_t>(LINEAR_LIMIT + (shift - 1) * (1ULL << SUB_BUCKET_BITS) + sub_bucket);
+}
+
+uint64_t LatencyHistogram::bucket_upper_bound(size_t index)
+{
+	if (index < LINEAR_LIMIT)
+		return index;
+
+	size_t offset = index - LINEAR_LIMIT;
+	unsigned int shift = static_cast<unsigned int>(offset >> SUB_BUCKET_BITS) + 1;
+	uint64_t top = (offset & ((1ULL << SUB_BUCKET_BITS) - 1)) + (1ULL << SUB_BUCKET_BITS);
+	return ((top + 1) << shift) - 1;
+}
+
+void LatencyHistogram::record(std::chrono::nanoseconds duration)
+{
+	uint64_t value = duration.count() > 0 ? static_cast<uint64_t>(duration.count()) : 0;
+	if (counts_.empty())
+		counts_.resize(BUCKET_COUNT);
+
+	counts_[bucket_index(value)]++;
+	count_++;
+	min_ = std::min(min_, value);
+	max_ = std::max(max_, value);
+	sum_ += static_cast<double>(value);
+}
+
+void LatencyHistogram::add(const LatencyHistogram& other)
+{
+	if (other.empty())
+		return;
+	if (counts_.empty())
+		counts_.resize(BUCKET_COUNT);
+
+	for (size_t i = 0; i < BUCKET_COUNT; i++)
+		counts_[i] += other.counts_[i];
+	count_ += other.count_;
+	min_ = std::min(min_, other.min_);
+	max_ = std::max(max_, other.max_);
+	sum_ += other.sum_;
+}
+
+void LatencyHistogram::reset()
+{
+	std::fill(counts_.begin(), counts_.end(), 0);
+	count_ = 0;
+	min_ = UINT64_MAX;
+	max_ = 0;
+	sum_ = 0;
+}
+
+double LatencyHistogram::mean() const
+{
+	return count_ ? sum_ / count_ : 0;
+}
+
+uint64_t LatencyHistogram::percentile(double fraction) const
+{
+	if (count_ == 0)
+		return 0;
+
+	uint64_t rank = static_cast<uint64_t>(std::ceil(std::min(std::max(fraction, 0.0), 1.0) * count_));
+	rank = std::max<uint64_t>(rank, 1);
+
+	uint64_t seen = 0;
+	for (size_t i = 0; i < BUCKET_COUNT; i++)
+	{
+		seen += counts_[i];
+		if (seen >= rank)
+			return i == BUCKET_COUNT - 1 ? max_ : std::min(std::max(bucket_upper_bound(i), min_), max_);
+	}
+	return max_;
+}
+
+std::string LatencyHistogram::to_json() const
+{
+	std::ostringstream json;
+	json.setf(std::ios::fixed);
+	json.precision(3);
+
+	json << "{\"count\": " << count_
+		<< ", \"min_us\": " << min() / 1e3
+		<< ", \"mean_us\": " << mean() / 1e3
+		<< ", \"p50_us\": " << percentile(0.50) / 1e3
+		<< ", \"p90_us\": " << percentile(0.90) / 1e3
+		<< ", \"p99_us\": " << percentile(0.99) / 1e3
+		<< ", \"p999_us\": " << percentile(0.999) / 1e3
+		<< ", \"max_us\": " << max() / 1e3
+		<< ", \"buckets\": [";
+
+	bool first = true;
+	for (size_t i = 0; i < counts_.size(); i++)
+	{
+		if (counts_[i] == 0)
+			continue;
+		json << (first ? "" : ", ") << "[" << bucket_upper_bound(i) << ", " << counts_[i] << "]";
+		first = false;
+	}
+	json << "]}";
+	return json.str();
+}
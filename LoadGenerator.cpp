@@ -0,0 +1,475 @@
+/**
+ * @file LoadGenerator.cpp
+ * @brief Implementation of the LoadGenerator class for the MessageU project.
+ *
+ * Contains the virtual client, which performs each operation as a chain of asynchronous
+ * requests on its own strand, and the collection of the latency samples.
+ *
+ * @version 2.0
+ * @author Dmitriy Gorodov
+ * @id 342725405
+ * @date 16/10/2026
+ */
+
+#include "LoadGenerator.h"
+#include "AESWrapper.h"
+#include "LatencyHistogram.h"
+#include "MockServer.h"
+#include "PendingMessageParser.h"
+#include "RSAWrapper.h"
+#include "RequestBuilder.h"
+#include "RequestPipeline.h"
+#include "utils.h"
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+
+using boost::asio::ip::tcp;
+
+static const size_t OPERATION_COUNT = static_cast<size_t>(LoadOperation::COUNT);
+
+bool LoadGeneratorOptions::parse_mix(const std::string& mix)
+{
+	std::array<unsigned int, OPERATION_COUNT> parsed = {};
+	std::istringstream entries(mix);
+	std::string entry;
+	while (std::getline(entries, entry, ','))
+	{
+		size_t colon = entry.find(':');
+		if (colon == std::string::npos)
+			return false;
+
+		std::string name = entry.substr(0, colon);
+		size_t operation = 1;
+		while (operation < OPERATION_COUNT && name != LoadGenerator::operation_name(static_cast<LoadOperation>(operation)))
+			operation++;
+		if (operation == OPERATION_COUNT)
+			return false;
+
+		try
+		{
+			parsed[operation] = static_cast<unsigned int>(std::stoul(entry.substr(colon + 1)));
+		}
+		catch (const std::exception&)
+		{
+			return false;
+		}
+	}
+
+	if (std::all_of(parsed.begin(), parsed.end(), [](unsigned int weight) { return weight == 0; }))
+		return false;
+
+	weights = parsed;
+	return true;
+}
+
+/**
+ * @brief One simulated MessageU client.
+ *
+ * All of its handlers run on the strand of its socket, so its state needs no locking. An
+ * operation is timed from the moment its first request is built until its last response has
+ * been handled, which includes the client-side encryption and decryption.
+ */
+class LoadGenerator::VirtualClient
+{
+public:
+	VirtualClient(LoadGenerator& generator, size_t index)
+		: generator_(generator), name_("load-" + std::to_string(index)),
+		socket_(boost::asio::make_strand(generator.io_context_)), pipeline_(socket_, 1),
+		random_(static_cast<unsigned int>(std::random_device()() + index)),
+		pick_operation_(generator.options_.weights.begin() + 1, generator.options_.weights.end()),
+		text_(generator.options_.text_size, 't'), file_(generator.options_.file_size, 'f'),
+		errors_()
+	{
+	}
+
+	/**
+	 * @brief Creates the identity, connects and registers.
+	 */
+	void start(const tcp::endpoint& endpoint)
+	{
+		boost::asio::post(socket_.get_executor(), [this, endpoint]()
+			{
+				identity_.reset(new RSAPrivateWrapper());
+				session_ = std::make_shared<AESWrapper>();
+
+				socket_.async_connect(endpoint, [this](const boost::system::error_code& error)
+					{
+						if (error)
+						{
+							generator_.client_registered(this, false);
+							return;
+						}
+						socket_.set_option(tcp::no_delay(true));
+						register_client();
+					});
+			});
+	}
+
+	/**
+	 * @brief Starts performing operations from the mix until the deadline.
+	 */
+	void start_mix()
+	{
+		boost::asio::post(socket_.get_executor(), [this]() { next_operation(); });
+	}
+
+	const ClientId& client_id() const { return client_id_; }
+	const LatencyHistogram& latencies(LoadOperation operation) const { return latencies_[static_cast<size_t>(operation)]; }
+	uint64_t errors(LoadOperation operation) const { return errors_[static_cast<size_t>(operation)]; }
+	Clock::time_point finished_at() const { return finished_at_; }
+
+private:
+	LoadGenerator& generator_;
+	std::string name_;
+	tcp::socket socket_;
+	RequestPipeline pipeline_;
+	RequestBuilder request_builder_;
+	std::mt19937 random_;
+	std::discrete_distribution<size_t> pick_operation_;	// over the weights after REGISTER
+
+	std::unique_ptr<RSAPrivateWrapper> identity_;
+	std::shared_ptr<AESWrapper> session_;	// the symmetric key this client hands out in key exchanges
+	std::unordered_map<ClientId, std::shared_ptr<AESWrapper>, ClientIdHash> peer_keys_;
+	ClientId client_id_;
+
+	std::string text_;
+	std::string file_;
+
+	std::array<LatencyHistogram, OPERATION_COUNT> latencies_;
+	std::array<uint64_t, OPERATION_COUNT> errors_;
+	Clock::time_point finished_at_;
+
+	void record(LoadOperation operation, Clock::time_point started, bool success)
+	{
+		size_t index = static_cast<size_t>(operation);
+		if (!success)
+		{
+			errors_[index]++;
+			return;
+		}
+		latencies_[index].record(Clock::now() - started);
+	}
+
+	void register_client()
+	{
+		std::string public_key = identity_->getPublicKey();
+		public_key.resize(MAX_PUBLIC_KEY_SIZE, '\0');
+
+		Clock::time_point started = Clock::now();
+		pipeline_.submit(request_builder_.build_registration_request(name_, std::vector<uint8_t>(public_key.begin(), public_key.end())),
+			[this, started](bool success, const ResponseHeader&, std::vector<uint8_t>& payload)
+			{
+				success = success && payload.size() == ClientId::SIZE;
+				record(LoadOperation::REGISTER, started, success);
+				if (success)
+					client_id_ = ClientId(payload.data());
+				generator_.client_registered(this, success);
+			});
+	}
+
+	void next_operation()
+	{
+		// A failed connection fails every later request at once, so the client stops.
+		if (Clock::now() >= generator_.deadline_ || !pipeline_.last_error().empty())
+		{
+			finished_at_ = Clock::now();
+			boost::system::error_code ignored;
+			socket_.close(ignored);
+			return;
+		}
+
+		LoadOperation operation = static_cast<LoadOperation>(pick_operation_(random_) + 1);
+
+		switch (operation)
+		{
+		case LoadOperation::CLIENT_LIST:
+			client_list();
+			break;
+		case LoadOperation::KEY_EXCHANGE:
+			key_exchange();
+			break;
+		case LoadOperation::TEXT_MESSAGE:
+			send_message(LoadOperation::TEXT_MESSAGE, MessageType::TEXT_MESSAGE_SEND, text_);
+			break;
+		case LoadOperation::FILE_SEND:
+			send_message(LoadOperation::FILE_SEND, MessageType::FILE_SEND, file_);
+			break;
+		default:
+			pending_messages();
+			break;
+		}
+	}
+
+	const ClientId& random_peer()
+	{
+		const auto& ids = generator_.registered_ids_;
+		std::uniform_int_distribution<size_t> pick(0, ids.size() - 1);
+		size_t index = pick(random_);
+		if (ids[index] == client_id_ && ids.size() > 1)
+			index = (index + 1) % ids.size();
+		return ids[index];
+	}
+
+	void client_list()
+	{
+		Clock::time_point started = Clock::now();
+		pipeline_.submit(request_builder_.build_client_list_request(client_id_),
+			[this, started](bool success, const ResponseHeader&, std::vector<uint8_t>&)
+			{
+				record(LoadOperation::CLIENT_LIST, started, success);
+				next_operation();
+			});
+	}
+
+	void key_exchange()
+	{
+		Clock::time_point started = Clock::now();
+		ClientId peer_id = random_peer();
+		pipeline_.submit(request_builder_.build_public_key_request(client_id_, peer_id),
+			[this, started, peer_id](bool success, const ResponseHeader&, std::vector<uint8_t>& payload)
+			{
+				std::string encrypted_key;
+				try
+				{
+					if (success && payload.size() >= MAX_CLIENT_ID_SIZE + MAX_PUBLIC_KEY_SIZE)
+					{
+						RSAPublicWrapper peer_key(reinterpret_cast<const char*>(&payload[MAX_CLIENT_ID_SIZE]), MAX_PUBLIC_KEY_SIZE);
+						encrypted_key = peer_key.encrypt(reinterpret_cast<const char*>(session_->getKey()), AESWrapper::DEFAULT_KEYLENGTH);
+					}
+				}
+				catch (const std::exception&)
+				{
+				}
+
+				if (encrypted_key.empty())
+				{
+					record(LoadOperation::KEY_EXCHANGE, started, false);
+					next_operation();
+					return;
+				}
+
+				pipeline_.submit(request_builder_.build_send_message_request(client_id_, peer_id, MessageType::SYMMETRIC_KEY_SEND, encrypted_key),
+					[this, started](bool success, const ResponseHeader&, std::vector<uint8_t>&)
+					{
+						record(LoadOperation::KEY_EXCHANGE, started, success);
+						next_operation();
+					});
+			});
+	}
+
+	void send_message(LoadOperation operation, uint8_t message_type, const std::string& plain)
+	{
+		Clock::time_point started = Clock::now();
+		std::string cipher = session_->encrypt(plain.data(), static_cast<unsigned int>(plain.size()));
+		pipeline_.submit(request_builder_.build_send_message_request(client_id_, random_peer(), message_type, cipher),
+			[this, started, operation](bool success, const ResponseHeader&, std::vector<uint8_t>&)
+			{
+				record(operation, started, success);
+				next_operation();
+			});
+	}
+
+	void pending_messages()
+	{
+		Clock::time_point started = Clock::now();
+		pipeline_.submit(request_builder_.build_pending_messages_request(client_id_),
+			[this, started](bool success, const ResponseHeader&, std::vector<uint8_t>& payload)
+			{
+				if (success)
+					success = decrypt_pending(payload);
+				record(LoadOperation::PENDING_MESSAGES, started, success);
+				next_operation();
+			});
+	}
+
+	/**
+	 * @brief Decrypts a pending messages payload as the client would.
+	 *
+	 * Messages from peers whose key has not arrived yet are skipped, not counted as failures.
+	 * @return false if the payload is malformed or a message fails to decrypt.
+	 */
+	bool decrypt_pending(const std::vector<uint8_t>& payload)
+	{
+		bool valid = true;
+		PendingMessageHeader record;
+		std::string content;
+
+		PendingMessageParser parser(
+			[&](const PendingMessageHeader& header)
+			{
+				record = header;
+				content.clear();
+				content.reserve(header.content_size);
+			},
+			[&](const uint8_t* data, size_t length)
+			{
+				content.append(reinterpret_cast<const char*>(data), length);
+			},
+			[&]()
+			{
+				try
+				{
+					if (record.message_type == MessageType::SYMMETRIC_KEY_SEND)
+					{
+						std::string key = identity_->decrypt(content);
+						if (key.size() != AESWrapper::DEFAULT_KEYLENGTH)
+							throw std::runtime_error("invalid symmetric key");
+						peer_keys_[record.sender_id] = std::make_shared<AESWrapper>(reinterpret_cast<const unsigned char*>(key.data()), AESWrapper::DEFAULT_KEYLENGTH);
+					}
+					else if (record.message_type == MessageType::TEXT_MESSAGE_SEND || record.message_type == MessageType::FILE_SEND)
+					{
+						auto peer_key = peer_keys_.find(record.sender_id);
+						if (peer_key != peer_keys_.end())
+							peer_key->second->decrypt(content.data(), static_cast<unsigned int>(content.size()));
+					}
+				}
+				catch (const std::exception&)
+				{
+					valid = false;
+				}
+			});
+
+		parser.feed(payload.data(), payload.size());
+		return valid && !parser.in_record();
+	}
+};
+
+LoadGenerator::LoadGenerator(const LoadGeneratorOptions& options)
+	: options_(options), registrations_done_(0)
+{
+}
+
+LoadGenerator::~LoadGenerator()
+{
+}
+
+const char* LoadGenerator::operation_name(LoadOperation operation)
+{
+	switch (operation)
+	{
+	case LoadOperation::REGISTER: return "register";
+	case LoadOperation::CLIENT_LIST: return "list";
+	case LoadOperation::KEY_EXCHANGE: return "key";
+	case LoadOperation::TEXT_MESSAGE: return "text";
+	case LoadOperation::FILE_SEND: return "file";
+	case LoadOperation::PENDING_MESSAGES: return "pending";
+	default: return "unknown";
+	}
+}
+
+std::vector<LoadOperationStats> LoadGenerator::run()
+{
+	size_t threads = options_.threads ? options_.threads : std::max(1u, std::thread::hardware_concurrency());
+
+	std::unique_ptr<MockServer> mock_server;
+	tcp::endpoint endpoint;
+	if (options_.port == 0)
+	{
+		mock_server.reset(new MockServer());
+		mock_server->start(threads);
+		endpoint = tcp::endpoint(boost::asio::ip::make_address("127.0.0.1"), mock_server->port());
+	}
+	else
+	{
+		tcp::resolver resolver(io_context_);
+		endpoint = *resolver.resolve(options_.host, std::to_string(options_.port)).begin();
+	}
+
+	registration_start_ = Clock::now();
+	// Until registration ends no operation may finish on the deadline.
+	deadline_ = Clock::time_point::max();
+	for (size_t i = 0; i < options_.clients; i++)
+	{
+		clients_.emplace_back(new VirtualClient(*this, i));
+		clients_.back()->start(endpoint);
+	}
+
+	// The run ends when every client has passed the deadline and closed its socket.
+	std::vector<std::thread> pool;
+	for (size_t i = 0; i < threads; i++)
+		pool.emplace_back([this]() { io_context_.run(); });
+	for (auto& thread : pool)
+		thread.join();
+
+	Clock::time_point mix_end = mix_start_;
+	for (const auto& client : clients_)
+		mix_end = std::max(mix_end, client->finished_at());
+
+	std::vector<LoadOperationStats> stats;
+	for (size_t index = 0; index < OPERATION_COUNT; index++)
+	{
+		LoadOperation operation = static_cast<LoadOperation>(index);
+		LatencyHistogram latencies;
+		uint64_t errors = 0;
+		for (const auto& client : clients_)
+		{
+			latencies.add(client->latencies(operation));
+			errors += client->errors(operation);
+		}
+		if (latencies.empty() && errors == 0)
+			continue;
+
+		Clock::time_point phase_start = operation == LoadOperation::REGISTER ? registration_start_ : mix_start_;
+		Clock::time_point phase_end = operation == LoadOperation::REGISTER ? mix_start_ : mix_end;
+		double seconds = std::max(std::chrono::duration<double>(phase_end - phase_start).count(), 1e-9);
+
+		stats.push_back(LoadOperationStats
+			{
+				operation,
+				latencies.count(),
+				errors,
+				latencies.count() / seconds,
+				latencies.percentile(0.50) / 1e6,
+				latencies.percentile(0.90) / 1e6,
+				latencies.percentile(0.99) / 1e6,
+				latencies.percentile(0.999) / 1e6,
+				latencies.max() / 1e6
+			});
+	}
+
+	clients_.clear();
+	return stats;
+}
+
+void LoadGenerator::client_registered(VirtualClient* client, bool success)
+{
+	std::vector<VirtualClient*> registered;
+	{
+		std::lock_guard<std::mutex> lock(registration_mutex_);
+		if (success)
+			registered_ids_.push_back(client->client_id());
+		if (++registrations_done_ < options_.clients)
+			return;
+
+		mix_start_ = Clock::now();
+		deadline_ = mix_start_ + options_.duration;
+		for (const auto& candidate : clients_)
+			if (!candidate->client_id().is_null())
+				registered.push_back(candidate.get());
+	}
+
+	for (VirtualClient* registered_client : registered)
+		registered_client->start_mix();
+}
+
+void LoadGenerator::print(const std::vector<LoadOperationStats>& stats)
+{
+	std::cout << std::left << std::setw(12) << "Operation" << std::right
+		<< std::setw(10) << "Count" << std::setw(8) << "Errors" << std::setw(12) << "Ops/s"
+		<< std::setw(10) << "p50 ms" << std::setw(10) << "p90 ms" << std::setw(10) << "p99 ms"
+		<< std::setw(10) << "p99.9 ms" << std::setw(10) << "max ms" << "\n";
+
+	for (const auto& stat : stats)
+	{
+		std::cout << std::left << std::setw(12) << operation_name(stat.operation) << std::right << std::fixed << std::setprecision(2)
+			<< std::setw(10) << stat.count << std::setw(8) << stat.errors << std::setw(12) << stat.operations_per_second
+			<< std::setw(10) << stat.p50_ms << std::setw(10) << stat.p90_ms << std::setw(10) << stat.p99_ms
+			<< std::setw(10) << stat.p999_ms << std::setw(10) << stat.max_ms << "\n";
+	}
+}
@@ -0,0 +1,137 @@
+/**
+ * @file LoadGenerator.h
+ * @brief Declaration of the LoadGenerator class for the MessageU project.
+ *
+ * This header defines a load generator that runs many virtual clients against one server
+ * ("--load-test") and reports the throughput and latency percentiles of each operation.
+ *
+ * @version 2.0
+ * @author Dmitriy Gorodov
+ * @id 324725405
+ * @date 16/10/2026
+ */
+
+#pragma once
+
+#include "ClientId.h"
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <boost/asio.hpp>
+
+/**
+ * @brief The operations a virtual client performs.
+ */
+enum class LoadOperation
+{
+	REGISTER,
+	CLIENT_LIST,
+	KEY_EXCHANGE,	// fetch a peer's public key, then send it our symmetric key
+	TEXT_MESSAGE,
+	FILE_SEND,
+	PENDING_MESSAGES,
+	COUNT
+};
+
+/**
+ * @brief Settings of a load test.
+ */
+struct LoadGeneratorOptions
+{
+	std::string host = "127.0.0.1";
+	uint16_t port = 0;	// 0 runs the test against an in-process MockServer
+	size_t clients = 100;
+	size_t threads = 0;	// 0 uses one thread per core
+	std::chrono::seconds duration = std::chrono::seconds(10);
+
+	/**
+	 * @brief Relative weight of each operation in the mix, indexed by LoadOperation.
+	 *
+	 * Every client registers once before the mix starts, so the REGISTER weight is not used.
+	 */
+	std::array<unsigned int, static_cast<size_t>(LoadOperation::COUNT)> weights = { { 0, 1, 1, 6, 1, 1 } };
+
+	size_t text_size = 64;
+	size_t file_size = 64 * 1024;
+
+	/**
+	 * @brief Sets the weights from a list such as "list:1,key:1,text:6,file:1,pending:1".
+	 *
+	 * Operations missing from the list get weight 0.
+	 * @return false if the list is malformed or every weight is 0; the weights are left unchanged.
+	 */
+	bool parse_mix(const std::string& mix);
+};
+
+/**
+ * @brief Throughput and latency of one operation type over a load test.
+ */
+struct LoadOperationStats
+{
+	LoadOperation operation;
+	uint64_t count;
+	uint64_t errors;
+	double operations_per_second;
+	double p50_ms;
+	double p90_ms;
+	double p99_ms;
+	double p999_ms;
+	double max_ms;
+};
+
+/**
+ * @brief The LoadGenerator class runs N virtual clients on a shared io_context.
+ *
+ * Every virtual client has its own RSA identity, symmetric key, RequestBuilder, socket and
+ * latency histograms, and runs on its own strand; the io_context is run by a pool of threads,
+ * which also does the clients' encryption. All clients register first. Then each one performs operations picked
+ * at random from the mix, one at a time, until the duration has passed.
+ */
+class LoadGenerator
+{
+public:
+	explicit LoadGenerator(const LoadGeneratorOptions& options);
+	~LoadGenerator();
+
+	/**
+	 * @brief Runs the load test to completion.
+	 * @return The statistics of every operation that was performed, in LoadOperation order.
+	 */
+	std::vector<LoadOperationStats> run();
+
+	/**
+	 * @brief Prints the statistics as a table.
+	 */
+	static void print(const std::vector<LoadOperationStats>& stats);
+
+	/**
+	 * @brief Returns the name of an operation as used in the mix, e.g. "text".
+	 */
+	static const char* operation_name(LoadOperation operation);
+
+private:
+	class VirtualClient;
+	typedef std::chrono::steady_clock Clock;
+
+	LoadGeneratorOptions options_;
+	boost::asio::io_context io_context_;
+	std::vector<std::unique_ptr<VirtualClient>> clients_;
+
+	std::mutex registration_mutex_;
+	size_t registrations_done_;
+	std::vector<ClientId> registered_ids_;	// read-only once the mix has started
+	Clock::time_point registration_start_;
+	Clock::time_point mix_start_;
+	Clock::time_point deadline_;
+
+	/**
+	 * @brief Called by every client once its registration has succeeded or failed.
+	 *
+	 * The last call starts the operation mix on every registered client.
+	 */
+	void client_registered(VirtualClient* client, bool success);
+};
@@ -0,0 +1,448 @@
+/**
+ * @file MessageStore.cpp
+ * @brief Implementation of the MessageStore class for the MessageU project.
+ *
+ * @version 2.0
+ * @author Dmitriy Gorodov
+ * @id 342725405
+ * @date 16/10/2026
+ */
+
+#include "MessageStore.h"
+#include "GCMChunkCipher.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+static const size_t RECORD_HEADER_SIZE = 4 + 4 + 8 + ClientId::SIZE + 1;
+static const size_t INDEX_ENTRY_SIZE = 8 + ClientId::SIZE + 1 + 8 + 4;
+
+/**
+ * @brief The largest gap between two records read in order that is read through rather than seeked over.
+ */
+static const uint64_t SKIP_LIMIT = 64 * 1024;
+
+static void put_le(char* out, uint64_t value, size_t bytes)
+{
+	for (size_t i = 0; i < bytes; i++)
+		out[i] = static_cast<char>(value >> (8 * i));
+}
+
+static uint64_t get_le(const char* in, size_t bytes)
+{
+	uint64_t value = 0;
+	for (size_t i = bytes; i-- > 0; )
+		value = (value << 8) | static_cast<unsigned char>(in[i]);
+	return value;
+}
+
+static void put_index_entry(char* raw, int64_t received_at, const ClientId& sender_id, uint8_t message_type, uint64_t offset, uint32_t length)
+{
+	put_le(raw, static_cast<uint64_t>(received_at), 8);
+	std::copy(sender_id.data(), sender_id.data() + ClientId::SIZE, raw + 8);
+	raw[8 + ClientId::SIZE] = static_cast<char>(message_type);
+	put_le(raw + 8 + ClientId::SIZE + 1, offset, 8);
+	put_le(raw + 8 + ClientId::SIZE + 1 + 8, length, 4);
+}
+
+/**
+ * @brief Returns the associated data a record's content is sealed with: the record header
+ *        after the length and the checksum.
+ */
+static std::string record_aad(int64_t received_at, const ClientId& sender_id, uint8_t message_type)
+{
+	char aad[RECORD_HEADER_SIZE - 8];
+	put_le(aad, static_cast<uint64_t>(received_at), 8);
+	std::copy(sender_id.data(), sender_id.data() + ClientId::SIZE, aad + 8);
+	aad[8 + ClientId::SIZE] = static_cast<char>(message_type);
+	return std::string(aad, sizeof(aad));
+}
+
+/**
+ * @brief 32-bit FNV-1a, continued from hash.
+ */
+static uint32_t fnv1a(const char* data, size_t length, uint32_t hash = 2166136261u)
+{
+	for (size_t i = 0; i < length; i++)
+		hash = (hash ^ static_cast<unsigned char>(data[i])) * 16777619u;
+	return hash;
+}
+
+/**
+ * @brief Appends data to a file and syncs it to disk.
+ */
+static bool append_synced(const std::string& path, const std::string& data)
+{
+#ifdef _WIN32
+	FILE* file = nullptr;
+	if (fopen_s(&file, path.c_str(), "ab") != 0)
+		return false;
+#else
+	FILE* file = std::fopen(path.c_str(), "ab");
+	if (!file)
+		return false;
+#endif
+	bool written = std::fwrite(data.data(), 1, data.size(), file) == data.size() && std::fflush(file) == 0;
+#ifdef _WIN32
+	written = written && _commit(_fileno(file)) == 0;
+#else
+	written = written && fsync(fileno(file)) == 0;
+#endif
+	return std::fclose(file) == 0 && written;
+}
+
+MessageStore::MessageStore(const std::string& directory)
+	: directory_(directory), active_segment_(0), active_size_(0), last_received_at_(0), write_failed_(false)
+{
+}
+
+std::string MessageStore::segment_path(uint32_t segment, const char* extension) const
+{
+	std::ostringstream name;
+	name << std::setw(8) << std::setfill('0') << segment << extension;
+	return (std::filesystem::path(directory_) / name.str()).string();
+}
+
+void MessageStore::open(std::shared_ptr<const AESWrapper> storage_key)
+{
+	storage_key_ = std::move(storage_key);
+	entries_.clear();
+	by_sender_.clear();
+	by_type_.clear();
+	active_segment_ = 0;
+	active_size_ = 0;
+
+	std::vector<uint32_t> segments;
+	std::error_code error;
+	for (const auto& file : std::filesystem::directory_iterator(directory_, error))
+	{
+		std::string name = file.path().filename().string();
+		if (name.size() == 12 && name.compare(8, 4, ".log") == 0 && std::all_of(name.begin(), name.begin() + 8, ::isdigit))
+			segments.push_back(static_cast<uint32_t>(std::stoul(name.substr(0, 8))));
+	}
+	std::sort(segments.begin(), segments.end());
+
+	for (size_t i = 0; i < segments.size(); i++)
+		load_segment(segments[i], i + 1 == segments.size());
+	if (!entries_.empty())
+		last_received_at_ = entries_.back().received_at;
+}
+
+void MessageStore::load_segment(uint32_t segment, bool last)
+{
+	std::string log_path = segment_path(segment, ".log");
+	std::string index_path = segment_path(segment, ".idx");
+	std::error_code error;
+	uint64_t log_size = std::filesystem::file_size(log_path, error);
+	if (error)
+		return;
+
+	// Entries are trusted as far as they describe consecutive records inside the log.
+	uint64_t end = 0;
+	uint64_t indexed = 0;
+	{
+		std::ifstream index(index_path, std::ios::binary);
+		char raw[INDEX_ENTRY_SIZE];
+		while (index.read(raw, sizeof(raw)))
+		{
+			IndexEntry entry;
+			entry.received_at = static_cast<int64_t>(get_le(raw, 8));
+			entry.sender_id = ClientId(reinterpret_cast<const uint8_t*>(raw + 8));
+			entry.message_type = static_cast<uint8_t>(raw[8 + ClientId::SIZE]);
+			entry.segment = segment;
+			entry.offset = get_le(raw + 8 + ClientId::SIZE + 1, 8);
+			entry.length = static_cast<uint32_t>(get_le(raw + 8 + ClientId::SIZE + 1 + 8, 4));
+			if (entry.offset != end || end + RECORD_HEADER_SIZE + entry.length > log_size)
+				break;
+			add_entry(entry);
+			end += RECORD_HEADER_SIZE + entry.length;
+			indexed++;
+		}
+	}
+
+	// Records written after the last index entry are checked against their checksums.
+	std::string recovered_index;
+	{
+		std::ifstream log(log_path, std::ios::binary);
+		log.seekg(static_cast<std::streamoff>(end));
+		char header[RECORD_HEADER_SIZE];
+		std::string content;
+		while (end + RECORD_HEADER_SIZE <= log_size && log.read(header, sizeof(header)))
+		{
+			uint32_t length = static_cast<uint32_t>(get_le(header, 4));
+			if (end + RECORD_HEADER_SIZE + length > log_size)
+				break;
+			content.resize(length);
+			if (length && !log.read(&content[0], length))
+				break;
+			uint32_t checksum = fnv1a(content.data(), content.size(), fnv1a(header + 8, RECORD_HEADER_SIZE - 8));
+			if (checksum != static_cast<uint32_t>(get_le(header + 4, 4)))
+				break;
+
+			IndexEntry entry;
+			entry.received_at = static_cast<int64_t>(get_le(header + 8, 8));
+			entry.sender_id = ClientId(reinterpret_cast<const uint8_t*>(header + 16));
+			entry.message_type = static_cast<uint8_t>(header[16 + ClientId::SIZE]);
+			entry.segment = segment;
+			entry.offset = end;
+			entry.length = length;
+			add_entry(entry);
+
+			char raw[INDEX_ENTRY_SIZE];
+			put_index_entry(raw, entry.received_at, entry.sender_id, entry.message_type, entry.offset, entry.length);
+			recovered_index.append(raw, sizeof(raw));
+			end += RECORD_HEADER_SIZE + length;
+		}
+	}
+
+	uint64_t index_size = std::filesystem::file_size(index_path, error);
+	if (error)
+		index_size = 0;
+	if (!recovered_index.empty() || index_size != indexed * INDEX_ENTRY_SIZE)
+	{
+		if (index_size)
+			std::filesystem::resize_file(index_path, indexed * INDEX_ENTRY_SIZE, error);
+		if (!recovered_index.empty())
+			append_synced(index_path, recovered_index);
+	}
+
+	if (last)
+	{
+		if (end < log_size)
+			std::filesystem::resize_file(log_path, end, error);
+		active_segment_ = segment;
+		active_size_ = end;
+	}
+}
+
+void MessageStore::add_entry(const IndexEntry& entry)
+{
+	uint32_t position = static_cast<uint32_t>(entries_.size());
+	entries_.push_back(entry);
+	by_sender_[entry.sender_id].push_back(position);
+	by_type_[entry.message_type].push_back(position);
+}
+
+void MessageStore::append(const ClientId& sender_id, uint8_t message_type, const std::string& content)
+{
+	if (!storage_key_)
+		return;
+
+	// Receive order is time order, even if the clock is set back.
+	int64_t now = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+	last_received_at_ = std::max(last_received_at_, static_cast<int64_t>(now));
+
+	GCMChunkEncryptor encryptor(storage_key_, nullptr, GCMChunk::DEFAULT_CHUNK_SIZE, record_aad(last_received_at_, sender_id, message_type));
+	std::string sealed;
+	encryptor.encrypt(content.data(), content.size(), true, sealed);
+	queued_.push_back(StoredMessage{ last_received_at_, sender_id, message_type, std::move(sealed) });
+}
+
+bool MessageStore::flush()
+{
+	if (queued_.empty())
+		return true;
+
+	std::error_code error;
+	std::filesystem::create_directories(directory_, error);
+
+	bool written = true;
+	size_t next = 0;
+	while (written && next < queued_.size())
+	{
+		// A segment is full once the next record would take it past SEGMENT_SIZE.
+		if (active_segment_ == 0 || (active_size_ > 0 && active_size_ + RECORD_HEADER_SIZE + queued_[next].content.size() > SEGMENT_SIZE))
+		{
+			active_segment_++;
+			active_size_ = 0;
+		}
+
+		std::string records;
+		std::string index;
+		std::vector<IndexEntry> batch;
+		for (; next < queued_.size(); next++)
+		{
+			const StoredMessage& message = queued_[next];
+			uint64_t offset = active_size_ + records.size();
+			if (offset > 0 && offset + RECORD_HEADER_SIZE + message.content.size() > SEGMENT_SIZE)
+				break;
+
+			char header[RECORD_HEADER_SIZE];
+			put_le(header, message.content.size(), 4);
+			put_le(header + 8, static_cast<uint64_t>(message.received_at), 8);
+			std::copy(message.sender_id.data(), message.sender_id.data() + ClientId::SIZE, header + 16);
+			header[16 + ClientId::SIZE] = static_cast<char>(message.message_type);
+			put_le(header + 4, fnv1a(message.content.data(), message.content.size(), fnv1a(header + 8, RECORD_HEADER_SIZE - 8)), 4);
+			records.append(header, sizeof(header)).append(message.content);
+
+			IndexEntry entry{ message.received_at, message.sender_id, message.message_type, active_segment_, offset, static_cast<uint32_t>(message.content.size()) };
+			char raw[INDEX_ENTRY_SIZE];
+			put_index_entry(raw, entry.received_at, entry.sender_id, entry.message_type, entry.offset, entry.length);
+			index.append(raw, sizeof(raw));
+			batch.push_back(entry);
+		}
+
+		// The log is synced before the index, so an index entry never points past the log.
+		written = append_synced(segment_path(active_segment_, ".log"), records) && append_synced(segment_path(active_segment_, ".idx"), index);
+		if (written)
+		{
+			for (const IndexEntry& entry : batch)
+				add_entry(entry);
+			active_size_ += records.size();
+		}
+		else
+		{
+			// The segment may end in a torn record now; later messages start a new one.
+			active_segment_++;
+			active_size_ = 0;
+		}
+	}
+
+	if (!written && !write_failed_)
+		std::cerr << "Warning: unable to write the message history to " << directory_ << "; some messages were not saved.\n";
+	write_failed_ = !written;
+	queued_.clear();
+	return written;
+}
+
+std::vector<StoredMessage> MessageStore::query(const MessageQuery& query) const
+{
+	// The candidates are the sender's messages, the type's messages or all of them, in time order.
+	static const std::vector<uint32_t> none;
+	const std::vector<uint32_t>* candidates = nullptr;
+	if (!query.sender_id.is_null())
+	{
+		auto sender = by_sender_.find(query.sender_id);
+		candidates = sender == by_sender_.end() ? &none : &sender->second;
+	}
+	else if (query.message_types != 0 && (query.message_types & (query.message_types - 1)) == 0)
+	{
+		uint8_t type = 0;
+		while (!(query.message_types & (1u << type)))
+			type++;
+		auto messages = by_type_.find(type);
+		candidates = messages == by_type_.end() ? &none : &messages->second;
+	}
+
+	size_t count = candidates ? candidates->size() : entries_.size();
+	auto position_of = [&](size_t k) -> size_t { return candidates ? (*candidates)[k] : k; };
+
+	// Binary search for the first candidate received at or after the end of the range.
+	size_t low = 0, high = count;
+	while (low < high)
+	{
+		size_t middle = low + (high - low) / 2;
+		if (entries_[position_of(middle)].received_at < query.to)
+			low = middle + 1;
+		else
+			high = middle;
+	}
+
+	std::vector<size_t> selected;
+	for (size_t k = low; k-- > 0 && selected.size() < query.limit; )
+	{
+		const IndexEntry& entry = entries_[position_of(k)];
+		if (entry.received_at < query.from)
+			break;
+		if (!query.sender_id.is_null() && entry.sender_id != query.sender_id)
+			continue;
+		if (query.message_types != 0 && (entry.message_type >= 32 || !(query.message_types & (1u << entry.message_type))))
+			continue;
+		selected.push_back(position_of(k));
+	}
+
+	std::vector<StoredMessage> messages;
+	messages.reserve(selected.size());
+	for (auto position = selected.rbegin(); position != selected.rend(); ++position)
+	{
+		StoredMessage message;
+		if (read(*position, &message))
+			messages.push_back(std::move(message));
+	}
+	return messages;
+}
+
+bool MessageStore::read(size_t position, StoredMessage* message) const
+{
+	if (position >= entries_.size())
+		return false;
+
+	std::ifstream log;
+	uint32_t open_segment = 0;
+	uint64_t log_offset = 0;
+	return read_record(entries_[position], log, &open_segment, &log_offset, message);
+}
+
+void MessageStore::for_each(size_t from, uint32_t message_types, const std::function<void(size_t, const StoredMessage&)>& visit) const
+{
+	std::ifstream log;
+	uint32_t open_segment = 0;
+	uint64_t log_offset = 0;
+	StoredMessage message;
+	for (size_t position = from; position < entries_.size(); position++)
+	{
+		const IndexEntry& entry = entries_[position];
+		if (message_types != 0 && (entry.message_type >= 32 || !(message_types & (1u << entry.message_type))))
+			continue;
+		if (read_record(entry, log, &open_segment, &log_offset, &message))
+			visit(position, message);
+	}
+}
+
+bool MessageStore::read_record(const IndexEntry& entry, std::ifstream& log, uint32_t* open_segment, uint64_t* log_offset, StoredMessage* message) const
+{
+	uint64_t content_offset = entry.offset + RECORD_HEADER_SIZE;
+	if (entry.segment != *open_segment)
+	{
+		log.close();
+		log.clear();
+		log.open(segment_path(entry.segment, ".log"), std::ios::binary);
+		*open_segment = entry.segment;
+		*log_offset = 0;
+	}
+
+	// Records are read in log order by for_each(); a short gap is skipped by reading through
+	// it, as a seek drops the stream's buffer.
+	log.clear();
+	if (content_offset >= *log_offset && content_offset - *log_offset <= SKIP_LIMIT)
+		log.ignore(static_cast<std::streamsize>(content_offset - *log_offset));
+	else
+		log.seekg(static_cast<std::streamoff>(content_offset));
+	*log_offset = content_offset + entry.length;
+	// The sealed content is read into the message, then replaced by its plaintext.
+	std::string& sealed = message->content;
+	sealed.resize(entry.length);
+	if (!storage_key_ || (entry.length && !log.read(&sealed[0], entry.length)))
+		return false;
+
+	try
+	{
+		GCMChunkDecryptor decryptor(storage_key_, nullptr, 1, record_aad(entry.received_at, entry.sender_id, entry.message_type));
+		std::string plain;
+		std::string rest;
+		decryptor.update(sealed.data(), sealed.size(), plain);
+		decryptor.finish(rest);
+		plain.append(rest);
+		message->content.swap(plain);
+	}
+	catch (const std::exception&)
+	{
+		return false;
+	}
+
+	message->received_at = entry.received_at;
+	message->sender_id = entry.sender_id;
+	message->message_type = entry.message_type;
+	return true;
+}
@@ -0,0 +1,166 @@
+/**
+ * @file MessageStore.h
+ * @brief Declaration of the MessageStore class for the MessageU project.
+ *
+ * The message store keeps the history of received messages in an append-only log, split into
+ * segments of at most SEGMENT_SIZE bytes ("history/00000001.log", ...). Each segment has an
+ * index file ("00000001.idx") with one fixed-size entry per message, so the history can be
+ * opened and queried without reading the messages themselves.
+ *
+ * Log record:   content length (4) | checksum (4) | received at (8) | sender ID (16) | type (1) | content
+ * Index entry:  received at (8) | sender ID (16) | type (1) | record offset (8) | content length (4)
+ * Integers are little endian; times are milliseconds since the epoch. The checksum is FNV-1a
+ * over the rest of the record, so a record torn by a crash is recognized and dropped.
+ *
+ * The content is sealed in the chunked AES-GCM format (GCMChunkCipher.h) with the client's
+ * storage key (PeerKeyStore::storage_key()), with received at, sender ID and type as associated
+ * data, so the history on disk holds no message text. The rest of the record and the index stay
+ * in the clear, so the history is opened and queried without decrypting anything.
+ *
+ * @version 2.0
+ * @author Dmitriy Gorodov
+ * @id 324725405
+ * @date 16/10/2026
+ */
+
+#pragma once
+
+#include "AESWrapper.h"
+#include "ClientId.h"
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief A message of the history.
+ */
+struct StoredMessage
+{
+	int64_t received_at;	// milliseconds since the epoch
+	ClientId sender_id;
+	uint8_t message_type;
+	std::string content;
+};
+
+/**
+ * @brief The criteria of a history query. Every criterion left at its default matches all messages.
+ */
+struct MessageQuery
+{
+	ClientId sender_id;	// the null ID matches every sender
+	uint32_t message_types = 0;	// a bit (1 << type) per accepted type; 0 accepts every type
+	int64_t from = std::numeric_limits<int64_t>::min();	// received at or after, in ms since the epoch
+	int64_t to = std::numeric_limits<int64_t>::max();	// received before
+	size_t limit = 20;	// the newest matching messages are returned
+};
+
+/**
+ * @brief The MessageStore class appends received messages to the history and queries it.
+ *
+ * Messages are queued by append() and written by flush(), which syncs the log and the index to
+ * disk once for the whole batch. The index is kept in memory in receive order, which is time
+ * order, together with the positions of each sender's and each type's messages. A query binary
+ * searches the most selective of these lists for its time range and reads only the content of
+ * the messages it returns.
+ */
+class MessageStore
+{
+public:
+	static const uint64_t SEGMENT_SIZE = 64 * 1024 * 1024;
+
+	explicit MessageStore(const std::string& directory);
+
+	/**
+	 * @brief Loads the index of every segment.
+	 *
+	 * Messages of a segment that are missing from its index (e.g. after a crash between the two
+	 * writes) are indexed again; a torn record at the end of the last segment is cut off.
+	 * @param storage_key The key the contents are sealed with.
+	 */
+	void open(std::shared_ptr<const AESWrapper> storage_key);
+
+	/**
+	 * @brief Returns true once the store has been opened.
+	 */
+	bool is_open() const { return static_cast<bool>(storage_key_); }
+
+	/**
+	 * @brief Seals a received message and queues it for the next flush(). Does nothing until
+	 *        the store is open.
+	 */
+	void append(const ClientId& sender_id, uint8_t message_type, const std::string& content);
+
+	/**
+	 * @brief Writes the queued messages and syncs the log and the index, once for the batch.
+	 * @return false if the messages could not be written; they are dropped.
+	 */
+	bool flush();
+
+	/**
+	 * @brief Returns the newest messages that match a query, oldest first.
+	 */
+	std::vector<StoredMessage> query(const MessageQuery& query) const;
+
+	/**
+	 * @brief Returns the number of stored messages.
+	 */
+	size_t size() const { return entries_.size(); }
+
+	/**
+	 * @brief Reads a stored message by its position in receive order.
+	 * @return false if its record cannot be read or fails authentication (e.g. it was sealed
+	 *         under an earlier registration).
+	 */
+	bool read(size_t position, StoredMessage* message) const;
+
+	/**
+	 * @brief Reads the stored messages from a position on, in receive order.
+	 * @param from The position of the first message.
+	 * @param message_types A bit (1 << type) per type to read; 0 reads every type.
+	 * @param visit Called with the position and the message; the message is reused between calls.
+	 */
+	void for_each(size_t from, uint32_t message_types, const std::function<void(size_t, const StoredMessage&)>& visit) const;
+
+private:
+	struct IndexEntry
+	{
+		int64_t received_at;
+		ClientId sender_id;
+		uint8_t message_type;
+		uint32_t segment;
+		uint64_t offset;
+		uint32_t length;
+	};
+
+	std::string directory_;
+	std::shared_ptr<const AESWrapper> storage_key_;
+	std::vector<IndexEntry> entries_;	// in receive order
+	std::unordered_map<ClientId, std::vector<uint32_t>, ClientIdHash> by_sender_;	// positions in entries_
+	std::unordered_map<uint8_t, std::vector<uint32_t>> by_type_;
+	std::vector<StoredMessage> queued_;	// with their contents sealed
+	uint32_t active_segment_;
+	uint64_t active_size_;
+	int64_t last_received_at_;
+	bool write_failed_;
+
+	std::string segment_path(uint32_t segment, const char* extension) const;
+
+	/**
+	 * @brief Reads a message's content from its segment, which log may already have open.
+	 * @param log_offset The offset log is at; updated past the content read.
+	 */
+	bool read_record(const IndexEntry& entry, std::ifstream& log, uint32_t* open_segment, uint64_t* log_offset, StoredMessage* message) const;
+
+	/**
+	 * @brief Loads the index of a segment and indexes the records that follow its last entry.
+	 * @param last true for the last segment, whose torn tail is cut off.
+	 */
+	void load_segment(uint32_t segment, bool last);
+
+	void add_entry(const IndexEntry& entry);
+};
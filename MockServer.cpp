@@ -0,0 +1,479 @@
+/**
+ * @file MockServer.cpp
+ * @brief Implementation of the MockServer class for the MessageU project.
+ *
+ * Contains the per-connection session, which reads requests and times the replies through the
+ * shaped link, and the in-memory handling of request codes 600-604.
+ *
+ * @version 2.0
+ * @author Dmitriy Gorodov
+ * @id 342725405
+ * @date 16/10/2026
+ */
+
+#include "MockServer.h"
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <memory>
+
+using boost::asio::ip::tcp;
+
+/**
+ * @brief One client connection.
+ *
+ * Requests are handled as soon as they are read. Each reply is then scheduled for the time it
+ * would leave a shaped link: after the request has crossed the uplink, the configured latency
+ * and the replies ahead of it on the downlink.
+ */
+class MockServer::Session : public std::enable_shared_from_this<MockServer::Session>
+{
+public:
+	Session(MockServer& server, tcp::socket socket)
+		: server_(server), socket_(std::move(socket)), timer_(socket_.get_executor()),
+		request_header_(), timer_armed_(false), writing_(false), closing_(false)
+	{
+		uplink_free_ = downlink_free_ = std::chrono::steady_clock::now();
+	}
+
+	void start()
+	{
+		boost::system::error_code ignored;
+		socket_.set_option(tcp::no_delay(true), ignored);
+		read_header();
+	}
+
+	/**
+	 * @brief Closes the connection. Called by stop() once no thread runs the server.
+	 */
+	void close()
+	{
+		boost::system::error_code ignored;
+		timer_.cancel();
+		socket_.close(ignored);
+	}
+
+private:
+	typedef std::chrono::steady_clock Clock;
+
+	MockServer& server_;
+	tcp::socket socket_;
+	boost::asio::steady_timer timer_;
+
+	std::array<uint8_t, REQUEST_HEADER_SIZE> request_header_;
+	std::vector<uint8_t> request_payload_;
+
+	Clock::time_point uplink_free_;
+	Clock::time_point downlink_free_;
+	std::deque<std::pair<Clock::time_point, std::vector<uint8_t>>> delayed_;
+	std::deque<std::vector<uint8_t>> outgoing_;
+	bool timer_armed_;
+	bool writing_;
+	bool closing_;
+
+	void read_header()
+	{
+		auto self = shared_from_this();
+		boost::asio::async_read(socket_, boost::asio::buffer(request_header_), [this, self](const boost::system::error_code& error, size_t)
+			{
+				if (error) return;
+
+				uint32_t payload_size;
+				memcpy(&payload_size, request_header_.data() + MAX_CLIENT_ID_SIZE + 3, 4);
+				if (payload_size > server_.options_.max_payload_size)
+				{
+					// The payload is not read, so the stream cannot be resynchronized.
+					closing_ = true;
+					schedule_reply(make_error_response(), REQUEST_HEADER_SIZE);
+					return;
+				}
+
+				request_payload_.resize(payload_size);
+				boost::asio::async_read(socket_, boost::asio::buffer(request_payload_), [this, self](const boost::system::error_code& error, size_t)
+					{
+						if (error) return;
+
+						RequestHeader header;
+						header.client_id = ClientId(request_header_.data());
+						header.version = request_header_[MAX_CLIENT_ID_SIZE];
+						memcpy(&header.code, request_header_.data() + MAX_CLIENT_ID_SIZE + 1, 2);
+						memcpy(&header.payload_size, request_header_.data() + MAX_CLIENT_ID_SIZE + 3, 4);
+
+						size_t request_size = REQUEST_HEADER_SIZE + request_payload_.size();
+						std::vector<uint8_t> reply = server_.handle_request(header, request_payload_);
+						request_payload_ = std::vector<uint8_t>();
+						schedule_reply(std::move(reply), request_size);
+						read_header();
+					});
+			});
+	}
+
+	Clock::duration transfer_time(size_t bytes) const
+	{
+		uint64_t bytes_per_second = server_.options_.bytes_per_second;
+		if (bytes_per_second == 0)
+			return Clock::duration::zero();
+		return std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(static_cast<double>(bytes) / bytes_per_second));
+	}
+
+	void schedule_reply(std::vector<uint8_t> reply, size_t request_size)
+	{
+		if (server_.options_.latency.count() == 0 && server_.options_.bytes_per_second == 0)
+		{
+			outgoing_.push_back(std::move(reply));
+			write_next();
+			return;
+		}
+
+		Clock::time_point arrived = std::max(Clock::now(), uplink_free_) + transfer_time(request_size);
+		uplink_free_ = arrived;
+
+		Clock::time_point sending = std::max(arrived + server_.options_.latency, downlink_free_);
+		downlink_free_ = sending + transfer_time(reply.size());
+
+		delayed_.emplace_back(downlink_free_, std::move(reply));
+		arm_timer();
+	}
+
+	void arm_timer()
+	{
+		if (timer_armed_ || delayed_.empty())
+			return;
+
+		timer_armed_ = true;
+		timer_.expires_at(delayed_.front().first);
+		auto self = shared_from_this();
+		timer_.async_wait([this, self](const boost::system::error_code& error)
+			{
+				timer_armed_ = false;
+				if (error) return;
+
+				auto now = Clock::now();
+				while (!delayed_.empty() && delayed_.front().first <= now)
+				{
+					outgoing_.push_back(std::move(delayed_.front().second));
+					delayed_.pop_front();
+				}
+				arm_timer();
+				write_next();
+			});
+	}
+
+	void write_next()
+	{
+		if (writing_)
+			return;
+
+		if (outgoing_.empty())
+		{
+			if (closing_ && delayed_.empty())
+			{
+				boost::system::error_code ignored;
+				socket_.shutdown(tcp::socket::shutdown_both, ignored);
+				socket_.close(ignored);
+			}
+			return;
+		}
+
+		writing_ = true;
+		auto self = shared_from_this();
+		boost::asio::async_write(socket_, boost::asio::buffer(outgoing_.front()), [this, self](const boost::system::error_code& error, size_t)
+			{
+				writing_ = false;
+				if (error) return;
+				outgoing_.pop_front();
+				write_next();
+			});
+	}
+};
+
+MockServer::MockServer(const MockServerOptions& options)
+	: options_(options),
+	acceptor_(io_context_, tcp::endpoint(boost::asio::ip::make_address(options.address), options.port)),
+	id_generator_(std::random_device()()), next_message_id_(1)
+{
+	accept();
+}
+
+MockServer::~MockServer()
+{
+	stop();
+}
+
+void MockServer::start(size_t threads)
+{
+	for (size_t i = 0; i < std::max<size_t>(threads, 1); i++)
+		threads_.emplace_back([this]() { io_context_.run(); });
+}
+
+void MockServer::run()
+{
+	boost::asio::signal_set signals(io_context_, SIGINT, SIGTERM);
+	signals.async_wait([this](const boost::system::error_code& error, int)
+		{
+			if (!error)
+				io_context_.stop();
+		});
+	io_context_.run();
+}
+
+void MockServer::stop()
+{
+	io_context_.stop();
+	for (auto& thread : threads_)
+		thread.join();
+	threads_.clear();
+
+	// No handler runs any more, so the sockets can be closed from this thread.
+	boost::system::error_code ignored;
+	acceptor_.close(ignored);
+
+	std::lock_guard<std::mutex> lock(sessions_mutex_);
+	for (const auto& weak_session : sessions_)
+	{
+		if (std::shared_ptr<Session> session = weak_session.lock())
+			session->close();
+	}
+	sessions_.clear();
+}
+
+uint16_t MockServer::port() const
+{
+	return acceptor_.local_endpoint().port();
+}
+
+ClientId MockServer::add_client(const std::string& name, const std::vector<uint8_t>& public_key)
+{
+	std::lock_guard<std::mutex> lock(state_mutex_);
+	return register_client(name, public_key);
+}
+
+size_t MockServer::client_count() const
+{
+	std::lock_guard<std::mutex> lock(state_mutex_);
+	return clients_.size();
+}
+
+size_t MockServer::pending_message_count() const
+{
+	std::lock_guard<std::mutex> lock(state_mutex_);
+	size_t count = 0;
+	for (const auto& client : clients_)
+		count += client.second.pending.size();
+	return count;
+}
+
+void MockServer::accept()
+{
+	acceptor_.async_accept(boost::asio::make_strand(io_context_), [this](const boost::system::error_code& error, tcp::socket socket)
+		{
+			if (error)
+				return;
+
+			auto session = std::make_shared<Session>(*this, std::move(socket));
+			{
+				std::lock_guard<std::mutex> lock(sessions_mutex_);
+				sessions_.erase(std::remove_if(sessions_.begin(), sessions_.end(),
+					[](const std::weak_ptr<Session>& weak_session) { return weak_session.expired(); }), sessions_.end());
+				sessions_.push_back(session);
+			}
+			session->start();
+			accept();
+		});
+}
+
+std::vector<uint8_t> MockServer::handle_request(const RequestHeader& header, std::vector<uint8_t>& payload)
+{
+	if (header.code == RequestCode::REGISTER_CLIENT)
+		return handle_registration(payload);
+
+	{
+		// Every other request must come from a registered client.
+		std::lock_guard<std::mutex> lock(state_mutex_);
+		if (clients_.find(header.client_id) == clients_.end())
+			return make_error_response();
+	}
+
+	switch (header.code)
+	{
+	case RequestCode::LIST_ALL_CLIENTS:
+		return handle_client_list(header.client_id);
+	case RequestCode::FETCH_PUBLIC_KEY:
+		return handle_public_key(payload);
+	case RequestCode::SEND_MESSAGE:
+		return handle_send_message(header.client_id, payload);
+	case RequestCode::LIST_PENDING_MESSAGES:
+		return handle_pending_messages(header.client_id);
+	default:
+		return make_error_response();
+	}
+}
+
+std::vector<uint8_t> MockServer::handle_registration(const std::vector<uint8_t>& payload)
+{
+	if (payload.size() != MAX_CLIENT_NAME_SIZE + MAX_PUBLIC_KEY_SIZE)
+		return make_error_response();
+
+	std::string name(payload.begin(), payload.begin() + MAX_CLIENT_NAME_SIZE);
+	name.erase(std::find(name.begin(), name.end(), '\0'), name.end());
+	std::vector<uint8_t> public_key(payload.begin() + MAX_CLIENT_NAME_SIZE, payload.end());
+
+	ClientId client_id;
+	{
+		std::lock_guard<std::mutex> lock(state_mutex_);
+		client_id = register_client(name, public_key);
+	}
+	if (client_id.is_null())
+		return make_error_response();
+
+	std::vector<uint8_t> response = make_response(ResponseCode::REGISTRATION_SUCCEEDED, ClientId::SIZE);
+	memcpy(&response[RESPONSE_HEADER_SIZE], client_id.data(), ClientId::SIZE);
+	return response;
+}
+
+std::vector<uint8_t> MockServer::handle_client_list(const ClientId& client_id)
+{
+	const size_t record_size = MAX_CLIENT_ID_SIZE + MAX_CLIENT_NAME_SIZE;
+
+	std::lock_guard<std::mutex> lock(state_mutex_);
+	std::vector<uint8_t> response = make_response(ResponseCode::CLIENT_LIST_RETURNED, static_cast<uint32_t>((clients_.size() - 1) * record_size));
+
+	// The requester is left out of its own list.
+	uint8_t* record = &response[RESPONSE_HEADER_SIZE];
+	for (const ClientId& listed_id : registration_order_)
+	{
+		if (listed_id == client_id)
+			continue;
+
+		const std::string& name = clients_.at(listed_id).name;
+		memcpy(record, listed_id.data(), ClientId::SIZE);
+		memcpy(record + MAX_CLIENT_ID_SIZE, name.data(), name.size());
+		record += record_size;
+	}
+	return response;
+}
+
+std::vector<uint8_t> MockServer::handle_public_key(const std::vector<uint8_t>& payload)
+{
+	if (payload.size() != ClientId::SIZE)
+		return make_error_response();
+
+	ClientId target_id(payload.data());
+	std::lock_guard<std::mutex> lock(state_mutex_);
+	auto target = clients_.find(target_id);
+	if (target == clients_.end())
+		return make_error_response();
+
+	std::vector<uint8_t> response = make_response(ResponseCode::PUBLIC_KEY_RETURNED, MAX_CLIENT_ID_SIZE + MAX_PUBLIC_KEY_SIZE);
+	memcpy(&response[RESPONSE_HEADER_SIZE], target_id.data(), ClientId::SIZE);
+	memcpy(&response[RESPONSE_HEADER_SIZE + MAX_CLIENT_ID_SIZE], target->second.public_key.data(), MAX_PUBLIC_KEY_SIZE);
+	return response;
+}
+
+std::vector<uint8_t> MockServer::handle_send_message(const ClientId& client_id, std::vector<uint8_t>& payload)
+{
+	if (payload.size() < SEND_MESSAGE_HEAD_SIZE)
+		return make_error_response();
+
+	ClientId target_id(payload.data());
+	uint8_t message_type = payload[MAX_CLIENT_ID_SIZE];
+	uint32_t content_size;
+	memcpy(&content_size, &payload[MAX_CLIENT_ID_SIZE + MAX_MESSAGE_TYPE_BYTES], 4);
+	if (content_size != payload.size() - SEND_MESSAGE_HEAD_SIZE)
+		return make_error_response();
+
+	uint32_t message_id;
+	{
+		std::lock_guard<std::mutex> lock(state_mutex_);
+		auto target = clients_.find(target_id);
+		if (target == clients_.end())
+			return make_error_response();
+
+		message_id = next_message_id_++;
+		if (options_.store_messages)
+			target->second.pending.push_back(StoredMessage{ client_id, message_id, message_type, std::move(payload) });
+	}
+
+	std::vector<uint8_t> response = make_response(ResponseCode::MESSAGE_SENT, MAX_CLIENT_ID_SIZE + MAX_MESSAGE_ID_BYTES);
+	memcpy(&response[RESPONSE_HEADER_SIZE], target_id.data(), ClientId::SIZE);
+	memcpy(&response[RESPONSE_HEADER_SIZE + MAX_CLIENT_ID_SIZE], &message_id, MAX_MESSAGE_ID_BYTES);
+	return response;
+}
+
+std::vector<uint8_t> MockServer::handle_pending_messages(const ClientId& client_id)
+{
+	const size_t record_header_size = MAX_CLIENT_ID_SIZE + MAX_MESSAGE_ID_BYTES + MAX_MESSAGE_TYPE_BYTES + MAX_MESSAGE_CONTENT_BYTES;
+
+	std::deque<StoredMessage> pending;
+	size_t payload_size = 0;
+	{
+		std::lock_guard<std::mutex> lock(state_mutex_);
+		// A backlog too large for one response is returned over several requests, oldest first.
+		std::deque<StoredMessage>& waiting = clients_.at(client_id).pending;
+		while (!waiting.empty())
+		{
+			size_t record_size = record_header_size + waiting.front().request_payload.size() - SEND_MESSAGE_HEAD_SIZE;
+			if (payload_size + record_size > UINT32_MAX)
+				break;
+			payload_size += record_size;
+			pending.push_back(std::move(waiting.front()));
+			waiting.pop_front();
+		}
+	}
+
+	std::vector<uint8_t> response = make_response(ResponseCode::PENDING_MESSAGES_RETURNED, static_cast<uint32_t>(payload_size));
+	uint8_t* record = &response[RESPONSE_HEADER_SIZE];
+	for (const auto& message : pending)
+	{
+		uint32_t content_size = static_cast<uint32_t>(message.request_payload.size() - SEND_MESSAGE_HEAD_SIZE);
+
+		memcpy(record, message.sender_id.data(), ClientId::SIZE);
+		memcpy(record + MAX_CLIENT_ID_SIZE, &message.message_id, MAX_MESSAGE_ID_BYTES);
+		record[MAX_CLIENT_ID_SIZE + MAX_MESSAGE_ID_BYTES] = message.message_type;
+		memcpy(record + MAX_CLIENT_ID_SIZE + MAX_MESSAGE_ID_BYTES + MAX_MESSAGE_TYPE_BYTES, &content_size, MAX_MESSAGE_CONTENT_BYTES);
+		if (content_size > 0)
+			memcpy(record + record_header_size, &message.request_payload[SEND_MESSAGE_HEAD_SIZE], content_size);
+		record += record_header_size + content_size;
+	}
+	return response;
+}
+
+ClientId MockServer::register_client(const std::string& name, const std::vector<uint8_t>& public_key)
+{
+	if (name.empty() || name.size() >= MAX_CLIENT_NAME_SIZE || names_.count(name))
+		return ClientId();
+
+	ClientId client_id;
+	do
+	{
+		std::array<uint8_t, ClientId::SIZE> bytes;
+		for (size_t i = 0; i < bytes.size(); i += 8)
+		{
+			uint64_t random = id_generator_();
+			memcpy(&bytes[i], &random, 8);
+		}
+		client_id = ClientId(bytes.data());
+	} while (client_id.is_null() || clients_.count(client_id));
+
+	RegisteredClient& client = clients_[client_id];
+	client.name = name;
+	client.public_key = public_key;
+	client.public_key.resize(MAX_PUBLIC_KEY_SIZE, 0);
+	names_.insert(name);
+	registration_order_.push_back(client_id);
+	return client_id;
+}
+
+std::vector<uint8_t> MockServer::make_response(uint16_t code, uint32_t payload_size)
+{
+	std::vector<uint8_t> response(RESPONSE_HEADER_SIZE + static_cast<size_t>(payload_size), 0);
+	response[0] = CLIENT_VERSION;
+	memcpy(&response[1], &code, 2);
+	memcpy(&response[3], &payload_size, 4);
+	return response;
+}
+
+std::vector<uint8_t> MockServer::make_error_response()
+{
+	return make_response(SERVER_ERROR_CODE, 0);
+}
@@ -0,0 +1,175 @@
+/**
+ * @file MockServer.h
+ * @brief Declaration of the MockServer class for the MessageU project.
+ *
+ * This header defines a local, in-memory MessageU server. It answers request codes 600-604
+ * on a loopback port, with optional link latency and bandwidth shaping, so the client can be
+ * benchmarked end to end without a real server or an outside network.
+ *
+ * @version 2.0
+ * @author Dmitriy Gorodov
+ * @id 324725405
+ * @date 16/10/2026
+ */
+
+#pragma once
+
+#include "ClientId.h"
+#include "RequestBuilder.h"
+#include "ResponseHandler.h"
+#include "utils.h"
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <boost/asio.hpp>
+
+/**
+ * @brief Settings of a MockServer.
+ */
+struct MockServerOptions
+{
+	std::string address = "127.0.0.1";
+	uint16_t port = 0;	// 0 picks a free port; see MockServer::port()
+
+	/**
+	 * @brief Delay added to every reply, standing in for the round trip of a WAN link.
+	 */
+	std::chrono::microseconds latency = std::chrono::microseconds(0);
+
+	/**
+	 * @brief Link speed in bytes per second, applied to each direction of every connection. 0 is unlimited.
+	 */
+	uint64_t bytes_per_second = 0;
+
+	/**
+	 * @brief Largest request payload accepted; larger requests get an error and the connection is closed.
+	 */
+	uint32_t max_payload_size = 256 * 1024 * 1024;
+
+	/**
+	 * @brief Set to false for throughput runs that never fetch their messages; they are then acknowledged and dropped.
+	 */
+	bool store_messages = true;
+};
+
+/**
+ * @brief The MockServer class is an in-memory MessageU server on a loopback socket.
+ *
+ * Registered clients and their waiting messages live only as long as the server. Every
+ * connection is served on its own strand, so the server can run on several threads; replies
+ * on one connection keep the request order, as the protocol requires.
+ */
+class MockServer
+{
+public:
+	/**
+	 * @brief Binds the listening socket and starts accepting. No thread runs it yet.
+	 * @throws boost::system::system_error if the address cannot be bound.
+	 */
+	explicit MockServer(const MockServerOptions& options = MockServerOptions());
+
+	/**
+	 * @brief Stops the server and joins its threads.
+	 */
+	~MockServer();
+
+	MockServer(const MockServer&) = delete;
+	MockServer& operator=(const MockServer&) = delete;
+
+	/**
+	 * @brief Runs the server on background threads and returns.
+	 * @param threads Number of threads serving connections.
+	 */
+	void start(size_t threads = 1);
+
+	/**
+	 * @brief Runs the server on the calling thread until stop() is called or SIGINT/SIGTERM arrives.
+	 */
+	void run();
+
+	/**
+	 * @brief Stops serving, joins the background threads and closes the listening socket and
+	 *        every open connection, so the port is free again when it returns.
+	 */
+	void stop();
+
+	/**
+	 * @brief Returns the port the server listens on.
+	 */
+	uint16_t port() const;
+
+	/**
+	 * @brief Registers a client directly, without a connection, e.g. to seed a benchmark.
+	 * @return The new client's ID, or the null ID if the name is taken.
+	 */
+	ClientId add_client(const std::string& name, const std::vector<uint8_t>& public_key);
+
+	size_t client_count() const;
+	size_t pending_message_count() const;
+
+private:
+	class Session;
+
+	struct StoredMessage
+	{
+		ClientId sender_id;
+		uint32_t message_id;
+		uint8_t message_type;
+		std::vector<uint8_t> request_payload;	// the whole send message payload; the content starts at SEND_MESSAGE_HEAD_SIZE
+	};
+
+	struct RegisteredClient
+	{
+		std::string name;
+		std::vector<uint8_t> public_key;
+		std::deque<StoredMessage> pending;
+	};
+
+	MockServerOptions options_;
+	boost::asio::io_context io_context_;
+	boost::asio::ip::tcp::acceptor acceptor_;
+	std::vector<std::thread> threads_;
+
+	std::mutex sessions_mutex_;
+	std::vector<std::weak_ptr<Session>> sessions_;	// open connections, closed by stop()
+
+	mutable std::mutex state_mutex_;
+	std::unordered_map<ClientId, RegisteredClient, ClientIdHash> clients_;
+	std::vector<ClientId> registration_order_;
+	std::unordered_set<std::string> names_;
+	std::mt19937_64 id_generator_;
+	uint32_t next_message_id_;
+
+	void accept();
+
+	/**
+	 * @brief Handles one complete request and returns the serialized response.
+	 *
+	 * Safe to call from any connection's strand. A sent message keeps the payload, so it may be moved out.
+	 */
+	std::vector<uint8_t> handle_request(const RequestHeader& header, std::vector<uint8_t>& payload);
+
+	std::vector<uint8_t> handle_registration(const std::vector<uint8_t>& payload);
+	std::vector<uint8_t> handle_client_list(const ClientId& client_id);
+	std::vector<uint8_t> handle_public_key(const std::vector<uint8_t>& payload);
+	std::vector<uint8_t> handle_send_message(const ClientId& client_id, std::vector<uint8_t>& payload);
+	std::vector<uint8_t> handle_pending_messages(const ClientId& client_id);
+
+	/**
+	 * @brief Registers a client. The caller holds state_mutex_.
+	 */
+	ClientId register_client(const std::string& name, const std::vector<uint8_t>& public_key);
+
+	/**
+	 * @brief Serializes a response header followed by room for payload_size bytes of payload.
+	 */
+	static std::vector<uint8_t> make_response(uint16_t code, uint32_t payload_size);
+	static std::vector<uint8_t> make_error_response();
+};
@@ -0,0 +1,351 @@
+/**
+ * @file OpenSSLProvider.cpp
+ * @brief Implementation of the OpenSSL EVP crypto provider for the MessageU project.
+ *
+ * @version 2.0
+ * @author Dmitriy Gorodov
+ * @id 342725405
+ * @date 16/10/2026
+ */
+
+#include "OpenSSLProvider.h"
+
+#ifdef MESSAGEU_WITH_OPENSSL
+
+#include <openssl/err.h>
+#include <openssl/evp.h>
+#include <openssl/rand.h>
+#include <openssl/rsa.h>
+#include <openssl/x509.h>
+
+#include <algorithm>
+#include <climits>
+#include <stdexcept>
+#include <vector>
+
+/**
+ * @brief Throws the oldest queued OpenSSL error, prefixed with what failed.
+ */
+static void throw_openssl_error(const char* what)
+{
+	char reason[256] = "unknown error";
+	unsigned long error = ERR_get_error();
+	if (error)
+		ERR_error_string_n(error, reason, sizeof(reason));
+	ERR_clear_error();
+	throw std::runtime_error(std::string(what) + ": " + reason);
+}
+
+static void check(int result, const char* what)
+{
+	if (result <= 0)
+		throw_openssl_error(what);
+}
+
+struct CipherContextDeleter { void operator()(EVP_CIPHER_CTX* context) const { EVP_CIPHER_CTX_free(context); } };
+struct KeyDeleter { void operator()(EVP_PKEY* key) const { EVP_PKEY_free(key); } };
+struct KeyContextDeleter { void operator()(EVP_PKEY_CTX* context) const { EVP_PKEY_CTX_free(context); } };
+typedef std::unique_ptr<EVP_CIPHER_CTX, CipherContextDeleter> CipherContext;
+typedef std::unique_ptr<EVP_PKEY, KeyDeleter> Key;
+typedef std::unique_ptr<EVP_PKEY_CTX, KeyContextDeleter> KeyContext;
+
+static CipherContext new_cipher_context()
+{
+	CipherContext context(EVP_CIPHER_CTX_new());
+	if (!context)
+		throw_openssl_error("EVP_CIPHER_CTX_new");
+	return context;
+}
+
+static const unsigned char ZERO_IV[16] = { 0 };	// for practical use iv should never be a fixed value!
+
+/**
+ * @brief Largest input handed to one EVP update call, whose length is an int.
+ */
+static const size_t MAX_UPDATE = 1 << 30;
+
+class OpenSSLCBCStream : public CBCStream
+{
+public:
+	OpenSSLCBCStream(const EVP_CIPHER* cipher, const unsigned char* key, bool encrypt)
+		: _context(new_cipher_context()), _encrypt(encrypt)
+	{
+		check(EVP_CipherInit_ex(_context.get(), cipher, nullptr, key, ZERO_IV, encrypt ? 1 : 0), "AES-CBC init");
+	}
+
+	void update(const char* in, size_t length, std::string& out) override
+	{
+		out.resize(length + 16);
+		size_t written = 0;
+		for (size_t offset = 0; offset < length; offset += MAX_UPDATE)
+		{
+			int part = static_cast<int>(std::min(MAX_UPDATE, length - offset));
+			int part_written = 0;
+			check(EVP_CipherUpdate(_context.get(), reinterpret_cast<unsigned char*>(&out[written]), &part_written,
+				reinterpret_cast<const unsigned char*>(in + offset), part), "AES-CBC update");
+			written += part_written;
+		}
+		out.resize(written);
+	}
+
+	void finish(std::string& out) override
+	{
+		out.resize(16);
+		int written = 0;
+		if (EVP_CipherFinal_ex(_context.get(), reinterpret_cast<unsigned char*>(&out[0]), &written) <= 0)
+		{
+			ERR_clear_error();
+			throw std::runtime_error(_encrypt ? "AES-CBC encryption failed" : "AES-CBC ciphertext is truncated or its padding is invalid");
+		}
+		out.resize(written);
+	}
+
+private:
+	CipherContext _context;
+	bool _encrypt;
+};
+
+class OpenSSLAESCipher : public AESCipher
+{
+public:
+	OpenSSLAESCipher(const EVP_CIPHER* cbc, const EVP_CIPHER* gcm, const unsigned char* key, size_t length)
+		: _cbc(cbc), _gcm(gcm), _key(key, key + length)
+	{
+		if (length != 16)
+			throw std::length_error("key length must be 16 bytes");
+	}
+
+	std::unique_ptr<CBCStream> cbc_encryptor() const override
+	{
+		return std::unique_ptr<CBCStream>(new OpenSSLCBCStream(_cbc, _key.data(), true));
+	}
+
+	std::unique_ptr<CBCStream> cbc_decryptor() const override
+	{
+		return std::unique_ptr<CBCStream>(new OpenSSLCBCStream(_cbc, _key.data(), false));
+	}
+
+	void gcm_seal(const unsigned char* nonce, size_t nonce_length, const unsigned char* aad, size_t aad_length,
+		const unsigned char* plain, size_t length, unsigned char* cipher, unsigned char* tag, size_t tag_length) const override
+	{
+		CipherContext context = gcm_context(nonce, nonce_length, aad, aad_length, true);
+		int written = 0;
+		if (length)
+			check(EVP_EncryptUpdate(context.get(), cipher, &written, plain, static_cast<int>(length)), "AES-GCM update");
+		check(EVP_EncryptFinal_ex(context.get(), cipher + written, &written), "AES-GCM final");
+		check(EVP_CIPHER_CTX_ctrl(context.get(), EVP_CTRL_GCM_GET_TAG, static_cast<int>(tag_length), tag), "AES-GCM tag");
+	}
+
+	bool gcm_open(const unsigned char* nonce, size_t nonce_length, const unsigned char* aad, size_t aad_length,
+		const unsigned char* cipher, size_t length, const unsigned char* tag, size_t tag_length, unsigned char* plain) const override
+	{
+		CipherContext context = gcm_context(nonce, nonce_length, aad, aad_length, false);
+		int written = 0;
+		if (length)
+			check(EVP_DecryptUpdate(context.get(), plain, &written, cipher, static_cast<int>(length)), "AES-GCM update");
+		check(EVP_CIPHER_CTX_ctrl(context.get(), EVP_CTRL_GCM_SET_TAG, static_cast<int>(tag_length), const_cast<unsigned char*>(tag)), "AES-GCM tag");
+		bool verified = EVP_DecryptFinal_ex(context.get(), plain + written, &written) > 0;
+		ERR_clear_error();
+		return verified;
+	}
+
+private:
+	const EVP_CIPHER* _cbc;
+	const EVP_CIPHER* _gcm;
+	std::vector<unsigned char> _key;
+
+	CipherContext gcm_context(const unsigned char* nonce, size_t nonce_length, const unsigned char* aad, size_t aad_length, bool encrypt) const
+	{
+		if (aad_length > INT_MAX)
+			throw std::length_error("associated data is too long");
+		CipherContext context = new_cipher_context();
+		check(EVP_CipherInit_ex(context.get(), _gcm, nullptr, nullptr, nullptr, encrypt ? 1 : 0), "AES-GCM init");
+		check(EVP_CIPHER_CTX_ctrl(context.get(), EVP_CTRL_GCM_SET_IVLEN, static_cast<int>(nonce_length), nullptr), "AES-GCM nonce length");
+		check(EVP_CipherInit_ex(context.get(), nullptr, nullptr, _key.data(), nonce, encrypt ? 1 : 0), "AES-GCM key");
+		int written = 0;
+		if (aad_length)
+			check(EVP_CipherUpdate(context.get(), nullptr, &written, aad, static_cast<int>(aad_length)), "AES-GCM associated data");
+		return context;
+	}
+};
+
+/**
+ * @brief Returns a context for a key operation with OAEP padding; OAEP uses SHA-1 by default.
+ */
+static KeyContext oaep_context(EVP_PKEY* key, bool encrypt)
+{
+	KeyContext context(EVP_PKEY_CTX_new(key, nullptr));
+	if (!context)
+		throw_openssl_error("EVP_PKEY_CTX_new");
+	check(encrypt ? EVP_PKEY_encrypt_init(context.get()) : EVP_PKEY_decrypt_init(context.get()), "RSA init");
+	check(EVP_PKEY_CTX_set_rsa_padding(context.get(), RSA_PKCS1_OAEP_PADDING), "RSA OAEP padding");
+	return context;
+}
+
+static std::string public_key_der(EVP_PKEY* key)
+{
+	int length = i2d_PUBKEY(key, nullptr);
+	check(length, "i2d_PUBKEY");
+	std::string der(static_cast<size_t>(length), '\0');
+	unsigned char* out = reinterpret_cast<unsigned char*>(&der[0]);
+	i2d_PUBKEY(key, &out);
+	return der;
+}
+
+class OpenSSLRSAPublicKey : public RSAPublicKey
+{
+public:
+	OpenSSLRSAPublicKey(const char* der, size_t length)
+	{
+		const unsigned char* in = reinterpret_cast<const unsigned char*>(der);
+		_key.reset(d2i_PUBKEY(nullptr, &in, static_cast<long>(length)));
+		if (!_key)
+			throw_openssl_error("invalid RSA public key");
+	}
+
+	std::string der() const override
+	{
+		return public_key_der(_key.get());
+	}
+
+	std::string encrypt(const char* plain, size_t length) override
+	{
+		KeyContext context = oaep_context(_key.get(), true);
+		size_t cipher_length = 0;
+		check(EVP_PKEY_encrypt(context.get(), nullptr, &cipher_length, reinterpret_cast<const unsigned char*>(plain), length), "RSA encrypt");
+		std::string cipher(cipher_length, '\0');
+		if (EVP_PKEY_encrypt(context.get(), reinterpret_cast<unsigned char*>(&cipher[0]), &cipher_length, reinterpret_cast<const unsigned char*>(plain), length) <= 0)
+		{
+			ERR_clear_error();
+			throw std::length_error("plaintext is too long for the RSA key");
+		}
+		cipher.resize(cipher_length);
+		return cipher;
+	}
+
+private:
+	Key _key;
+};
+
+class OpenSSLRSAPrivateKey : public RSAPrivateKey
+{
+public:
+	explicit OpenSSLRSAPrivateKey(EVP_PKEY* key) : _key(key) {}
+
+	std::string der() const override
+	{
+		PKCS8_PRIV_KEY_INFO* info = EVP_PKEY2PKCS8(_key.get());
+		if (!info)
+			throw_openssl_error("EVP_PKEY2PKCS8");
+		unsigned char* out = nullptr;
+		int length = i2d_PKCS8_PRIV_KEY_INFO(info, &out);
+		PKCS8_PRIV_KEY_INFO_free(info);
+		check(length, "i2d_PKCS8_PRIV_KEY_INFO");
+		std::string der(reinterpret_cast<const char*>(out), static_cast<size_t>(length));
+		OPENSSL_clear_free(out, static_cast<size_t>(length));
+		return der;
+	}
+
+	std::string public_der() const override
+	{
+		return public_key_der(_key.get());
+	}
+
+	std::string decrypt(const char* cipher, size_t length) const override
+	{
+		// A context per call keeps concurrent decryptions apart.
+		KeyContext context = oaep_context(_key.get(), false);
+		size_t plain_length = 0;
+		check(EVP_PKEY_decrypt(context.get(), nullptr, &plain_length, reinterpret_cast<const unsigned char*>(cipher), length), "RSA decrypt");
+		std::string decrypted(plain_length, '\0');
+		if (EVP_PKEY_decrypt(context.get(), reinterpret_cast<unsigned char*>(&decrypted[0]), &plain_length, reinterpret_cast<const unsigned char*>(cipher), length) <= 0)
+		{
+			ERR_clear_error();
+			throw std::runtime_error("RSA decryption failed");
+		}
+		decrypted.resize(plain_length);
+		return decrypted;
+	}
+
+private:
+	Key _key;
+};
+
+OpenSSLProvider::OpenSSLProvider()
+{
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+	// Fetched once; the implicit fetch of EVP_aes_128_*() would look them up on every init.
+	cbc_ = EVP_CIPHER_fetch(nullptr, "AES-128-CBC", nullptr);
+	gcm_ = EVP_CIPHER_fetch(nullptr, "AES-128-GCM", nullptr);
+#else
+	cbc_ = const_cast<EVP_CIPHER*>(EVP_aes_128_cbc());
+	gcm_ = const_cast<EVP_CIPHER*>(EVP_aes_128_gcm());
+#endif
+}
+
+OpenSSLProvider::~OpenSSLProvider()
+{
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+	EVP_CIPHER_free(cbc_);
+	EVP_CIPHER_free(gcm_);
+#endif
+}
+
+void OpenSSLProvider::random_bytes(unsigned char* buffer, size_t length) const
+{
+	for (size_t offset = 0; offset < length; offset += MAX_UPDATE)
+		check(RAND_bytes(buffer + offset, static_cast<int>(std::min(MAX_UPDATE, length - offset))), "RAND_bytes");
+}
+
+std::unique_ptr<AESCipher> OpenSSLProvider::aes(const unsigned char* key, size_t length) const
+{
+	if (!cbc_ || !gcm_)
+		throw std::runtime_error("OpenSSL provides no AES-128");
+	return std::unique_ptr<AESCipher>(new OpenSSLAESCipher(cbc_, gcm_, key, length));
+}
+
+std::unique_ptr<RSAPublicKey> OpenSSLProvider::rsa_public_key(const char* der, size_t length) const
+{
+	return std::unique_ptr<RSAPublicKey>(new OpenSSLRSAPublicKey(der, length));
+}
+
+std::unique_ptr<RSAPrivateKey> OpenSSLProvider::rsa_private_key(const char* der, size_t length) const
+{
+	const unsigned char* in = reinterpret_cast<const unsigned char*>(der);
+	EVP_PKEY* key = d2i_AutoPrivateKey(nullptr, &in, static_cast<long>(length));
+	if (!key)
+		throw_openssl_error("invalid RSA private key");
+	return std::unique_ptr<RSAPrivateKey>(new OpenSSLRSAPrivateKey(key));
+}
+
+std::unique_ptr<RSAPrivateKey> OpenSSLProvider::generate_rsa_private_key(unsigned int bits) const
+{
+	KeyContext context(EVP_PKEY_CTX_new_id(EVP_PKEY_RSA, nullptr));
+	if (!context)
+		throw_openssl_error("EVP_PKEY_CTX_new_id");
+	check(EVP_PKEY_keygen_init(context.get()), "RSA keygen init");
+	check(EVP_PKEY_CTX_set_rsa_keygen_bits(context.get(), static_cast<int>(bits)), "RSA key size");
+
+	// The exponent Crypto++ uses; with 65537 the public key would not fit the protocol's 160 bytes.
+	BIGNUM* exponent = BN_new();
+	if (!exponent || !BN_set_word(exponent, 17))
+	{
+		BN_free(exponent);
+		throw_openssl_error("RSA exponent");
+	}
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+	int set = EVP_PKEY_CTX_set1_rsa_keygen_pubexp(context.get(), exponent);
+	BN_free(exponent);
+#else
+	int set = EVP_PKEY_CTX_set_rsa_keygen_pubexp(context.get(), exponent);	// takes the exponent
+	if (set <= 0)
+		BN_free(exponent);
+#endif
+	check(set, "RSA exponent");
+
+	EVP_PKEY* key = nullptr;
+	check(EVP_PKEY_keygen(context.get(), &key), "RSA keygen");
+	return std::unique_ptr<RSAPrivateKey>(new OpenSSLRSAPrivateKey(key));
+}
+
+#endif
@@ -0,0 +1,51 @@
+/**
+ * @file OpenSSLProvider.h
+ * @brief Declaration of the OpenSSL EVP crypto provider for the MessageU project.
+ *
+ * Built when MESSAGEU_WITH_OPENSSL is defined; link with libcrypto (OpenSSL 1.1.1 or 3.x).
+ *
+ * @version 2.0
+ * @author Dmitriy Gorodov
+ * @id 324725405
+ * @date 16/10/2026
+ */
+
+#pragma once
+
+#ifdef MESSAGEU_WITH_OPENSSL
+
+#include "CryptoProvider.h"
+
+typedef struct evp_cipher_st EVP_CIPHER;
+
+/**
+ * @brief The OpenSSLProvider class implements the crypto primitives with OpenSSL EVP ("openssl").
+ *
+ * EVP picks the fastest AES kernels of the CPU (AES-NI, VAES) at run time. The AES ciphers are
+ * fetched once, when the provider is created; every CBC stream and GCM message then only
+ * initializes a context with the key.
+ */
+class OpenSSLProvider : public CryptoProvider
+{
+public:
+	OpenSSLProvider();
+	~OpenSSLProvider();
+
+	const char* name() const override { return "openssl"; }
+
+	void random_bytes(unsigned char* buffer, size_t length) const override;
+
+	std::unique_ptr<AESCipher> aes(const unsigned char* key, size_t length) const override;
+	std::unique_ptr<RSAPublicKey> rsa_public_key(const char* der, size_t length) const override;
+	std::unique_ptr<RSAPrivateKey> rsa_private_key(const char* der, size_t length) const override;
+	std::unique_ptr<RSAPrivateKey> generate_rsa_private_key(unsigned int bits) const override;
+
+private:
+	EVP_CIPHER* cbc_;
+	EVP_CIPHER* gcm_;
+
+	OpenSSLProvider(const OpenSSLProvider& provider);
+	OpenSSLProvider& operator=(const OpenSSLProvider& provider);
+};
+
+#endif
@@ -0,0 +1,152 @@
+/**
+ * @file PeerKeyStore.cpp
+ * @brief Implementation of the PeerKeyStore class for the MessageU project.
+ *
+ * @version 2.0
+ * @author Dmitriy Gorodov
+ * @id 342725405
+ * @date 16/10/2026
+ */
+
+#include "PeerKeyStore.h"
+#include "GCMChunkCipher.h"
+#include "utils.h"
+#include <sha.h>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+static const size_t RECORD_HEADER_SIZE = ClientId::SIZE + 1 + 4;
+
+/**
+ * @brief Upper bound on a sealed key; a larger length means the file is corrupted.
+ */
+static const uint32_t MAX_SEALED_SIZE = 64 * 1024;
+
+/**
+ * @brief Returns the associated data of a record: the peer ID followed by the kind.
+ */
+static std::string record_aad(const ClientId& peer_id, uint8_t kind)
+{
+	std::string aad(reinterpret_cast<const char*>(peer_id.data()), ClientId::SIZE);
+	aad.push_back(static_cast<char>(kind));
+	return aad;
+}
+
+PeerKeyStore::PeerKeyStore(const std::string& path)
+	: path_(path), save_failed_(false)
+{
+}
+
+void PeerKeyStore::open(const std::string& private_key)
+{
+	// The storage key is the first half of SHA-256 over a label and the private key.
+	static const char LABEL[] = "MessageU peer key store";
+	unsigned char digest[CryptoPP::SHA256::DIGESTSIZE] = {};
+	CryptoPP::SHA256 hash;
+	hash.Update(reinterpret_cast<const CryptoPP::byte*>(LABEL), sizeof(LABEL) - 1);
+	hash.Update(reinterpret_cast<const CryptoPP::byte*>(private_key.data()), private_key.size());
+	hash.Final(digest);
+	storage_key_ = std::make_shared<AESWrapper>(digest, AESWrapper::DEFAULT_KEYLENGTH);
+
+	sealed_keys_.clear();
+	std::ifstream file(path_, std::ios::binary);
+	if (!file)
+		return;
+
+	// Only the records are read here; each key is decrypted on its first lookup.
+	unsigned char header[RECORD_HEADER_SIZE];
+	while (file.read(reinterpret_cast<char*>(header), sizeof(header)))
+	{
+		ClientId peer_id(header);
+		uint8_t kind = header[ClientId::SIZE];
+		uint32_t length = 0;
+		for (int i = 3; i >= 0; i--)
+			length = (length << 8) | header[ClientId::SIZE + 1 + i];
+
+		std::string sealed;
+		if (length <= MAX_SEALED_SIZE)
+			sealed.resize(length);
+		if (length > MAX_SEALED_SIZE || !file.read(&sealed[0], length))
+		{
+			std::cerr << "Warning: " << path_ << " is damaged; the keys after the last complete record must be exchanged again.\n";
+			break;
+		}
+		sealed_keys_[peer_id][kind] = std::move(sealed);
+	}
+}
+
+bool PeerKeyStore::find(const ClientId& peer_id, Kind kind, std::string* key)
+{
+	auto peer = sealed_keys_.find(peer_id);
+	if (!storage_key_ || peer == sealed_keys_.end())
+		return false;
+	auto sealed = peer->second.find(kind);
+	if (sealed == peer->second.end())
+		return false;
+
+	try
+	{
+		GCMChunkDecryptor decryptor(storage_key_, nullptr, 1, record_aad(peer_id, kind));
+		std::string plain;
+		decryptor.update(sealed->second.data(), sealed->second.size(), *key);
+		decryptor.finish(plain);
+		key->append(plain);
+		return true;
+	}
+	catch (const std::exception&)
+	{
+		// Sealed under another identity, or damaged; the key has to be exchanged again.
+		peer->second.erase(sealed);
+		if (peer->second.empty())
+			sealed_keys_.erase(peer);
+		save();
+		return false;
+	}
+}
+
+void PeerKeyStore::put(const ClientId& peer_id, Kind kind, const std::string& key)
+{
+	if (!storage_key_)
+		return;
+
+	GCMChunkEncryptor encryptor(storage_key_, nullptr, GCMChunk::DEFAULT_CHUNK_SIZE, record_aad(peer_id, kind));
+	std::string sealed;
+	encryptor.encrypt(key.data(), key.size(), true, sealed);
+	sealed_keys_[peer_id][kind] = std::move(sealed);
+	save();
+}
+
+void PeerKeyStore::save()
+{
+	std::error_code error;
+	if (sealed_keys_.empty())
+	{
+		std::filesystem::remove(path_, error);
+		return;
+	}
+
+	std::ostringstream records;
+	for (const auto& peer : sealed_keys_)
+	{
+		for (const auto& sealed : peer.second)
+		{
+			unsigned char header[RECORD_HEADER_SIZE];
+			std::memcpy(header, peer.first.data(), ClientId::SIZE);
+			header[ClientId::SIZE] = sealed.first;
+			uint32_t length = static_cast<uint32_t>(sealed.second.size());
+			for (int i = 0; i < 4; i++)
+				header[ClientId::SIZE + 1 + i] = static_cast<unsigned char>(length >> (8 * i));
+			records.write(reinterpret_cast<const char*>(header), sizeof(header));
+			records << sealed.second;
+		}
+	}
+
+	bool saved = write_file_atomically(path_, records.str());
+	if (!saved && !save_failed_)
+		std::cerr << "Warning: unable to save the peer keys to " << path_ << "; they will have to be exchanged again after a restart.\n";
+	save_failed_ = !saved;
+}
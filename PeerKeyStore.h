@@ -0,0 +1,99 @@
+/**
+ * @file PeerKeyStore.h
+ * @brief Declaration of the PeerKeyStore class for the MessageU project.
+ *
+ * The peer key store keeps the public keys and symmetric keys of the client's peers on disk,
+ * so that a restarted client can message them without fetching and exchanging keys again.
+ *
+ * File layout ("peers.keys", next to "my.info"), a sequence of records:
+ *   peer ID (16 bytes) | kind (1) | sealed length (4 bytes, little endian) | sealed key
+ * The sealed key is the key in the chunked AES-GCM format (GCMChunkCipher.h). Its associated
+ * data is the peer ID and the kind, so a record cannot be moved to another peer. The storage
+ * key is derived from the client's private key, so the store is only readable with my.info.
+ *
+ * @version 2.0
+ * @author Dmitriy Gorodov
+ * @id 324725405
+ * @date 16/10/2026
+ */
+
+#pragma once
+
+#include "AESWrapper.h"
+#include "ClientId.h"
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+/**
+ * @brief The PeerKeyStore class keeps the peers' keys encrypted in a file.
+ *
+ * Opening the store reads the sealed records and indexes them by peer ID; a key is decrypted
+ * only when it is first looked up, so startup time does not depend on the number of peers.
+ * The file is rewritten through a temporary file and a rename after every change.
+ */
+class PeerKeyStore
+{
+public:
+	/**
+	 * @brief The kinds of keys kept for a peer.
+	 */
+	enum Kind : uint8_t
+	{
+		PUBLIC_KEY = 1,
+		SYMMETRIC_KEY = 2
+	};
+
+	explicit PeerKeyStore(const std::string& path);
+
+	/**
+	 * @brief Reads the store, sealed with a key derived from the client's private key.
+	 * @param private_key The client's private key (binary, as in my.info once decoded).
+	 */
+	void open(const std::string& private_key);
+
+	/**
+	 * @brief Returns true once the store has been opened.
+	 */
+	bool is_open() const { return static_cast<bool>(storage_key_); }
+
+	/**
+	 * @brief Returns the key the store is sealed with, which also seals the client's other local
+	 *        files (the message history and its search index), or nullptr before open().
+	 */
+	std::shared_ptr<const AESWrapper> storage_key() const { return storage_key_; }
+
+	/**
+	 * @brief Decrypts a stored key of a peer.
+	 *
+	 * A record that fails authentication (e.g. sealed under an earlier registration) is dropped.
+	 * @param key Receives the key.
+	 * @return false if the store holds no usable key of that kind for the peer.
+	 */
+	bool find(const ClientId& peer_id, Kind kind, std::string* key);
+
+	/**
+	 * @brief Stores a key of a peer, replacing any earlier key of that kind.
+	 */
+	void put(const ClientId& peer_id, Kind kind, const std::string& key);
+
+	/**
+	 * @brief Returns the number of peers with at least one stored key.
+	 */
+	size_t size() const { return sealed_keys_.size(); }
+
+private:
+	std::string path_;
+	std::shared_ptr<AESWrapper> storage_key_;
+	bool save_failed_;
+
+	/**
+	 * @brief The sealed keys of every peer, by peer ID and kind.
+	 */
+	std::unordered_map<ClientId, std::unordered_map<uint8_t, std::string>, ClientIdHash> sealed_keys_;
+
+	/**
+	 * @brief Rewrites the file with the current records.
+	 */
+	void save();
+};
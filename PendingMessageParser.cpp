@@ -0,0 +1,87 @@
+/**
+ * @file PendingMessageParser.cpp
+ * @brief Implementation of the PendingMessageParser class for the MessageU project.
+ *
+ * The parser alternates between collecting a 25-byte record header and passing through the
+ * content bytes announced by that header.
+ *
+ * @version 2.0
+ * @author Dmitriy Gorodov
+ * @id 342725405
+ * @date 16/10/2026
+ */
+
+#include "PendingMessageParser.h"
+#include <algorithm>
+#include <cstring>
+
+PendingMessageParser::PendingMessageParser(RecordBeginCallback on_record_begin, ContentCallback on_content, RecordEndCallback on_record_end)
+	: on_record_begin_(std::move(on_record_begin)), on_content_(std::move(on_content)), on_record_end_(std::move(on_record_end)),
+	header_buffer_(), header_filled_(0), in_content_(false), content_remaining_(0)
+{
+}
+
+void PendingMessageParser::feed(const uint8_t* data, size_t length)
+{
+	while (length > 0)
+	{
+		if (!in_content_)
+		{
+			size_t header_bytes = std::min(length, RECORD_HEADER_SIZE - header_filled_);
+			memcpy(header_buffer_.data() + header_filled_, data, header_bytes);
+			header_filled_ += header_bytes;
+			data += header_bytes;
+			length -= header_bytes;
+
+			if (header_filled_ == RECORD_HEADER_SIZE)
+				begin_record();
+			continue;
+		}
+
+		size_t content_bytes = static_cast<size_t>(std::min<uint64_t>(length, content_remaining_));
+		on_content_(data, content_bytes);
+		content_remaining_ -= static_cast<uint32_t>(content_bytes);
+		data += content_bytes;
+		length -= content_bytes;
+
+		if (content_remaining_ == 0)
+			end_record();
+	}
+}
+
+bool PendingMessageParser::in_record() const
+{
+	return in_content_ || header_filled_ > 0;
+}
+
+void PendingMessageParser::begin_record()
+{
+	PendingMessageHeader header;
+	size_t offset = 0;
+
+	header.sender_id = ClientId(header_buffer_.data());
+	offset += MAX_CLIENT_ID_SIZE;
+
+	memcpy(&header.message_id, header_buffer_.data() + offset, MAX_MESSAGE_ID_BYTES);
+	offset += MAX_MESSAGE_ID_BYTES;
+
+	header.message_type = header_buffer_[offset];
+	offset += MAX_MESSAGE_TYPE_BYTES;
+
+	memcpy(&header.content_size, header_buffer_.data() + offset, MAX_MESSAGE_CONTENT_BYTES);
+
+	header_filled_ = 0;
+	in_content_ = true;
+	content_remaining_ = header.content_size;
+
+	on_record_begin_(header);
+
+	if (content_remaining_ == 0)
+		end_record();
+}
+
+void PendingMessageParser::end_record()
+{
+	in_content_ = false;
+	on_record_end_();
+}
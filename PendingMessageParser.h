@@ -0,0 +1,83 @@
+/**
+ * @file PendingMessageParser.h
+ * @brief Declaration of the PendingMessageParser class for the MessageU project.
+ *
+ * This header defines an incremental parser for the payload of a pending messages response.
+ * Bytes can be fed in arbitrary pieces as they arrive from the socket.
+ *
+ * @version 2.0
+ * @author Dmitriy Gorodov
+ * @id 324725405
+ * @date 16/10/2026
+ */
+
+#pragma once
+
+#include "ClientId.h"
+#include "utils.h"
+#include <array>
+#include <cstdint>
+#include <functional>
+
+/**
+ * @brief Structure representing the fixed-size header of a pending message record.
+ */
+struct PendingMessageHeader
+{
+	ClientId sender_id;
+	uint32_t message_id;
+	uint8_t message_type;
+	uint32_t content_size;
+};
+
+/**
+ * @brief The PendingMessageParser class decodes pending message records as their bytes arrive.
+ *
+ * For every record it reports the header as soon as the header is complete, then the content
+ * in the pieces it arrives in, then the end of the record. Nothing is buffered beyond the
+ * record header, so memory use does not depend on the size of the backlog.
+ */
+class PendingMessageParser
+{
+public:
+	static const size_t RECORD_HEADER_SIZE = MAX_CLIENT_ID_SIZE + MAX_MESSAGE_ID_BYTES + MAX_MESSAGE_TYPE_BYTES + MAX_MESSAGE_CONTENT_BYTES;
+
+	typedef std::function<void(const PendingMessageHeader& header)> RecordBeginCallback;
+	typedef std::function<void(const uint8_t* content, size_t length)> ContentCallback;
+	typedef std::function<void()> RecordEndCallback;
+
+	/**
+	 * @brief Constructs a parser.
+	 * @param on_record_begin Called when a record header has been decoded.
+	 * @param on_content Called with every piece of the current record's content.
+	 * @param on_record_end Called when the current record's content is complete.
+	 */
+	PendingMessageParser(RecordBeginCallback on_record_begin, ContentCallback on_content, RecordEndCallback on_record_end);
+
+	/**
+	 * @brief Feeds the next bytes of the response payload to the parser.
+	 * @param data The bytes.
+	 * @param length The number of bytes.
+	 */
+	void feed(const uint8_t* data, size_t length);
+
+	/**
+	 * @brief Returns true if the parser is in the middle of a record.
+	 *
+	 * After the whole payload has been fed, this means the payload was truncated.
+	 */
+	bool in_record() const;
+
+private:
+	RecordBeginCallback on_record_begin_;
+	ContentCallback on_content_;
+	RecordEndCallback on_record_end_;
+
+	std::array<uint8_t, RECORD_HEADER_SIZE> header_buffer_;
+	size_t header_filled_;
+	bool in_content_;
+	uint32_t content_remaining_;
+
+	void begin_record();
+	void end_record();
+};
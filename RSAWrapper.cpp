@@ -12,17 +12,28 @@
 */
 
 #include "RSAWrapper.h"
+#include "Tracer.h"
+
+#include <algorithm>
+
+/**
+ * @brief Copies a DER key into a caller's buffer, truncating it to the buffer's length.
+ */
+static char* copy_key(const std::string& key, char* keyout, unsigned int length)
+{
+	std::copy_n(key.data(), std::min<size_t>(key.size(), length), keyout);
+	return keyout;
+}
 
 RSAPublicWrapper::RSAPublicWrapper(const char* key, unsigned int length)
 {
-	CryptoPP::StringSource ss(reinterpret_cast<const CryptoPP::byte*>(key), length, true);
-	_publicKey.Load(ss);
+	TRACE_SCOPE("RSAPublicWrapper::load", "rsa");
+	_publicKey = CryptoProvider::current().rsa_public_key(key, length);
 }
 
 RSAPublicWrapper::RSAPublicWrapper(const std::string& key)
 {
-	CryptoPP::StringSource ss(key, true);
-	_publicKey.Load(ss);
+	_publicKey = CryptoProvider::current().rsa_public_key(key.data(), key.size());
 }
 
 RSAPublicWrapper::~RSAPublicWrapper()
@@ -31,52 +42,42 @@ RSAPublicWrapper::~RSAPublicWrapper()
 
 std::string RSAPublicWrapper::getPublicKey() const
 {
-	std::string key;
-	CryptoPP::StringSink ss(key);
-	_publicKey.Save(ss);
-	return key;
+	return _publicKey->der();
 }
 
 char* RSAPublicWrapper::getPublicKey(char* keyout, unsigned int length) const
 {
-	CryptoPP::ArraySink as(reinterpret_cast<CryptoPP::byte*>(keyout), length);
-	_publicKey.Save(as);
-	return keyout;
+	return copy_key(_publicKey->der(), keyout, length);
 }
 
 std::string RSAPublicWrapper::encrypt(const std::string& plain)
 {
-	std::string cipher;
-	CryptoPP::RSAES_OAEP_SHA_Encryptor e(_publicKey);
-	CryptoPP::StringSource ss(plain, true, new CryptoPP::PK_EncryptorFilter(_rng, e, new CryptoPP::StringSink(cipher)));
-	return cipher;
+	return encrypt(plain.data(), static_cast<unsigned int>(plain.size()));
 }
 
 std::string RSAPublicWrapper::encrypt(const char* plain, unsigned int length)
 {
-	std::string cipher;
-	CryptoPP::RSAES_OAEP_SHA_Encryptor e(_publicKey);
-	CryptoPP::StringSource ss(reinterpret_cast<const CryptoPP::byte*>(plain), length, true, new CryptoPP::PK_EncryptorFilter(_rng, e, new CryptoPP::StringSink(cipher)));
-	return cipher;
+	TRACE_SCOPE("RSAPublicWrapper::encrypt", "rsa");
+	return _publicKey->encrypt(plain, length);
 }
 
 
 
 RSAPrivateWrapper::RSAPrivateWrapper()
 {
-	_privateKey.Initialize(_rng, BITS);
+	TRACE_SCOPE("RSAPrivateWrapper::generate", "rsa");
+	_privateKey = CryptoProvider::current().generate_rsa_private_key(BITS);
 }
 
 RSAPrivateWrapper::RSAPrivateWrapper(const char* key, unsigned int length)
 {
-	CryptoPP::StringSource ss(reinterpret_cast<const CryptoPP::byte*>(key), length, true);
-	_privateKey.Load(ss);
+	TRACE_SCOPE("RSAPrivateWrapper::load", "rsa");
+	_privateKey = CryptoProvider::current().rsa_private_key(key, length);
 }
 
 RSAPrivateWrapper::RSAPrivateWrapper(const std::string& key)
 {
-	CryptoPP::StringSource ss(key, true);
-	_privateKey.Load(ss);
+	_privateKey = CryptoProvider::current().rsa_private_key(key.data(), key.size());
 }
 
 RSAPrivateWrapper::~RSAPrivateWrapper()
@@ -85,48 +86,31 @@ RSAPrivateWrapper::~RSAPrivateWrapper()
 
 std::string RSAPrivateWrapper::getPrivateKey() const
 {
-	std::string key;
-	CryptoPP::StringSink ss(key);
-	_privateKey.Save(ss);
-	return key;
+	return _privateKey->der();
 }
 
 char* RSAPrivateWrapper::getPrivateKey(char* keyout, unsigned int length) const
 {
-	CryptoPP::ArraySink as(reinterpret_cast<CryptoPP::byte*>(keyout), length);
-	_privateKey.Save(as);
-	return keyout;
+	return copy_key(_privateKey->der(), keyout, length);
 }
 
 std::string RSAPrivateWrapper::getPublicKey() const
 {
-	CryptoPP::RSAFunction publicKey(_privateKey);
-	std::string key;
-	CryptoPP::StringSink ss(key);
-	publicKey.Save(ss);
-	return key;
+	return _privateKey->public_der();
 }
 
 char* RSAPrivateWrapper::getPublicKey(char* keyout, unsigned int length) const
 {
-	CryptoPP::RSAFunction publicKey(_privateKey);
-	CryptoPP::ArraySink as(reinterpret_cast<CryptoPP::byte*>(keyout), length);
-	publicKey.Save(as);
-	return keyout;
+	return copy_key(_privateKey->public_der(), keyout, length);
 }
 
-std::string RSAPrivateWrapper::decrypt(const std::string& cipher)
+std::string RSAPrivateWrapper::decrypt(const std::string& cipher) const
 {
-	std::string decrypted;
-	CryptoPP::RSAES_OAEP_SHA_Decryptor d(_privateKey);
-	CryptoPP::StringSource ss_cipher(cipher, true, new CryptoPP::PK_DecryptorFilter(_rng, d, new CryptoPP::StringSink(decrypted)));
-	return decrypted;
+	return decrypt(cipher.data(), static_cast<unsigned int>(cipher.size()));
 }
 
-std::string RSAPrivateWrapper::decrypt(const char* cipher, unsigned int length)
+std::string RSAPrivateWrapper::decrypt(const char* cipher, unsigned int length) const
 {
-	std::string decrypted;
-	CryptoPP::RSAES_OAEP_SHA_Decryptor d(_privateKey);
-	CryptoPP::StringSource ss_cipher(reinterpret_cast<const CryptoPP::byte*>(cipher), length, true, new CryptoPP::PK_DecryptorFilter(_rng, d, new CryptoPP::StringSink(decrypted)));
-	return decrypted;
+	TRACE_SCOPE("RSAPrivateWrapper::decrypt", "rsa");
+	return _privateKey->decrypt(cipher, length);
 }
\ No newline at end of file
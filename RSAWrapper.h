@@ -13,9 +13,9 @@
 
 #pragma once
 
-#include <osrng.h>
-#include <rsa.h>
+#include "CryptoProvider.h"
 
+#include <memory>
 #include <string>
 
 
@@ -26,8 +26,7 @@ public:
 	static const unsigned int BITS = 1024;
 
 private:
-	CryptoPP::AutoSeededRandomPool _rng;
-	CryptoPP::RSA::PublicKey _publicKey;
+	std::unique_ptr<RSAPublicKey> _publicKey;	// from the CryptoProvider current at construction
 
 	RSAPublicWrapper(const RSAPublicWrapper& rsapublic);
 	RSAPublicWrapper& operator=(const RSAPublicWrapper& rsapublic);
@@ -51,8 +50,7 @@ public:
 	static const unsigned int BITS = 1024;
 
 private:
-	CryptoPP::AutoSeededRandomPool _rng;
-	CryptoPP::RSA::PrivateKey _privateKey;
+	std::unique_ptr<RSAPrivateKey> _privateKey;	// from the CryptoProvider current at construction
 
 	RSAPrivateWrapper(const RSAPrivateWrapper& rsaprivate);
 	RSAPrivateWrapper& operator=(const RSAPrivateWrapper& rsaprivate);
@@ -68,6 +66,9 @@ public:
 	std::string getPublicKey() const;
 	char* getPublicKey(char* keyout, unsigned int length) const;
 
-	std::string decrypt(const std::string& cipher);
-	std::string decrypt(const char* cipher, unsigned int length);
+	/**
+	 * @brief Decrypts with OAEP-SHA1. Several threads may call this at once.
+	 */
+	std::string decrypt(const std::string& cipher) const;
+	std::string decrypt(const char* cipher, unsigned int length) const;
 };
\ No newline at end of file
@@ -11,34 +11,44 @@
  * @date 19/03/2025
  */
 
+#include <cstring>
 #include <stdexcept>
 #include "RequestBuilder.h"
+#include "Tracer.h"
 #include "utils.h"
 
 RequestBuilder::RequestBuilder() {}
 
-const std::vector<uint8_t> RequestBuilder::pack_header(const RequestHeader &header)
+std::array<boost::asio::const_buffer, 2> GatherRequest::buffers() const
 {
-	std::vector<uint8_t> header_buffer;
-	if (header.client_id.size() != MAX_CLIENT_ID_SIZE)
-		throw std::runtime_error("Client ID must be bytes");
+	return { boost::asio::buffer(head), content };
+}
 
-	header_buffer.insert(header_buffer.end(), header.client_id.begin(), header.client_id.end());
-	header_buffer.push_back(header.version);
+const std::vector<uint8_t> RequestBuilder::pack_header(const RequestHeader &header)
+{
+	std::vector<uint8_t> header_buffer(REQUEST_HEADER_SIZE);
+	pack_header(header, header_buffer.data());
+	return header_buffer;
+}
 
-	header_buffer.push_back(static_cast<uint8_t>(header.code & 0xFF));
-	header_buffer.push_back(static_cast<uint8_t>((header.code >> 8) & 0xFF));
+void RequestBuilder::pack_header(const RequestHeader& header, uint8_t* header_buffer)
+{
+	memcpy(header_buffer, header.client_id.data(), MAX_CLIENT_ID_SIZE);
+	header_buffer += MAX_CLIENT_ID_SIZE;
+	*header_buffer++ = header.version;
 
-	header_buffer.push_back(static_cast<uint8_t>(header.payload_size & 0xFF));
-	header_buffer.push_back(static_cast<uint8_t>(header.payload_size >> 8) & 0xFF);
-	header_buffer.push_back(static_cast<uint8_t>(header.payload_size >> 16) & 0xFF);
-	header_buffer.push_back(static_cast<uint8_t>(header.payload_size >> 24) & 0xFF);
+	*header_buffer++ = static_cast<uint8_t>(header.code & 0xFF);
+	*header_buffer++ = static_cast<uint8_t>((header.code >> 8) & 0xFF);
 
-	return header_buffer;
+	*header_buffer++ = static_cast<uint8_t>(header.payload_size & 0xFF);
+	*header_buffer++ = static_cast<uint8_t>((header.payload_size >> 8) & 0xFF);
+	*header_buffer++ = static_cast<uint8_t>((header.payload_size >> 16) & 0xFF);
+	*header_buffer++ = static_cast<uint8_t>((header.payload_size >> 24) & 0xFF);
 }
 
 const std::vector<uint8_t> RequestBuilder::build_registration_request(const std::string& client_name, const std::vector<uint8_t>& public_key)
 {
+	TRACE_SCOPE("RequestBuilder::build_registration_request", "protocol");
 	std::vector<uint8_t> payload;
 
 	std::vector<uint8_t> client_name_bytes(client_name.begin(), client_name.end());
@@ -60,7 +70,7 @@ const std::vector<uint8_t> RequestBuilder::build_registration_request(const std:
 	std::vector<uint8_t> header = pack_header(
 		RequestHeader
 		{
-			std::vector<uint8_t>(MAX_CLIENT_ID_SIZE, 0),
+			ClientId(),
 			static_cast<uint8_t>(CLIENT_VERSION),
 			static_cast<uint16_t>(RequestCode::REGISTER_CLIENT),
 			payload_size
@@ -73,8 +83,9 @@ const std::vector<uint8_t> RequestBuilder::build_registration_request(const std:
 	return request;
 }
 
-const std::vector<uint8_t> RequestBuilder::build_client_list_request(const std::vector<uint8_t> &client_id)
+const std::vector<uint8_t> RequestBuilder::build_client_list_request(const ClientId& client_id)
 {
+	TRACE_SCOPE("RequestBuilder::build_client_list_request", "protocol");
 	std::vector<uint8_t> header = pack_header(
 		RequestHeader
 		{
@@ -88,11 +99,12 @@ const std::vector<uint8_t> RequestBuilder::build_client_list_request(const std::
 	return header;
 }
 
-const std::vector<uint8_t> RequestBuilder::build_public_key_request(const std::vector<uint8_t>& client_id, const std::vector<uint8_t>& target_id)
+const std::vector<uint8_t> RequestBuilder::build_public_key_request(const ClientId& client_id, const ClientId& target_id)
 {
+	TRACE_SCOPE("RequestBuilder::build_public_key_request", "protocol");
 	std::vector<uint8_t> payload;
 
-	payload.insert(payload.end(), target_id.begin(), target_id.end());
+	payload.insert(payload.end(), target_id.data(), target_id.data() + ClientId::SIZE);
 
 	uint32_t payload_size = static_cast<uint32_t>(payload.size());
 
@@ -112,8 +124,9 @@ const std::vector<uint8_t> RequestBuilder::build_public_key_request(const std::v
 	return request;
 }
 
-const std::vector<uint8_t> RequestBuilder::build_pending_messages_request(const std::vector<uint8_t>& client_id)
+const std::vector<uint8_t> RequestBuilder::build_pending_messages_request(const ClientId& client_id)
 {
+	TRACE_SCOPE("RequestBuilder::build_pending_messages_request", "protocol");
 	std::vector<uint8_t> header = pack_header(
 		RequestHeader
 		{
@@ -126,35 +139,54 @@ const std::vector<uint8_t> RequestBuilder::build_pending_messages_request(const
 	return header;
 }
 
-const std::vector<uint8_t> RequestBuilder::build_send_message_request(const std::vector<uint8_t> client_id, const std::vector<uint8_t> target_id, const uint8_t message_type, const std::string encrypted_message_content)
+const std::vector<uint8_t> RequestBuilder::build_send_message_request(const ClientId& client_id, const ClientId& target_id, const uint8_t message_type, const std::string& encrypted_message_content)
 {
-	std::vector<uint8_t> message_content_bytes(encrypted_message_content.begin(), encrypted_message_content.end());
-	uint32_t content_size = static_cast<uint32_t>(message_content_bytes.size());
+	TRACE_SCOPE("RequestBuilder::build_send_message_request", "protocol");
+	GatherRequest gathered = build_send_message_gather(client_id, target_id, message_type, boost::asio::buffer(encrypted_message_content));
 
-	std::vector<uint8_t> payload;
+	std::vector<uint8_t> request;
+	request.reserve(gathered.head.size() + encrypted_message_content.size());
+	request.insert(request.end(), gathered.head.begin(), gathered.head.end());
+	request.insert(request.end(), encrypted_message_content.begin(), encrypted_message_content.end());
+
+	return request;
+}
 
-	payload.insert(payload.end(), target_id.begin(), target_id.end());
-	payload.push_back(message_type);
+GatherRequest RequestBuilder::build_send_message_gather(const ClientId& client_id, const ClientId& target_id, const uint8_t message_type, boost::asio::const_buffer message_content)
+{
+	TRACE_SCOPE("RequestBuilder::build_send_message_gather", "protocol");
+	if (message_content.size() > MAX_SEND_CONTENT_SIZE)
+		throw std::length_error("Message content is too large");
 
-	uint8_t content_size_bytes[MAX_MESSAGE_CONTENT_BYTES];
-	memcpy(content_size_bytes, &content_size, MAX_MESSAGE_CONTENT_BYTES);
-	payload.insert(payload.end(), content_size_bytes, content_size_bytes + MAX_MESSAGE_CONTENT_BYTES);
-	payload.insert(payload.end(), message_content_bytes.begin(), message_content_bytes.end());
+	GatherRequest request = build_send_message_head(client_id, target_id, message_type, static_cast<uint32_t>(message_content.size()));
+	request.content = message_content;
+	return request;
+}
 
-	uint32_t payload_size = static_cast<uint32_t>(payload.size());
+GatherRequest RequestBuilder::build_send_message_head(const ClientId& client_id, const ClientId& target_id, const uint8_t message_type, const uint32_t content_size)
+{
+	TRACE_SCOPE("RequestBuilder::build_send_message_head", "protocol");
+	if (content_size > MAX_SEND_CONTENT_SIZE)
+		throw std::length_error("Message content is too large");
 
-	std::vector<uint8_t> header = pack_header(
+	GatherRequest request;
+
+	pack_header(
 		RequestHeader
 		{
 			client_id,
 			static_cast<uint8_t>(CLIENT_VERSION),
 			static_cast<uint16_t>(RequestCode::SEND_MESSAGE),
-			payload_size
-		}
+			SEND_MESSAGE_HEAD_SIZE + content_size
+		},
+		request.head.data()
 	);
 
-	std::vector<uint8_t> request(header);
-	request.insert(request.end(), payload.begin(), payload.end());
+	uint8_t* message_head = request.head.data() + REQUEST_HEADER_SIZE;
+	memcpy(message_head, target_id.data(), MAX_CLIENT_ID_SIZE);
+	message_head += MAX_CLIENT_ID_SIZE;
+	*message_head++ = message_type;
+	memcpy(message_head, &content_size, MAX_MESSAGE_CONTENT_BYTES);
 
 	return request;
-}
\ No newline at end of file
+}
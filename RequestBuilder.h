@@ -13,20 +13,40 @@
 
 #pragma once 
 
+#include "ClientId.h"
 #include "utils.h"
+#include <array>
 #include <cstdint>
+#include <boost/asio/buffer.hpp>
 
 /**
  * @brief Structure representing a request header.
  */
 struct RequestHeader
 {
-	std::vector<uint8_t> client_id;
+	ClientId client_id;
 	uint8_t version;
 	uint16_t code;
 	uint32_t payload_size;
 };
 
+/**
+ * @brief A send message request serialized as a fixed header block plus a view of the content.
+ *
+ * The content is not copied. The memory it refers to must stay alive and unchanged until the
+ * request has been written.
+ */
+struct GatherRequest
+{
+	std::array<uint8_t, REQUEST_HEADER_SIZE + SEND_MESSAGE_HEAD_SIZE> head;
+	boost::asio::const_buffer content;
+
+	/**
+	 * @brief Returns the buffer sequence to pass to a single gathered write.
+	 */
+	std::array<boost::asio::const_buffer, 2> buffers() const;
+};
+
 /**
  * @brief The RequestBuilder class encapsulates functionality for building requests.
  */
@@ -48,7 +68,7 @@ public:
 	 * @param client_id The client's unique identifier.
 	 * @return A vector of bytes representing the request.
 	 */
-	const std::vector<uint8_t> build_client_list_request(const std::vector<uint8_t> &client_id);
+	const std::vector<uint8_t> build_client_list_request(const ClientId& client_id);
 	
 	/**
 	 * @brief Builds a public key request.
@@ -56,14 +76,14 @@ public:
 	 * @param target_id The target client's unique identifier.
 	 * @return A vector of bytes representing the request.
 	 */
-	const std::vector<uint8_t> build_public_key_request(const std::vector<uint8_t>& client_id, const std::vector<uint8_t> &target_id);
+	const std::vector<uint8_t> build_public_key_request(const ClientId& client_id, const ClientId& target_id);
 	
 	/**
 	 * @brief Builds a pending messages request.
 	 * @param client_id The client's unique identifier.
 	 * @return A vector of bytes representing the request.
 	 */
-	const std::vector<uint8_t> build_pending_messages_request(const std::vector<uint8_t>& client_id);
+	const std::vector<uint8_t> build_pending_messages_request(const ClientId& client_id);
 	
 	/**
 	 * @brief Builds a send message request.
@@ -73,12 +93,42 @@ public:
 	 * @param message_content The encrypted message content.
 	 * @return A vector of bytes representing the request.
 	 */
-	const std::vector<uint8_t> build_send_message_request(const std::vector<uint8_t> client_id, const std::vector<uint8_t> client_target_id, const uint8_t message_type, const std::string message_content);
-	
+	const std::vector<uint8_t> build_send_message_request(const ClientId& client_id, const ClientId& target_id, const uint8_t message_type, const std::string& message_content);
+
+	/**
+	 * @brief Builds a send message request without copying the message content.
+	 * @param client_id The sender's client ID.
+	 * @param target_id The target client's ID.
+	 * @param message_type The type of the message.
+	 * @param message_content View of the encrypted message content.
+	 * @return The header block and the content view, ready for a gathered write.
+	 */
+	GatherRequest build_send_message_gather(const ClientId& client_id, const ClientId& target_id, const uint8_t message_type, boost::asio::const_buffer message_content);
+
+	/**
+	 * @brief Builds the head of a send message request, without the message content.
+	 *
+	 * The returned request has an empty content view. The caller streams exactly content_size
+	 * bytes of content after writing it.
+	 * @param client_id The sender's client ID.
+	 * @param target_id The target client's ID.
+	 * @param message_type The type of the message.
+	 * @param content_size The size of the encrypted content that will follow.
+	 * @return The request header and the message header.
+	 */
+	GatherRequest build_send_message_head(const ClientId& client_id, const ClientId& target_id, const uint8_t message_type, const uint32_t content_size);
+
 	/**
 	 * @brief Packs the request header into a vector of bytes.
 	 * @param header The RequestHeader structure.
 	 * @return A vector of bytes representing the packed header.
 	 */
 	const std::vector<uint8_t> pack_header(const RequestHeader &header);
+
+	/**
+	 * @brief Packs the request header into a caller-provided buffer.
+	 * @param header The RequestHeader structure.
+	 * @param header_buffer Destination of at least REQUEST_HEADER_SIZE bytes.
+	 */
+	void pack_header(const RequestHeader& header, uint8_t* header_buffer);
 };
\ No newline at end of file
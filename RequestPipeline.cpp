@@ -0,0 +1,201 @@
+/**
+ * @file RequestPipeline.cpp
+ * @brief Implementation of the RequestPipeline class for the MessageU project.
+ *
+ * Writes are serialized through a single outstanding async_write, and a single read loop
+ * consumes responses for as long as there are requests in flight.
+ *
+ * @version 2.0
+ * @author Dmitriy Gorodov
+ * @id 342725405
+ * @date 16/10/2026
+ */
+
+#include "RequestPipeline.h"
+
+RequestPipeline::RequestPipeline(boost::asio::ip::tcp::socket& socket, size_t max_in_flight)
+	: socket_(socket), max_in_flight_(max_in_flight), writing_request_(), writing_(false), reading_(false), failed_(false), response_header_raw_(), response_header_()
+{
+}
+
+void RequestPipeline::submit(std::vector<uint8_t> request, ResponseCallback on_response)
+{
+	enqueue(PendingRequest{ std::move(request), GatherRequest(), std::move(on_response) });
+}
+
+void RequestPipeline::submit(const GatherRequest& request, ResponseCallback on_response)
+{
+	enqueue(PendingRequest{ std::vector<uint8_t>(), request, std::move(on_response) });
+}
+
+void RequestPipeline::wait()
+{
+	auto& io_context = static_cast<boost::asio::io_context&>(socket_.get_executor().context());
+	io_context.restart();
+	io_context.run();
+}
+
+size_t RequestPipeline::pending() const
+{
+	return queued_.size() + in_flight_.size();
+}
+
+std::chrono::steady_clock::time_point RequestPipeline::written_at() const
+{
+	return answered_written_at_;
+}
+
+const std::string& RequestPipeline::last_error() const
+{
+	return last_error_;
+}
+
+void RequestPipeline::clear_error()
+{
+	last_error_.clear();
+	failed_ = false;
+}
+
+void RequestPipeline::enqueue(PendingRequest request)
+{
+	if (failed_)
+	{
+		// The socket is dead; fail the request from the executor, like the ones fail() completed.
+		ResponseCallback on_response = std::move(request.on_response);
+		boost::asio::post(socket_.get_executor(), [on_response]()
+			{
+				ResponseHeader empty_header{};
+				std::vector<uint8_t> empty_payload;
+				on_response(false, empty_header, empty_payload);
+			});
+		return;
+	}
+
+	queued_.push_back(std::move(request));
+	start_write();
+}
+
+void RequestPipeline::start_write()
+{
+	if (writing_ || queued_.empty() || in_flight_.size() >= max_in_flight_)
+		return;
+
+	writing_ = true;
+	writing_request_ = std::move(queued_.front());
+	in_flight_.push_back(InFlightRequest{ std::move(writing_request_.on_response), std::chrono::steady_clock::time_point() });
+	queued_.pop_front();
+
+	std::array<boost::asio::const_buffer, 2> buffers = writing_request_.request.empty()
+		? writing_request_.gathered.buffers()
+		: std::array<boost::asio::const_buffer, 2>{ boost::asio::buffer(writing_request_.request), boost::asio::const_buffer() };
+
+	boost::asio::async_write(socket_, buffers,
+		[this](const boost::system::error_code& error, size_t)
+		{
+			writing_ = false;
+			if (error)
+			{
+				fail(error);
+				return;
+			}
+
+			// Requests enter in_flight_ only when a write starts, so the newest one is this one,
+			// unless it has already been answered and everything before it with it.
+			if (!in_flight_.empty())
+				in_flight_.back().written_at = std::chrono::steady_clock::now();
+			start_write();
+		});
+
+	start_read();
+}
+
+void RequestPipeline::start_read()
+{
+	if (reading_ || in_flight_.empty())
+		return;
+
+	reading_ = true;
+	boost::asio::async_read(socket_, boost::asio::buffer(response_header_raw_),
+		[this](const boost::system::error_code& error, size_t)
+		{
+			if (failed_ || error)
+			{
+				reading_ = false;
+				if (!failed_)
+					fail(error);
+				return;
+			}
+
+			ResponseHandler response_handler;
+			response_header_ = response_handler.get_response_header(response_header_raw_);
+			response_payload_.resize(response_header_.payload_size);
+
+			if (response_header_.payload_size > 0)
+				read_payload();
+			else
+				complete();
+		});
+}
+
+void RequestPipeline::read_payload()
+{
+	boost::asio::async_read(socket_, boost::asio::buffer(response_payload_),
+		[this](const boost::system::error_code& error, size_t)
+		{
+			if (failed_ || error)
+			{
+				reading_ = false;
+				if (!failed_)
+					fail(error);
+				return;
+			}
+			complete();
+		});
+}
+
+void RequestPipeline::complete()
+{
+	reading_ = false;
+
+	// A response that was already buffered when the connection failed has nobody to go to.
+	if (failed_ || in_flight_.empty())
+		return;
+
+	ResponseCallback on_response = std::move(in_flight_.front().on_response);
+	std::chrono::steady_clock::time_point written_at = in_flight_.front().written_at;
+	in_flight_.pop_front();
+
+	// The response can be read before the write's completion handler has run.
+	answered_written_at_ = written_at == std::chrono::steady_clock::time_point() ? std::chrono::steady_clock::now() : written_at;
+
+	// The window has room again; keep the writer busy while the callback runs.
+	start_write();
+	on_response(response_header_.code != SERVER_ERROR_CODE, response_header_, response_payload_);
+
+	start_read();
+}
+
+void RequestPipeline::fail(const boost::system::error_code& error)
+{
+	last_error_ = error.message();
+	failed_ = true;
+
+	// Nothing more is read from or written to this connection; the operation still pending on
+	// the other direction completes with operation_aborted and finds failed_ set.
+	boost::system::error_code ignored;
+	socket_.close(ignored);
+
+	std::deque<ResponseCallback> failed;
+	for (auto& request : in_flight_)
+		failed.push_back(std::move(request.on_response));
+	in_flight_.clear();
+	for (auto& request : queued_)
+		failed.push_back(std::move(request.on_response));
+	queued_.clear();
+
+	ResponseHeader empty_header{};
+	std::vector<uint8_t> empty_payload;
+	answered_written_at_ = std::chrono::steady_clock::now();
+	for (auto& on_response : failed)
+		on_response(false, empty_header, empty_payload);
+}
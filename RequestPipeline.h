@@ -0,0 +1,142 @@
+/**
+ * @file RequestPipeline.h
+ * @brief Declaration of the RequestPipeline class for the MessageU project.
+ *
+ * This header defines an asynchronous request engine that keeps several requests in flight
+ * over one connection and matches the responses to them in FIFO order.
+ *
+ * @version 2.0
+ * @author Dmitriy Gorodov
+ * @id 324725405
+ * @date 16/10/2026
+ */
+
+#pragma once
+
+#include "RequestBuilder.h"
+#include "ResponseHandler.h"
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <string>
+#include <vector>
+#include <boost/array.hpp>
+#include <boost/asio.hpp>
+
+/**
+ * @brief The RequestPipeline class pipelines requests over an already connected socket.
+ *
+ * Requests are written back to back without waiting for the previous response. The server
+ * answers the requests of a connection in the order it received them, so every response is
+ * handed to the oldest request that is still in flight.
+ */
+class RequestPipeline
+{
+public:
+	/**
+	 * @brief Callback invoked once the response to a request has arrived.
+	 * @param success false if the server answered with an error or the connection failed.
+	 * @param header The response header (zeroed if the connection failed).
+	 * @param payload The response payload. The callback may move it out.
+	 */
+	typedef std::function<void(bool success, const ResponseHeader& header, std::vector<uint8_t>& payload)> ResponseCallback;
+
+	static const size_t DEFAULT_MAX_IN_FLIGHT = 64;
+
+	/**
+	 * @brief Constructs a pipeline over a connected socket.
+	 * @param socket The socket; it must outlive the pipeline.
+	 * @param max_in_flight Maximum number of requests written but not yet answered.
+	 */
+	RequestPipeline(boost::asio::ip::tcp::socket& socket, size_t max_in_flight = DEFAULT_MAX_IN_FLIGHT);
+
+	/**
+	 * @brief Queues a request for sending. Returns immediately.
+	 *
+	 * After a connection error the request is not written; on_response is posted with
+	 * success false until clear_error() is called.
+	 * @param request The complete serialized request.
+	 * @param on_response Invoked from the socket's executor when the response arrives.
+	 */
+	void submit(std::vector<uint8_t> request, ResponseCallback on_response);
+
+	/**
+	 * @brief Queues a gathered request for sending. Returns immediately.
+	 * @param request The request; the content it refers to must stay alive until on_response runs.
+	 * @param on_response Invoked from the socket's executor when the response arrives.
+	 */
+	void submit(const GatherRequest& request, ResponseCallback on_response);
+
+	/**
+	 * @brief Runs the socket's io_context until every submitted request has been answered.
+	 */
+	void wait();
+
+	/**
+	 * @brief Returns the number of requests that have not been answered yet.
+	 */
+	size_t pending() const;
+
+	/**
+	 * @brief Returns when the request being answered was completely written, so that the
+	 *        wait for its response can be timed from there. Valid inside a ResponseCallback.
+	 */
+	std::chrono::steady_clock::time_point written_at() const;
+
+	/**
+	 * @brief Returns the description of the last connection error, if any.
+	 */
+	const std::string& last_error() const;
+
+	/**
+	 * @brief Forgets the last connection error and accepts requests again, once the socket
+	 *        has been reconnected. A connection error closes the socket, so that no response
+	 *        can arrive for the requests it already failed.
+	 */
+	void clear_error();
+
+private:
+	struct PendingRequest
+	{
+		std::vector<uint8_t> request;
+		GatherRequest gathered;
+		ResponseCallback on_response;
+	};
+
+	boost::asio::ip::tcp::socket& socket_;
+	size_t max_in_flight_;
+
+	/**
+	 * @brief Requests that have not been written yet.
+	 */
+	std::deque<PendingRequest> queued_;
+
+	struct InFlightRequest
+	{
+		ResponseCallback on_response;
+		std::chrono::steady_clock::time_point written_at;	// set once the write has completed
+	};
+
+	/**
+	 * @brief Requests that were written (or are being written) and await a response.
+	 */
+	std::deque<InFlightRequest> in_flight_;
+	std::chrono::steady_clock::time_point answered_written_at_;
+
+	PendingRequest writing_request_;
+	bool writing_;
+	bool reading_;
+	bool failed_;	// set by fail(), cleared by clear_error(); submit() rejects requests meanwhile
+
+	boost::array<uint8_t, RESPONSE_HEADER_SIZE> response_header_raw_;
+	ResponseHeader response_header_;
+	std::vector<uint8_t> response_payload_;
+	std::string last_error_;
+
+	void enqueue(PendingRequest request);
+	void start_write();
+	void start_read();
+	void read_payload();
+	void complete();
+	void fail(const boost::system::error_code& error);
+};
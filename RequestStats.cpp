@@ -0,0 +1,112 @@
+/**
+ * @file RequestStats.cpp
+ * @brief Implementation of the RequestStats class for the MessageU project.
+ *
+ * Indexes the histograms by request code and phase, and formats them as a table or as JSON.
+ *
+ * @version 2.0
+ * @author Dmitriy Gorodov
+ * @id 342725405
+ * @date 16/10/2026
+ */
+
+#include "RequestStats.h"
+#include <iomanip>
+#include <sstream>
+
+void RequestStats::record(uint16_t request_code, RequestPhase phase, std::chrono::nanoseconds duration)
+{
+	if (request_code < FIRST_REQUEST_CODE || request_code >= FIRST_REQUEST_CODE + REQUEST_CODE_COUNT)
+		return;
+	histograms_[request_code - FIRST_REQUEST_CODE][static_cast<size_t>(phase)].record(duration);
+}
+
+bool RequestStats::empty() const
+{
+	for (const auto& phases : histograms_)
+		for (const auto& histogram : phases)
+			if (!histogram.empty())
+				return false;
+	return true;
+}
+
+void RequestStats::print(std::ostream& out) const
+{
+	out << std::left << std::setw(10) << "Request" << std::setw(12) << "Phase" << std::right
+		<< std::setw(8) << "Count" << std::setw(11) << "p50 ms" << std::setw(11) << "p90 ms"
+		<< std::setw(11) << "p99 ms" << std::setw(11) << "max ms" << "\n";
+
+	for (size_t code = 0; code < REQUEST_CODE_COUNT; code++)
+	{
+		for (size_t phase = 0; phase < PHASE_COUNT; phase++)
+		{
+			const LatencyHistogram& histogram = histograms_[code][phase];
+			if (histogram.empty())
+				continue;
+
+			out << std::left << std::setw(10) << FIRST_REQUEST_CODE + code << std::setw(12) << phase_name(static_cast<RequestPhase>(phase))
+				<< std::right << std::fixed << std::setprecision(3) << std::setw(8) << histogram.count()
+				<< std::setw(11) << histogram.percentile(0.50) / 1e6 << std::setw(11) << histogram.percentile(0.90) / 1e6
+				<< std::setw(11) << histogram.percentile(0.99) / 1e6 << std::setw(11) << histogram.max() / 1e6 << "\n";
+		}
+	}
+}
+
+std::string RequestStats::to_json() const
+{
+	std::ostringstream json;
+	json << "{";
+
+	bool first_code = true;
+	for (size_t code = 0; code < REQUEST_CODE_COUNT; code++)
+	{
+		bool first_phase = true;
+		for (size_t phase = 0; phase < PHASE_COUNT; phase++)
+		{
+			const LatencyHistogram& histogram = histograms_[code][phase];
+			if (histogram.empty())
+				continue;
+
+			if (first_phase)
+			{
+				json << (first_code ? "" : ",") << "\n  \"" << FIRST_REQUEST_CODE + code << "\": {\"name\": \""
+					<< request_name(static_cast<uint16_t>(FIRST_REQUEST_CODE + code)) << "\"";
+				first_code = false;
+				first_phase = false;
+			}
+			json << ",\n    \"" << phase_name(static_cast<RequestPhase>(phase)) << "\": " << histogram.to_json();
+		}
+		if (!first_phase)
+			json << "}";
+	}
+
+	json << "\n}\n";
+	return json.str();
+}
+
+const char* RequestStats::phase_name(RequestPhase phase)
+{
+	switch (phase)
+	{
+	case RequestPhase::SERIALIZE: return "serialize";
+	case RequestPhase::ENCRYPT: return "encrypt";
+	case RequestPhase::WRITE: return "write";
+	case RequestPhase::WAIT: return "wait";
+	case RequestPhase::READ: return "read";
+	case RequestPhase::DECRYPT: return "decrypt";
+	default: return "unknown";
+	}
+}
+
+const char* RequestStats::request_name(uint16_t request_code)
+{
+	switch (request_code)
+	{
+	case RequestCode::REGISTER_CLIENT: return "register";
+	case RequestCode::LIST_ALL_CLIENTS: return "client_list";
+	case RequestCode::FETCH_PUBLIC_KEY: return "public_key";
+	case RequestCode::SEND_MESSAGE: return "send_message";
+	case RequestCode::LIST_PENDING_MESSAGES: return "pending_messages";
+	default: return "unknown";
+	}
+}
@@ -0,0 +1,111 @@
+/**
+ * @file RequestStats.h
+ * @brief Declaration of the RequestStats class for the MessageU project.
+ *
+ * This header defines the latency histograms the client keeps for every request code and
+ * every phase of handling a request, and a scoped timer that records into them.
+ *
+ * @version 2.0
+ * @author Dmitriy Gorodov
+ * @id 324725405
+ * @date 16/10/2026
+ */
+
+#pragma once
+
+#include "LatencyHistogram.h"
+#include "utils.h"
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+/**
+ * @brief The phases a request goes through on the client.
+ */
+enum class RequestPhase
+{
+	SERIALIZE,	// building the request bytes
+	ENCRYPT,	// encrypting the message content
+	WRITE,		// writing the request to the socket
+	WAIT,		// from the end of the write until the response header arrives
+	READ,		// reading the response payload from the socket
+	DECRYPT,	// decrypting received messages, one sample per message
+	COUNT
+};
+
+/**
+ * @brief Latency histograms of requests 600-604, one per phase.
+ *
+ * Separating WAIT from the client-side phases tells server and network latency apart from
+ * client CPU time. Not thread-safe; the client records from its main thread only.
+ */
+class RequestStats
+{
+public:
+	/**
+	 * @brief Records the duration of one phase of a request. Unknown request codes are ignored.
+	 */
+	void record(uint16_t request_code, RequestPhase phase, std::chrono::nanoseconds duration);
+
+	/**
+	 * @brief Returns true if nothing has been recorded.
+	 */
+	bool empty() const;
+
+	/**
+	 * @brief Prints the count and percentiles of every non-empty histogram as a table.
+	 */
+	void print(std::ostream& out) const;
+
+	/**
+	 * @brief Returns every non-empty histogram as a JSON object keyed by request code, then phase.
+	 */
+	std::string to_json() const;
+
+	static const char* phase_name(RequestPhase phase);
+	static const char* request_name(uint16_t request_code);
+
+private:
+	static const uint16_t FIRST_REQUEST_CODE = RequestCode::REGISTER_CLIENT;
+	static const size_t REQUEST_CODE_COUNT = RequestCode::LIST_PENDING_MESSAGES - RequestCode::REGISTER_CLIENT + 1;
+	static const size_t PHASE_COUNT = static_cast<size_t>(RequestPhase::COUNT);
+
+	std::array<std::array<LatencyHistogram, PHASE_COUNT>, REQUEST_CODE_COUNT> histograms_;
+};
+
+/**
+ * @brief Records the time from its construction to stop() or its destruction, whichever is first.
+ */
+class PhaseTimer
+{
+public:
+	PhaseTimer(RequestStats& stats, uint16_t request_code, RequestPhase phase)
+		: stats_(stats), request_code_(request_code), phase_(phase), started_(std::chrono::steady_clock::now()), stopped_(false)
+	{
+	}
+
+	~PhaseTimer()
+	{
+		stop();
+	}
+
+	void stop()
+	{
+		if (stopped_)
+			return;
+		stopped_ = true;
+		stats_.record(request_code_, phase_, std::chrono::steady_clock::now() - started_);
+	}
+
+private:
+	RequestStats& stats_;
+	uint16_t request_code_;
+	RequestPhase phase_;
+	std::chrono::steady_clock::time_point started_;
+	bool stopped_;
+
+	PhaseTimer(const PhaseTimer&);
+	PhaseTimer& operator=(const PhaseTimer&);
+};
@@ -0,0 +1,339 @@
+/**
+ * @file SearchIndex.cpp
+ * @brief Implementation of the SearchIndex class for the MessageU project.
+ *
+ * @version 2.0
+ * @author Dmitriy Gorodov
+ * @id 342725405
+ * @date 16/10/2026
+ */
+
+#include "SearchIndex.h"
+#include "GCMChunkCipher.h"
+#include "utils.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+static const char MAGIC[4] = { 'M', 'U', 'S', 'X' };
+static const uint8_t VERSION = 2;	// 1 kept the body in the clear
+
+/**
+ * @brief Returns the clear header of the file, which is also the associated data of the body.
+ */
+static std::string file_header()
+{
+	std::string header(MAGIC, sizeof(MAGIC));
+	header.push_back(static_cast<char>(VERSION));
+	return header;
+}
+
+static void put_le(std::string& out, uint64_t value, size_t bytes)
+{
+	for (size_t i = 0; i < bytes; i++)
+		out.push_back(static_cast<char>(value >> (8 * i)));
+}
+
+static void put_varint(std::string& out, uint32_t value)
+{
+	while (value >= 0x80)
+	{
+		out.push_back(static_cast<char>(value | 0x80));
+		value >>= 7;
+	}
+	out.push_back(static_cast<char>(value));
+}
+
+/**
+ * @brief Reads sequentially from the loaded file; every read fails once the data runs out.
+ */
+class IndexReader
+{
+public:
+	IndexReader(const std::string& data) : data_(data), position_(0) {}
+
+	bool get_le(uint64_t* value, size_t bytes)
+	{
+		if (data_.size() - position_ < bytes)
+			return false;
+		*value = 0;
+		for (size_t i = bytes; i-- > 0; )
+			*value = (*value << 8) | static_cast<unsigned char>(data_[position_ + i]);
+		position_ += bytes;
+		return true;
+	}
+
+	bool get_varint(uint32_t* value)
+	{
+		*value = 0;
+		for (int shift = 0; shift < 35 && position_ < data_.size(); shift += 7)
+		{
+			unsigned char byte = static_cast<unsigned char>(data_[position_++]);
+			*value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+			if (!(byte & 0x80))
+				return true;
+		}
+		return false;
+	}
+
+	bool get_bytes(std::string* out, size_t length)
+	{
+		if (data_.size() - position_ < length)
+			return false;
+		out->assign(data_, position_, length);
+		position_ += length;
+		return true;
+	}
+
+private:
+	const std::string& data_;
+	size_t position_;
+};
+
+/**
+ * @brief Calls visit with every word of a text, lowercased, in a buffer reused between calls.
+ */
+template <typename Visit>
+static void visit_words(const std::string& text, Visit visit)
+{
+	std::string word;
+	word.reserve(SearchIndex::MAX_WORD_LENGTH + 1);
+	for (size_t i = 0; i <= text.size(); i++)
+	{
+		unsigned char c = i < text.size() ? static_cast<unsigned char>(text[i]) : ' ';
+		if ((c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || c >= 0x80)
+		{
+			word.push_back(static_cast<char>(c));
+			continue;
+		}
+		if (c >= 'A' && c <= 'Z')
+		{
+			word.push_back(static_cast<char>(c - 'A' + 'a'));
+			continue;
+		}
+
+		// Longer runs are not words anyone searches for (keys, encoded data).
+		if (!word.empty() && word.size() <= SearchIndex::MAX_WORD_LENGTH)
+			visit(word);
+		word.clear();
+	}
+}
+
+SearchIndex::SearchIndex(const std::string& path)
+	: path_(path), indexed_(0), last_received_at_(0), dirty_(false)
+{
+}
+
+void SearchIndex::open(const MessageStore& store, std::shared_ptr<const AESWrapper> storage_key)
+{
+	storage_key_ = std::move(storage_key);
+
+	// The saved index only applies to the history it was built from.
+	StoredMessage last;
+	bool matches = load() && indexed_ <= store.size()
+		&& (indexed_ == 0 || (store.read(indexed_ - 1, &last) && last.received_at == last_received_at_));
+	if (!matches)
+	{
+		// A discarded index (of another history, an earlier version or another identity) is
+		// replaced on disk even if nothing is indexed again.
+		std::error_code error;
+		dirty_ = indexed_ != 0 || std::filesystem::exists(path_, error);
+		postings_.clear();
+		indexed_ = 0;
+		last_received_at_ = 0;
+	}
+
+	// Saved at once, so that a rebuild is not repeated if the client does not exit cleanly.
+	update(store);
+	save();
+}
+
+void SearchIndex::update(const MessageStore& store)
+{
+	if (indexed_ >= store.size())
+		return;
+
+	store.for_each(indexed_, 1u << MessageType::TEXT_MESSAGE_SEND, [this](size_t position, const StoredMessage& message)
+		{
+			add(static_cast<uint32_t>(position), message.content);
+		});
+
+	indexed_ = store.size();
+	dirty_ = true;
+	StoredMessage last;
+	if (store.read(indexed_ - 1, &last))
+		last_received_at_ = last.received_at;
+}
+
+void SearchIndex::add(uint32_t position, const std::string& text)
+{
+	visit_words(text, [this, position](const std::string& word)
+		{
+			// A word repeated in the message is added once.
+			std::vector<uint32_t>& positions = postings_[word];
+			if (positions.empty() || positions.back() < position)
+			{
+				positions.push_back(position);
+				dirty_ = true;
+			}
+		});
+}
+
+std::vector<std::string> SearchIndex::split_words(const std::string& text)
+{
+	std::vector<std::string> words;
+	visit_words(text, [&words](const std::string& word) { words.push_back(word); });
+	std::sort(words.begin(), words.end());
+	words.erase(std::unique(words.begin(), words.end()), words.end());
+	return words;
+}
+
+std::vector<uint32_t> SearchIndex::search(const std::string& query, size_t limit) const
+{
+	std::vector<uint32_t> matches;
+	std::vector<const std::vector<uint32_t>*> lists;
+	for (const auto& word : split_words(query))
+	{
+		auto postings = postings_.find(word);
+		if (postings == postings_.end())
+			return matches;
+		lists.push_back(&postings->second);
+	}
+	if (lists.empty())
+		return matches;
+
+	std::sort(lists.begin(), lists.end(), [](const std::vector<uint32_t>* a, const std::vector<uint32_t>* b)
+		{
+			return a->size() < b->size();
+		});
+
+	// Walk the rarest word's messages from the newest one back. Each other list is searched
+	// below the previous hit only, as the candidates are visited in descending order.
+	std::vector<std::vector<uint32_t>::const_iterator> ends;
+	for (size_t i = 1; i < lists.size(); i++)
+		ends.push_back(lists[i]->end());
+
+	const std::vector<uint32_t>& rarest = *lists[0];
+	for (auto candidate = rarest.rbegin(); candidate != rarest.rend() && matches.size() < limit; ++candidate)
+	{
+		bool in_all = true;
+		for (size_t i = 1; i < lists.size() && in_all; i++)
+		{
+			auto found = std::lower_bound(lists[i]->begin(), ends[i - 1], *candidate);
+			ends[i - 1] = found;
+			in_all = found != lists[i]->end() && *found == *candidate;
+		}
+		if (in_all)
+			matches.push_back(*candidate);
+	}
+	return matches;
+}
+
+bool SearchIndex::load()
+{
+	std::ifstream file(path_, std::ios::binary);
+	if (!file)
+		return false;
+	std::ostringstream contents;
+	contents << file.rdbuf();
+	std::string sealed = contents.str();
+
+	// An index of an earlier version, or sealed under another identity, is rebuilt.
+	std::string header = file_header();
+	if (!storage_key_ || sealed.compare(0, header.size(), header) != 0)
+		return false;
+	std::string data;
+	try
+	{
+		GCMChunkDecryptor decryptor(storage_key_, nullptr, 1, header);
+		std::string rest;
+		decryptor.update(sealed.data() + header.size(), sealed.size() - header.size(), data);
+		decryptor.finish(rest);
+		data.append(rest);
+	}
+	catch (const std::exception&)
+	{
+		return false;
+	}
+
+	IndexReader reader(data);
+	uint64_t indexed = 0, last_received_at = 0, word_count = 0;
+	if (!reader.get_le(&indexed, 8) || !reader.get_le(&last_received_at, 8) || !reader.get_le(&word_count, 4))
+		return false;
+
+	std::unordered_map<std::string, std::vector<uint32_t>> postings;
+	postings.reserve(static_cast<size_t>(std::min<uint64_t>(word_count, data.size())));
+	for (uint64_t i = 0; i < word_count; i++)
+	{
+		uint64_t length = 0, count = 0;
+		std::string word;
+		if (!reader.get_le(&length, 1) || !reader.get_bytes(&word, static_cast<size_t>(length)) || !reader.get_le(&count, 4)
+			|| count > data.size())
+			return false;
+
+		std::vector<uint32_t>& positions = postings[word];
+		positions.resize(static_cast<size_t>(count));
+		uint32_t position = 0;
+		for (auto& stored : positions)
+		{
+			uint32_t delta = 0;
+			if (!reader.get_varint(&delta))
+				return false;
+			position += delta;
+			stored = position;
+		}
+	}
+
+	postings_ = std::move(postings);
+	indexed_ = indexed;
+	last_received_at_ = static_cast<int64_t>(last_received_at);
+	return true;
+}
+
+bool SearchIndex::save()
+{
+	if (!dirty_)
+		return true;
+	if (!storage_key_)
+		return false;
+
+	std::string data;
+	put_le(data, indexed_, 8);
+	put_le(data, static_cast<uint64_t>(last_received_at_), 8);
+	put_le(data, postings_.size(), 4);
+	for (const auto& postings : postings_)
+	{
+		put_le(data, postings.first.size(), 1);
+		data += postings.first;
+		put_le(data, postings.second.size(), 4);
+		uint32_t previous = 0;
+		for (uint32_t position : postings.second)
+		{
+			put_varint(data, position - previous);
+			previous = position;
+		}
+	}
+
+	std::string header = file_header();
+	GCMChunkEncryptor encryptor(storage_key_, nullptr, GCMChunk::DEFAULT_CHUNK_SIZE, header);
+	std::string sealed;
+	encryptor.encrypt(data.data(), data.size(), true, sealed);
+	data.clear();
+	header.append(sealed);
+
+	std::error_code error;
+	std::filesystem::path directory = std::filesystem::path(path_).parent_path();
+	if (!directory.empty())
+		std::filesystem::create_directories(directory, error);
+
+	if (error || !write_file_atomically(path_, header))
+	{
+		std::cerr << "Warning: unable to save the search index to " << path_ << "; it will be rebuilt on the next start.\n";
+		return false;
+	}
+	dirty_ = false;
+	return true;
+}
@@ -0,0 +1,95 @@
+/**
+ * @file SearchIndex.h
+ * @brief Declaration of the SearchIndex class for the MessageU project.
+ *
+ * The search index is an inverted index over the text messages of the history (MessageStore.h):
+ * for every word, the positions of the messages that contain it, in receive order. It lives in
+ * memory and is saved to "history/search.idx" when the client exits, so that the next start
+ * only indexes the messages received since.
+ *
+ * File layout, integers little endian:
+ *   magic "MUSX" | version (1) | sealed body
+ *   body: indexed messages (8) | last indexed received at (8) | word count (4)
+ *         then per word: length (1) | word | position count (4) | positions, delta-coded as varints
+ * The body is sealed like the history it indexes, in the chunked AES-GCM format with the
+ * client's storage key, and the magic and version as associated data.
+ *
+ * @version 2.0
+ * @author Dmitriy Gorodov
+ * @id 324725405
+ * @date 16/10/2026
+ */
+
+#pragma once
+
+#include "AESWrapper.h"
+#include "MessageStore.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief The SearchIndex class finds the stored text messages that contain a set of words.
+ *
+ * A word is a run of ASCII letters and digits, or of non-ASCII bytes, so UTF-8 words are kept
+ * whole; ASCII letters are lowercased. A search returns the messages that contain every word of
+ * the query. It walks the shortest position list from the newest message back and checks the
+ * other lists by binary search, so it stops as soon as it has enough matches.
+ */
+class SearchIndex
+{
+public:
+	static const size_t MAX_WORD_LENGTH = 64;
+
+	explicit SearchIndex(const std::string& path);
+
+	/**
+	 * @brief Loads the saved index and indexes the messages stored since it was saved.
+	 *
+	 * An index that does not match the history (e.g. the history was removed) is rebuilt. The
+	 * index is saved again if it changed.
+	 * @param storage_key The key the file is sealed with.
+	 */
+	void open(const MessageStore& store, std::shared_ptr<const AESWrapper> storage_key);
+
+	/**
+	 * @brief Indexes the text messages added to the store since the last update.
+	 */
+	void update(const MessageStore& store);
+
+	/**
+	 * @brief Writes the index to its file if it changed since it was loaded or last saved.
+	 *
+	 * The directory of the file is created if it does not exist yet.
+	 * @return false if the index could not be written, or the index was never opened.
+	 */
+	bool save();
+
+	/**
+	 * @brief Returns the positions of the newest messages that contain every word of the query, newest first.
+	 */
+	std::vector<uint32_t> search(const std::string& query, size_t limit) const;
+
+	/**
+	 * @brief Splits a text into its distinct words, lowercased.
+	 */
+	static std::vector<std::string> split_words(const std::string& text);
+
+	/**
+	 * @brief Returns the number of distinct words indexed.
+	 */
+	size_t size() const { return postings_.size(); }
+
+private:
+	std::string path_;
+	std::shared_ptr<const AESWrapper> storage_key_;
+	uint64_t indexed_;	// the store positions below this one are indexed
+	int64_t last_received_at_;	// of the message at indexed_ - 1, to recognize the same history
+	bool dirty_;	// the index differs from its file
+	std::unordered_map<std::string, std::vector<uint32_t>> postings_;	// word -> ascending positions
+
+	bool load();
+	void add(uint32_t position, const std::string& text);
+};
@@ -0,0 +1,109 @@
+/**
+ * @file Tracer.cpp
+ * @brief Implementation of the Tracer class for the MessageU project.
+ *
+ * Buffers the trace events and writes them to the trace file as a Chrome "traceEvents" array.
+ *
+ * @version 2.0
+ * @author Dmitriy Gorodov
+ * @id 342725405
+ * @date 16/10/2026
+ */
+
+#include "Tracer.h"
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <mutex>
+
+std::atomic<bool> Tracer::enabled_(false);
+
+namespace
+{
+	const size_t FLUSH_SIZE = 64 * 1024;
+
+	std::mutex trace_mutex;
+	std::ofstream trace_file;
+	std::string trace_buffer;
+	Tracer::Clock::time_point trace_epoch;
+	bool first_event = true;
+	bool exit_handler_registered = false;
+
+	/**
+	 * @brief Returns a small, stable number for the calling thread (Chrome's "tid").
+	 */
+	unsigned int thread_number()
+	{
+		static std::atomic<unsigned int> next_thread_number(1);
+		static thread_local unsigned int number = next_thread_number.fetch_add(1);
+		return number;
+	}
+
+	void stop_at_exit()
+	{
+		Tracer::stop();
+	}
+}
+
+bool Tracer::start(const std::string& path)
+{
+	std::lock_guard<std::mutex> lock(trace_mutex);
+	if (enabled_.load())
+		return true;
+
+	trace_file.open(path, std::ios::binary | std::ios::trunc);
+	if (!trace_file)
+		return false;
+
+	trace_file << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+	trace_buffer.reserve(FLUSH_SIZE + 512);
+	trace_epoch = Clock::now();
+	first_event = true;
+
+	// Client::run exits the process directly on some errors; the trace must still be complete.
+	if (!exit_handler_registered)
+	{
+		std::atexit(stop_at_exit);
+		exit_handler_registered = true;
+	}
+
+	enabled_.store(true);
+	return true;
+}
+
+void Tracer::stop()
+{
+	std::lock_guard<std::mutex> lock(trace_mutex);
+	if (!enabled_.exchange(false))
+		return;
+
+	trace_file << trace_buffer << "\n]}\n";
+	trace_buffer.clear();
+	trace_file.close();
+}
+
+void Tracer::complete(const char* name, const char* category, Clock::time_point start, Clock::time_point end)
+{
+	unsigned int thread = thread_number();
+
+	std::lock_guard<std::mutex> lock(trace_mutex);
+	if (!enabled_.load(std::memory_order_relaxed))
+		return;
+
+	char event[384];
+	int length = snprintf(event, sizeof(event),
+		"%s{\"name\": \"%s\", \"cat\": \"%s\", \"ph\": \"X\", \"ts\": %.3f, \"dur\": %.3f, \"pid\": 1, \"tid\": %u}",
+		first_event ? "" : ",\n", name, category,
+		std::chrono::duration<double, std::micro>(start - trace_epoch).count(),
+		std::chrono::duration<double, std::micro>(end - start).count(), thread);
+	if (length <= 0 || static_cast<size_t>(length) >= sizeof(event))
+		return;
+
+	first_event = false;
+	trace_buffer.append(event, static_cast<size_t>(length));
+	if (trace_buffer.size() >= FLUSH_SIZE)
+	{
+		trace_file << trace_buffer;
+		trace_buffer.clear();
+	}
+}
@@ -0,0 +1,101 @@
+/**
+ * @file Tracer.h
+ * @brief Declaration of the Tracer class for the MessageU project.
+ *
+ * This header defines an opt-in tracer that writes Chrome trace-event JSON, which can be
+ * opened in Perfetto or chrome://tracing, and the TRACE_SCOPE macro that times a scope.
+ *
+ * @version 2.0
+ * @author Dmitriy Gorodov
+ * @id 324725405
+ * @date 16/10/2026
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <string>
+
+/**
+ * @brief Process-wide trace writer.
+ *
+ * Tracing is off until start() is called ("--trace"). While it is off a TRACE_SCOPE costs one
+ * relaxed atomic load; defining MESSAGEU_NO_TRACING removes the scopes from the build entirely.
+ * While it is on, spans from any thread are appended to the file under a lock.
+ */
+class Tracer
+{
+public:
+	typedef std::chrono::steady_clock Clock;
+
+	/**
+	 * @brief Returns true while a trace is being written.
+	 */
+	static bool enabled()
+	{
+		return enabled_.load(std::memory_order_relaxed);
+	}
+
+	/**
+	 * @brief Opens the trace file and starts tracing. The trace is closed at exit at the latest.
+	 * @return false if the file cannot be opened.
+	 */
+	static bool start(const std::string& path);
+
+	/**
+	 * @brief Stops tracing and completes the trace file. Does nothing if tracing is off.
+	 */
+	static void stop();
+
+	/**
+	 * @brief Writes one complete span.
+	 * @param name Span name; a string literal, written as is.
+	 * @param category Span category; a string literal, written as is.
+	 */
+	static void complete(const char* name, const char* category, Clock::time_point start, Clock::time_point end);
+
+private:
+	static std::atomic<bool> enabled_;
+};
+
+/**
+ * @brief Emits a span covering its own lifetime if tracing was on when it was constructed.
+ */
+class TraceScope
+{
+public:
+	TraceScope(const char* name, const char* category)
+		: name_(name), category_(category), active_(Tracer::enabled())
+	{
+		if (active_)
+			start_ = Tracer::Clock::now();
+	}
+
+	~TraceScope()
+	{
+		if (active_)
+			Tracer::complete(name_, category_, start_, Tracer::Clock::now());
+	}
+
+private:
+	const char* name_;
+	const char* category_;
+	bool active_;
+	Tracer::Clock::time_point start_;
+
+	TraceScope(const TraceScope&);
+	TraceScope& operator=(const TraceScope&);
+};
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+
+#ifdef MESSAGEU_NO_TRACING
+#define TRACE_SCOPE(name, category)
+#else
+/**
+ * @brief Traces the rest of the enclosing scope as a span, e.g. TRACE_SCOPE("encrypt", "aes").
+ */
+#define TRACE_SCOPE(name, category) TraceScope TRACE_CONCAT(trace_scope_, __LINE__)(name, category)
+#endif
@@ -0,0 +1,184 @@
+/**
+ * @file TransferJournal.cpp
+ * @brief Implementation of the TransferJournal class for the MessageU project.
+ *
+ * Each line holds: direction, transfer ID, peer ID, total size, part size, modification time,
+ * completion time, the done parts as a hexadecimal bitmap, and the file path (the rest of the line).
+ *
+ * @version 2.0
+ * @author Dmitriy Gorodov
+ * @id 342725405
+ * @date 16/10/2026
+ */
+
+#include "TransferJournal.h"
+#include "utils.h"
+#include <algorithm>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+static std::string transfer_key(const std::array<uint8_t, FilePart::TRANSFER_ID_SIZE>& transfer_id)
+{
+	return std::string(transfer_id.begin(), transfer_id.end());
+}
+
+/**
+ * @brief Parses one journal line.
+ * @return false if the line is malformed.
+ */
+static bool parse_record(const std::string& line, TransferRecord* record)
+{
+	std::istringstream fields(line);
+	char direction;
+	std::string transfer_id_hex, peer_id_hex, bitmap_hex;
+	if (!(fields >> direction >> transfer_id_hex >> peer_id_hex >> record->header.total_size >> record->header.part_size >> record->modified >> record->completed_at >> bitmap_hex))
+		return false;
+	if (direction != TransferRecord::OUTGOING && direction != TransferRecord::INCOMING)
+		return false;
+	record->direction = static_cast<TransferRecord::Direction>(direction);
+
+	fields.get();
+	if (!std::getline(fields, record->path) || record->path.empty())
+		return false;
+
+	if (transfer_id_hex.size() != FilePart::TRANSFER_ID_SIZE * 2 || !is_valid_hex(transfer_id_hex) || !ClientId::from_hex(peer_id_hex, &record->peer_id))
+		return false;
+	std::vector<uint8_t> transfer_id = hex_string_to_bytes(transfer_id_hex);
+	std::copy(transfer_id.begin(), transfer_id.end(), record->header.transfer_id.begin());
+
+	FilePartHeader& header = record->header;
+	if (header.part_size == 0 || header.part_size > FilePart::MAX_PART_SIZE || header.total_size == 0)
+		return false;
+	header.count = static_cast<uint32_t>((header.total_size + header.part_size - 1) / header.part_size);
+	header.index = 0;
+
+	if (!is_valid_hex(bitmap_hex) || bitmap_hex.size() != ((header.count + 7) / 8) * 2)
+		return false;
+	std::vector<uint8_t> bitmap = hex_string_to_bytes(bitmap_hex);
+	record->done.assign(header.count, false);
+	record->done_count = 0;
+	for (uint32_t i = 0; i < header.count; i++)
+	{
+		if (bitmap[i / 8] & (1 << (i % 8)))
+		{
+			record->done[i] = true;
+			record->done_count++;
+		}
+	}
+	return true;
+}
+
+TransferJournal::TransferJournal(const std::string& path)
+	: path_(path), save_failed_(false)
+{
+}
+
+void TransferJournal::load()
+{
+	records_.clear();
+	std::ifstream file(path_);
+	std::string line;
+	int64_t now = static_cast<int64_t>(std::time(nullptr));
+	while (std::getline(file, line))
+	{
+		TransferRecord record;
+		if (!parse_record(line, &record))
+			continue;
+		if (record.completed_at != 0 && now - record.completed_at > COMPLETED_RETENTION)
+			continue;
+		records_[transfer_key(record.header.transfer_id)] = std::move(record);
+	}
+}
+
+TransferRecord* TransferJournal::find(const std::array<uint8_t, FilePart::TRANSFER_ID_SIZE>& transfer_id)
+{
+	auto found = records_.find(transfer_key(transfer_id));
+	return found == records_.end() ? nullptr : &found->second;
+}
+
+TransferRecord* TransferJournal::find_outgoing(const ClientId& peer_id, const std::string& path, uint64_t size, int64_t modified)
+{
+	for (auto& entry : records_)
+	{
+		TransferRecord& record = entry.second;
+		if (record.direction == TransferRecord::OUTGOING && record.peer_id == peer_id && record.path == path
+			&& record.header.total_size == size && record.modified == modified)
+			return &record;
+	}
+	return nullptr;
+}
+
+std::vector<TransferRecord*> TransferJournal::records(TransferRecord::Direction direction)
+{
+	std::vector<TransferRecord*> matching;
+	for (auto& entry : records_)
+	{
+		if (entry.second.direction == direction)
+			matching.push_back(&entry.second);
+	}
+	return matching;
+}
+
+TransferRecord* TransferJournal::add(TransferRecord record)
+{
+	record.header.index = 0;
+	record.done.assign(record.header.count, false);
+	record.done_count = 0;
+
+	TransferRecord& stored = records_[transfer_key(record.header.transfer_id)];
+	stored = std::move(record);
+	save();
+	return &stored;
+}
+
+void TransferJournal::mark_done(TransferRecord* record, uint32_t index)
+{
+	if (index >= record->done.size() || record->done[index])
+		return;
+	record->done[index] = true;
+	record->done_count++;
+	if (record->direction == TransferRecord::INCOMING && record->is_complete())
+		record->completed_at = static_cast<int64_t>(std::time(nullptr));
+	save();
+}
+
+void TransferJournal::remove(TransferRecord* record)
+{
+	records_.erase(transfer_key(record->header.transfer_id));
+	save();
+}
+
+void TransferJournal::save()
+{
+	std::error_code error;
+	if (records_.empty())
+	{
+		std::filesystem::remove(path_, error);
+		return;
+	}
+
+	std::ostringstream journal;
+	for (const auto& entry : records_)
+	{
+		const TransferRecord& record = entry.second;
+		std::vector<uint8_t> bitmap((record.header.count + 7) / 8, 0);
+		for (uint32_t i = 0; i < record.header.count; i++)
+		{
+			if (record.done[i])
+				bitmap[i / 8] |= static_cast<uint8_t>(1 << (i % 8));
+		}
+
+		journal << static_cast<char>(record.direction) << " "
+			<< bytes_to_hex_string(std::vector<uint8_t>(record.header.transfer_id.begin(), record.header.transfer_id.end())) << " "
+			<< record.peer_id.to_hex() << " " << record.header.total_size << " " << record.header.part_size << " "
+			<< record.modified << " " << record.completed_at << " " << bytes_to_hex_string(bitmap) << " " << record.path << "\n";
+	}
+
+	bool saved = write_file_atomically(path_, journal.str());
+	if (!saved && !save_failed_)
+		std::cerr << "Warning: unable to save the transfer journal " << path_ << "; interrupted transfers will restart from the beginning.\n";
+	save_failed_ = !saved;
+}
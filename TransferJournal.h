@@ -0,0 +1,116 @@
+/**
+ * @file TransferJournal.h
+ * @brief Declaration of the TransferJournal class for the MessageU project.
+ *
+ * This header defines the checkpoint journal of multipart file transfers. It records which
+ * parts of every unfinished transfer have been acknowledged by the server (files being sent)
+ * or written to disk (files being received), so an interrupted transfer resumes at the parts
+ * that are missing instead of starting over.
+ *
+ * @version 2.0
+ * @author Dmitriy Gorodov
+ * @id 324725405
+ * @date 16/10/2026
+ */
+
+#pragma once
+
+#include "ClientId.h"
+#include "FilePart.h"
+#include <array>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief The checkpoint of one unfinished multipart transfer.
+ */
+struct TransferRecord
+{
+	enum Direction : char
+	{
+		OUTGOING = 'S',
+		INCOMING = 'R'
+	};
+
+	Direction direction;
+	FilePartHeader header;	// the index is not used
+	ClientId peer_id;	// the recipient of an outgoing transfer, the sender of an incoming one
+	std::string path;	// the file being sent, or the file being reassembled
+	int64_t modified = 0;	// outgoing: the file's last write time when the transfer started
+	int64_t completed_at = 0;	// incoming: when the last part was written (seconds since the epoch), 0 until then
+	std::vector<bool> done;	// parts acknowledged by the server (outgoing) or written (incoming)
+	uint32_t done_count = 0;
+
+	bool is_complete() const { return done_count == header.count; }
+};
+
+/**
+ * @brief The TransferJournal class keeps the checkpoints of unfinished transfers in a file.
+ *
+ * The journal is a text file with one line per transfer. It is rewritten through a temporary
+ * file and a rename after every change, so a crash leaves either the old or the new version.
+ * Records are addressed by pointer; a pointer stays valid until its record is removed.
+ *
+ * A completed incoming transfer is kept for COMPLETED_RETENTION, so copies of its parts that
+ * arrive late (a sender resending parts whose acknowledgement it missed) are recognized.
+ */
+class TransferJournal
+{
+public:
+	static const int64_t COMPLETED_RETENTION = 7 * 24 * 60 * 60;	// seconds
+
+	explicit TransferJournal(const std::string& path);
+
+	/**
+	 * @brief Reads the journal file. A missing file is an empty journal; malformed lines and
+	 *        expired completed transfers are skipped.
+	 */
+	void load();
+
+	/**
+	 * @brief Returns the record of a transfer ID, or nullptr.
+	 */
+	TransferRecord* find(const std::array<uint8_t, FilePart::TRANSFER_ID_SIZE>& transfer_id);
+
+	/**
+	 * @brief Returns the unfinished transfer of the given file to the given peer, or nullptr.
+	 *
+	 * A record whose file has since changed size or modification time does not match.
+	 */
+	TransferRecord* find_outgoing(const ClientId& peer_id, const std::string& path, uint64_t size, int64_t modified);
+
+	/**
+	 * @brief Returns every record of one direction.
+	 */
+	std::vector<TransferRecord*> records(TransferRecord::Direction direction);
+
+	/**
+	 * @brief Adds a record (its done parts are reset) and saves the journal.
+	 * @return The stored record.
+	 */
+	TransferRecord* add(TransferRecord record);
+
+	/**
+	 * @brief Marks one part of a transfer as done and saves the journal.
+	 *
+	 * The completion time of an incoming transfer is set when its last part is marked.
+	 */
+	void mark_done(TransferRecord* record, uint32_t index);
+
+	/**
+	 * @brief Removes a finished or abandoned transfer and saves the journal.
+	 */
+	void remove(TransferRecord* record);
+
+private:
+	std::string path_;
+	std::unordered_map<std::string, TransferRecord> records_;	// by transfer ID bytes
+	bool save_failed_;
+
+	/**
+	 * @brief Rewrites the journal file; reports the first failure on the console.
+	 */
+	void save();
+};
@@ -3,7 +3,13 @@
  * @brief Entry point for the MessageU client application.
  *
  * Reads the server configuration from "server.info", creates a Client object,
- * and starts the client.
+ * and starts the client. Started with "--benchmark [filter] [--json file]" it runs the
+ * benchmark cases instead, and with "--mock-server [port] [latency_ms] [bytes_per_second]" it
+ * serves the MessageU protocol from memory on the loopback interface. Started with
+ * "--load-test [clients] [seconds] [mix] [host:port]" it runs the load generator.
+ * A leading "--trace [file]" writes a Chrome trace of any of these modes, and a leading
+ * "--crypto name" (after any "--trace") selects the crypto provider, e.g. "openssl". The
+ * client itself accepts "--gcm-files" to send large files in the chunked GCM formats.
  * 
  * @version 2.0
  * @author Dmitriy Gorodov
@@ -12,6 +18,11 @@
  */
 
 #include "Client.h"
+#include "Benchmark.h"
+#include "CryptoProvider.h"
+#include "LoadGenerator.h"
+#include "MockServer.h"
+#include "Tracer.h"
 #include <iostream>
 #include <fstream>
 #include <sstream>
@@ -19,12 +30,139 @@
 #include <string>
 #include <vector>
 #include <stdexcept>
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
 #include <boost/asio.hpp>
 
-int main() 
+/**
+ * @brief Parses a decimal command line argument.
+ * @throws std::runtime_error naming the argument and the usage if it is not a number from min to max.
+ */
+static uint64_t parse_argument(const std::string& text, uint64_t min, uint64_t max, const std::string& name, const std::string& usage)
+{
+	size_t parsed = 0;
+	uint64_t value = 0;
+	if (!text.empty() && isdigit(static_cast<unsigned char>(text[0])))
+	{
+		try
+		{
+			value = std::stoull(text, &parsed);
+		}
+		catch (const std::exception&)
+		{
+			parsed = 0;	// out of range
+		}
+	}
+	if (parsed == 0 || parsed != text.size() || value < min || value > max)
+		throw std::runtime_error("Invalid " + name + " \"" + text + "\", expected a number from " + std::to_string(min) + " to " + std::to_string(max) + ".\n" + usage);
+	return value;
+}
+
+int main(int argc, char* argv[])
 {
 	try 
 	{
+		// "--trace [file]" is taken off the front of the arguments; the mode follows it.
+		if (argc > 1 && std::string(argv[1]) == "--trace")
+		{
+			std::string trace_path = "trace.json";
+			int consumed = 1;
+			if (argc > 2 && std::string(argv[2]).compare(0, 2, "--") != 0)
+			{
+				trace_path = argv[2];
+				consumed = 2;
+			}
+			if (!Tracer::start(trace_path))
+				throw std::runtime_error("Unable to open " + trace_path + " for writing.");
+			argc -= consumed;
+			argv += consumed;
+		}
+
+		// "--crypto name" is chosen before any key object is created.
+		if (argc > 1 && std::string(argv[1]) == "--crypto")
+		{
+			std::string name = argc > 2 ? argv[2] : "";
+			if (!CryptoProvider::select(name))
+			{
+				std::string built;
+				for (const CryptoProvider* provider : CryptoProvider::all())
+					built += std::string(built.empty() ? "" : ", ") + provider->name();
+				throw std::runtime_error("Unknown crypto provider \"" + name + "\", built: " + built + ".");
+			}
+			argc -= 2;
+			argv += 2;
+		}
+
+		if (argc > 1 && std::string(argv[1]) == "--benchmark")
+		{
+			std::string filter;
+			std::string json_path;
+			for (int i = 2; i < argc; i++)
+			{
+				std::string argument = argv[i];
+				if (argument == "--json" && i + 1 < argc)
+					json_path = argv[++i];
+				else
+					filter = argument;
+			}
+
+			Benchmark benchmark;
+			std::vector<BenchmarkResult> results = benchmark.run(filter);
+			benchmark.print(results);
+			if (!json_path.empty())
+			{
+				std::ofstream json_file(json_path);
+				if (!json_file)
+					throw std::runtime_error("Unable to open " + json_path + " for writing.");
+				Benchmark::write_json(results, json_file);
+			}
+			return 0;
+		}
+
+		if (argc > 1 && std::string(argv[1]) == "--mock-server")
+		{
+			const std::string usage = "Usage: --mock-server [port] [latency_ms] [bytes_per_second]";
+			MockServerOptions options;
+			options.port = static_cast<uint16_t>(argc > 2 ? parse_argument(argv[2], 0, 65535, "port", usage) : 1234);
+			options.latency = std::chrono::milliseconds(argc > 3 ? parse_argument(argv[3], 0, 3600 * 1000, "latency", usage) : 0);
+			options.bytes_per_second = argc > 4 ? parse_argument(argv[4], 0, UINT64_MAX, "bytes per second", usage) : 0;
+
+			MockServer server(options);
+			std::cout << "MessageU mock server listening on " << options.address << ":" << server.port() << "\n";
+			server.run();
+			return 0;
+		}
+
+		if (argc > 1 && std::string(argv[1]) == "--load-test")
+		{
+			const std::string usage = "Usage: --load-test [clients] [seconds] [mix] [host:port]";
+			LoadGeneratorOptions options;
+			if (argc > 2)
+				options.clients = static_cast<size_t>(parse_argument(argv[2], 1, 10000, "number of clients", usage));
+			if (argc > 3)
+				options.duration = std::chrono::seconds(parse_argument(argv[3], 1, 24 * 3600, "duration", usage));
+			if (argc > 4 && !options.parse_mix(argv[4]))
+				throw std::runtime_error("Invalid operation mix, expected e.g. list:1,key:1,text:6,file:1,pending:1.\n" + usage);
+			if (argc > 5)
+			{
+				// Without a server address the test runs against an in-process mock server.
+				std::string server = argv[5];
+				auto colon = server.find(':');
+				if (colon == std::string::npos || colon == 0)
+					throw std::runtime_error("Invalid server address \"" + server + "\", expected host:port.\n" + usage);
+				options.host = server.substr(0, colon);
+				options.port = static_cast<uint16_t>(parse_argument(server.substr(colon + 1), 1, 65535, "port", usage));
+			}
+
+			LoadGenerator load_generator(options);
+			LoadGenerator::print(load_generator.run());
+			return 0;
+		}
+
+		// Only clients that support message types 5 and 6 can receive files sent in them.
+		bool gcm_files = argc > 1 && std::string(argv[1]) == "--gcm-files";
+
 		std::ifstream server_info_file("server.info");
 		if (!server_info_file)
 			throw std::runtime_error("Unable to open server.info for reading.");
@@ -36,8 +174,9 @@ int main()
 		std::string server_ip = server_line.substr(0, pos);
 		uint16_t server_port = static_cast<uint16_t>(std::stoi(server_line.substr(pos + 1)));
 
-		Client client(server_ip, server_port);
+		Client client(server_ip, server_port, gcm_files);
 		client.run();
+		Tracer::stop();
 	}
 	catch (const std::exception& e) 
 	{
@@ -3,6 +3,7 @@
  * @brief Implements utility functions for the MessageU client.
  *
  * Provides conversion between hexadecimal strings and byte vectors, and checks for valid hexadecimal strings.
+ * The conversions run on the fastest HexCodec kernel the CPU supports.
  * 
  * @version 2.0
  * @author Dmitriy Gorodov
@@ -11,31 +12,90 @@
  */
 
 #include "utils.h"
-#include <iomanip>
-#include <sstream>
+#include "HexCodec.h"
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <stdexcept>
 #include <regex>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 
 std::vector<uint8_t> hex_string_to_bytes(const std::string& hex) 
 {
-    std::vector<uint8_t> bytes;
-    for (size_t i = 0; i < hex.size(); i += 2) 
+    std::vector<uint8_t> bytes((hex.size() + 1) / 2);
+    size_t paired_length = hex.size() & ~static_cast<size_t>(1);
+    bool valid = HexCodec::decode(hex.data(), paired_length, bytes.data());
+
+    // A trailing unpaired digit is its own byte, as it always was.
+    if (valid && paired_length != hex.size())
     {
-        std::string byteString = hex.substr(i, 2);
-        uint8_t byte = static_cast<uint8_t>(std::stoul(byteString, nullptr, 16));
-        bytes.push_back(byte);
+        int value = HexCodec::digit_value(hex.back());
+        valid = value >= 0;
+        bytes.back() = static_cast<uint8_t>(value);
     }
+
+    if (!valid)
+        throw std::invalid_argument("invalid hexadecimal string");
     return bytes;
 }
 
 std::string bytes_to_hex_string(const std::vector<uint8_t>& bytes)
 {
-	std::ostringstream oss;
-    for (auto b : bytes)
-        oss << std::hex << std::setw(2) << std::setfill('0') << (int)b;
-    return oss.str();
+    std::string hex(bytes.size() * 2, '\0');
+    HexCodec::encode(bytes.data(), bytes.size(), &hex[0]);
+    return hex;
 }
 
 bool is_valid_hex(const std::string& hex) 
 {
-    return std::all_of(hex.begin(), hex.end(), ::isxdigit);
-}
\ No newline at end of file
+    return std::all_of(hex.begin(), hex.end(), [](char digit) { return HexCodec::digit_value(digit) >= 0; });
+}
+
+bool write_file_atomically(const std::string& path, const std::string& data)
+{
+    // The new contents must be on disk before the rename makes them the file, or a power
+    // loss could leave the renamed file empty.
+    std::string temporary_path = path + ".tmp";
+#ifdef _WIN32
+    FILE* file = nullptr;
+    if (fopen_s(&file, temporary_path.c_str(), "wb") != 0)
+        file = nullptr;
+#else
+    FILE* file = std::fopen(temporary_path.c_str(), "wb");
+#endif
+    bool written = file && std::fwrite(data.data(), 1, data.size(), file) == data.size() && std::fflush(file) == 0;
+#ifdef _WIN32
+    written = written && _commit(_fileno(file)) == 0;
+#else
+    written = written && fsync(fileno(file)) == 0;
+#endif
+    written = file && std::fclose(file) == 0 && written;
+
+    std::error_code error;
+    if (written)
+        std::filesystem::rename(temporary_path, path, error);
+    if (!written || error)
+    {
+        std::error_code ignored;
+        std::filesystem::remove(temporary_path, ignored);
+        return false;
+    }
+
+#ifndef _WIN32
+    // The rename itself is durable only once the directory is synced. Some file systems cannot
+    // sync a directory; the file is in place either way.
+    std::filesystem::path directory = std::filesystem::path(path).parent_path();
+    int directory_fd = ::open(directory.empty() ? "." : directory.c_str(), O_RDONLY);
+    if (directory_fd >= 0)
+    {
+        fsync(directory_fd);
+        close(directory_fd);
+    }
+#endif
+    return true;
+}
@@ -13,6 +13,7 @@
 
 #pragma once
 
+#include <cstdint>
 #include <vector>
 #include <string>
 
@@ -24,14 +25,22 @@ const uint8_t MAX_MESSAGE_TYPE_BYTES = 1;
 const uint8_t MAX_PUBLIC_KEY_SIZE = 160;
 const uint8_t MAX_MESSAGE_CONTENT_BYTES = 4;
 const uint8_t RESPONSE_HEADER_SIZE = 7;
+const uint8_t REQUEST_HEADER_SIZE = 23;
 const uint16_t SERVER_ERROR_CODE = 9000;
+const uint8_t SEND_MESSAGE_HEAD_SIZE = MAX_CLIENT_ID_SIZE + MAX_MESSAGE_TYPE_BYTES + MAX_MESSAGE_CONTENT_BYTES;
+const uint32_t MAX_SEND_CONTENT_SIZE = UINT32_MAX - SEND_MESSAGE_HEAD_SIZE;
+const size_t FILE_CHUNK_SIZE = 64 * 1024;
+const uint64_t PARALLEL_FILE_THRESHOLD = 4 * 1024 * 1024;	// with --gcm-files, files from this size on are sent as FILE_SEND_GCM
+const uint64_t MULTIPART_FILE_THRESHOLD = 64 * 1024 * 1024;	// with --gcm-files, files from this size on are sent as FILE_PART messages
 
 enum MessageType : uint8_t
 {
 	SYMMETRIC_KEY_REQUEST = 1,
 	SYMMETRIC_KEY_SEND = 2,
 	TEXT_MESSAGE_SEND = 3,
-	FILE_SEND = 4
+	FILE_SEND = 4,
+	FILE_SEND_GCM = 5,	// file content in the chunked AES-GCM format (GCMChunkCipher.h)
+	FILE_PART = 6	// one part of a multipart file transfer (FilePart.h)
 };
 
 enum RequestCode : uint16_t
@@ -43,6 +52,15 @@ enum RequestCode : uint16_t
 	LIST_PENDING_MESSAGES = 604
 };
 
+enum ResponseCode : uint16_t
+{
+	REGISTRATION_SUCCEEDED = 2100,
+	CLIENT_LIST_RETURNED = 2101,
+	PUBLIC_KEY_RETURNED = 2102,
+	MESSAGE_SENT = 2103,
+	PENDING_MESSAGES_RETURNED = 2104
+};
+
 enum CommandCode : uint8_t
 {
 	REGISTRATION = 110,
@@ -53,6 +71,10 @@ enum CommandCode : uint8_t
 	RECEIVE_SYMMETRIC_KEY = 151,
 	SEND_SYMMETRIC_KEY = 152,
 	SEND_FILE = 153,
+	SEND_BROADCAST_MESSAGE = 154,
+	SHOW_STATISTICS = 160,
+	SHOW_HISTORY = 170,
+	SEARCH_HISTORY = 171,
 	EXIT = 0
 };
 
@@ -75,4 +97,16 @@ std::string bytes_to_hex_string(const std::vector<uint8_t>& bytes);
  * @param hex The string to check.
  * @return true if the string contains only hexadecimal digits, false otherwise.
  */
-bool is_valid_hex(const std::string& hex);
\ No newline at end of file
+bool is_valid_hex(const std::string& hex);
+
+/**
+ * @brief Replaces a file with new contents, so that it holds either the old or the new version.
+ *
+ * The data is written to path + ".tmp" and synced to disk, and the temporary file is then
+ * renamed over path (and, on POSIX, the directory synced). If any step fails the temporary
+ * file is removed and the old version is left in place.
+ * @param path The file to replace.
+ * @param data The new contents.
+ * @return true if the file now holds data.
+ */
+bool write_file_atomically(const std::string& path, const std::string& data);